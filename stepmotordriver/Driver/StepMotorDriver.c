@@ -14,6 +14,17 @@
 // For GPIOS
 #include "main.h"
 
+// Execution time probes if the driver is built in an Urabros project
+#if defined(__has_include)
+	#if __has_include("UrabrosProfile.h")
+		#include "UrabrosProfile.h"
+	#endif
+#endif
+#ifndef uProfileBegin
+	#define uProfileBegin(probe)
+	#define uProfileEnd(probe)
+#endif
+
 #define MAX_MOTOR_HANDLERS 5
 //#define malloc(size) pvPortMalloc(size) // maybe this is needed when freeRTOS is used!
 
@@ -302,12 +313,24 @@ void MotorStop(MotorHandlerStruct *hMotor)
     hMotor->mStatus.runningStatus = MOTOR_STATUS_STANDING;
 }
 
+/*
+ * Stops all the initialized motors, it can be registered as an emergency stop hook.
+ * It doesn't wait for anything, so it can be called from any thread.
+ */
+void MotorStopAll(void)
+{
+	for (uint8_t i = 0; i < motorHandlerIndex; i++)
+		MotorStop(motorHandlerArray[i]);
+}
+
 /**
  * This function must be called in HAL_TIM_PWM_PulseFinishedCallback function!
  * Updates the counters and call the acceleration manager function
  */
 void MotorPulseCallback(TIM_HandleTypeDef *htim)
 {
+	uProfileBegin(uProfile_MOTOR_PULSE);
+
 	// look for the motor handler connected to timer
 	uint8_t i = 0;
 	while (motorHandlerArray[i]->mPins.Tim != htim)
@@ -319,8 +342,14 @@ void MotorPulseCallback(TIM_HandleTypeDef *htim)
 
     // If the motor in step mode
     if(motorHandlerArray[i]->mMovement.drivingMode == DRIVE_MODE_STEP_BLOCKING || motorHandlerArray[i]->mMovement.drivingMode == DRIVE_MODE_STEP_NON_BLOCKING)
+    {
         // Decide if PWM speed change needed or not.
+		uProfileBegin(uProfile_MOTOR_ACCELERATE);
 		MotorAccelerateSpeed(motorHandlerArray[i]);
+		uProfileEnd(uProfile_MOTOR_ACCELERATE);
+    }
+
+	uProfileEnd(uProfile_MOTOR_PULSE);
 }
 
 /**
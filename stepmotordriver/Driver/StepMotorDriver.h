@@ -193,6 +193,7 @@ void MotorSetTimeout			(MotorHandlerStruct *hMotor, uint16_t timeOutLimit);
 void MotorCheckTimeout			(MotorHandlerStruct *hMotor);
 void MotorStart					(MotorHandlerStruct *hMotor, MotorCommandMove command);
 void MotorStop					(MotorHandlerStruct *hMotor);
+void MotorStopAll				(void);
 void MotorWaitUntilFinish		(MotorHandlerStruct *hMotor, uint16_t waitDelay);
 void MotorPulseCallback			(TIM_HandleTypeDef 	*htim);
 void MotorLimitSwitchCallback	(uint16_t			GPIO_pin);
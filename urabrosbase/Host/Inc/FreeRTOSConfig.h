@@ -0,0 +1,64 @@
+/**
+  * @file     FreeRTOSConfig.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  FreeRTOS settings of the host build on the POSIX port.
+  *         The scheduling settings follow the boards, only the memory is sized for Linux threads:
+  *         every thread is a pthread, so a stack can't be smaller than PTHREAD_STACK_MIN.
+  */
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configUSE_PREEMPTION                     1
+#define configSUPPORT_STATIC_ALLOCATION          1
+#define configSUPPORT_DYNAMIC_ALLOCATION         1
+#define configUSE_IDLE_HOOK                      0
+#define configUSE_TICK_HOOK                      1      /* The SysTick of the HAL shim is synchronized to the tick*/
+#define configCPU_CLOCK_HZ                       ( 1000000UL )
+#define configTICK_RATE_HZ                       ((TickType_t)1000)
+#define configMAX_PRIORITIES                     ( 7 )
+#define configMINIMAL_STACK_SIZE                 ((unsigned short)4096) /* In words, 32 kB on 64 bit, above PTHREAD_STACK_MIN*/
+#define configTOTAL_HEAP_SIZE                    ((size_t)(2 * 1024 * 1024))
+#define configMAX_TASK_NAME_LEN                  ( 16 )
+#define configUSE_16_BIT_TICKS                   0
+#define configUSE_MUTEXES                        1
+#define configUSE_RECURSIVE_MUTEXES              1
+#define configUSE_COUNTING_SEMAPHORES            1
+#define configQUEUE_REGISTRY_SIZE                8
+#define configUSE_PORT_OPTIMISED_TASK_SELECTION  0
+#define configUSE_TIMERS                         0
+#define configCHECK_FOR_STACK_OVERFLOW           0
+#define configMESSAGE_BUFFER_LENGTH_TYPE         size_t
+
+/* Co-routine definitions. */
+#define configUSE_CO_ROUTINES                    0
+#define configMAX_CO_ROUTINE_PRIORITIES          ( 2 )
+
+/* Set the following definitions to 1 to include the API function, or zero
+to exclude the API function. */
+#define INCLUDE_vTaskPrioritySet             1
+#define INCLUDE_uxTaskPriorityGet            1
+#define INCLUDE_vTaskDelete                  1
+#define INCLUDE_vTaskCleanUpResources        0
+#define INCLUDE_vTaskSuspend                 1
+#define INCLUDE_vTaskDelayUntil              0
+#define INCLUDE_vTaskDelay                   1
+#define INCLUDE_xTaskGetSchedulerState       1
+#define INCLUDE_xTaskGetCurrentTaskHandle    1
+
+/* Thread statistics of the uCommand_GET_DIAGNOSTICS command, same as on the boards. */
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#include <stdint.h>
+extern uint32_t uDiagGetRunTimeCounter(void);
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         uDiagGetRunTimeCounter()
+
+/* An assert stops the whole simulation, so it is seen at once. */
+#define configASSERT( x ) if ((x) == 0) { vAssertCalled( __FILE__, __LINE__ ); }
+void vAssertCalled(const char *file, unsigned long line);
+
+#endif /* FREERTOS_CONFIG_H */
@@ -0,0 +1,9 @@
+/**
+  * @file     cmsis_gcc.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Included by the cmsis_os.c for the core functions, on the host they come from the HAL shim.
+  */
+
+#include "uHostHal.h"
@@ -0,0 +1,14 @@
+/**
+  * @file     main.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Stands for the CubeMX generated main.h in the host build.
+  */
+
+#ifndef MAIN_H_
+#define MAIN_H_
+
+#include "uHostHal.h"
+
+#endif /* MAIN_H_ */
@@ -0,0 +1,9 @@
+/**
+  * @file     stm32g0xx_hal.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  The BOARD_HAL_HEADER of the board configuration, on the host it is the HAL shim.
+  */
+
+#include "uHostHal.h"
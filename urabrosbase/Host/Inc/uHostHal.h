@@ -0,0 +1,124 @@
+/**
+  * @file     uHostHal.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  The piece of the STM32 HAL the framework uses, implemented on Linux for the host build.\n
+  *         The UART is a pseudo-terminal, the PC tester or any script opens its slave side like a serial port.
+  *         The DMA receive is a circular buffer filled by the simulated interrupt, the DMA counter, the half / full
+  *         callbacks and the IDLE flag work like on the board. HAL_UART_Transmit_DMA() writes the bytes to the
+  *         pseudo-terminal at once and the Tx complete callback comes from the simulated interrupt.\n
+  *         The interrupts are simulated by the highest priority FreeRTOS thread, it polls the pseudo-terminal
+  *         in every tick and when a transmit is started.\n
+  *         HAL_GetTick() and the SysTick registers are calculated from the POSIX monotonic clock.
+  *
+  *         The framework sources include this file through the BOARD_HAL_HEADER, main.h and usart.h,
+  *         nothing else has to be changed in them.
+  */
+
+#ifndef UHOSTHAL_H_
+#define UHOSTHAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO                volatile
+#define __STATIC_INLINE     static inline
+
+typedef enum {
+    HAL_OK      = 0x00,
+    HAL_ERROR   = 0x01,
+    HAL_BUSY    = 0x02,
+    HAL_TIMEOUT = 0x03
+}HAL_StatusTypeDef;
+
+typedef enum {
+    GPIO_PIN_RESET = 0,
+    GPIO_PIN_SET
+}GPIO_PinState;
+
+/* The DMA counter, the number of bytes left until the end of the receive buffer */
+typedef struct {
+    __IO uint32_t NDTR;
+}DMA_Stream_TypeDef;
+
+typedef struct {
+    DMA_Stream_TypeDef *Instance;
+}DMA_HandleTypeDef;
+
+#define HAL_UART_STATE_READY    0x20U
+#define HAL_UART_STATE_BUSY_TX  0x21U
+
+#define UART_IT_IDLE            0x01U
+#define UART_FLAG_IDLE          0x01U
+
+/** The host UART handler, the fields of the CubeMX generated handler the framework uses plus the pseudo-terminal.
+ */
+typedef struct __UART_HandleTypeDef {
+    DMA_HandleTypeDef   *hdmarx;
+    __IO uint32_t       gState;
+    __IO uint32_t       flags;          /**< Host only: UART_FLAG_* raised by the simulated interrupt*/
+    __IO uint32_t       enabledIt;      /**< Host only: UART_IT_* enabled by the framework*/
+}UART_HandleTypeDef;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t LOAD;
+    __IO uint32_t VAL;
+    __IO uint32_t CALIB;
+}SysTick_Type;
+
+/** The SysTick counts down from LOAD in every tick like on the board, one step is one microsecond.
+ */
+SysTick_Type *uHostSysTick(void);
+#define SysTick                         (uHostSysTick())
+
+typedef struct {
+    __IO uint32_t ICSR;
+}SCB_Type;
+
+/** The host SysTick stops at 0 until the tick hook reloads it, so its interrupt is never pending.
+ */
+extern SCB_Type uHostScb;
+#define SCB                             (&uHostScb)
+#define SCB_ICSR_PENDSTSET_Msk          (1UL << 26)
+
+#define __HAL_UART_ENABLE_IT(h, it)     ((h)->enabledIt |= (it))
+#define __HAL_UART_DISABLE_IT(h, it)    ((h)->enabledIt &= ~(it))
+#define __HAL_UART_GET_FLAG(h, f)       (((h)->flags & (f)) == (f))
+#define __HAL_UART_CLEAR_IDLEFLAG(h)    ((h)->flags &= ~UART_FLAG_IDLE)
+#define __HAL_DMA_GET_COUNTER(h)        ((h)->Instance->NDTR)
+
+/** Gives back nonzero while the simulated interrupt runs in the calling thread, the framework uses it to detect interrupt context.
+ */
+uint32_t __get_IPSR(void);
+
+static inline void __disable_irq(void) {}
+static inline void __enable_irq(void) {}
+static inline void __DMB(void) { __sync_synchronize(); }
+
+uint32_t HAL_GetTick(void);
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart);
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart);
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart);
+
+/** Opens a pseudo-terminal for the UART and creates the thread of the simulated interrupts.
+ *  It has to be called before UrabrosInit(). Only one UART can be opened.
+ *  @param huart the UART, usually #MESSAGE_UART_MAIN_PTR
+ *  @param linkPath if it is not NULL a symbolic link is created with this name to the slave side, so the scripts can use a fixed name
+ *  @param irqHandler it is called by the simulated interrupt when the IDLE flag is raised, like the USARTx_IRQHandler() of the board
+ *  @return HAL_OK, or HAL_ERROR if the pseudo-terminal can't be opened
+ */
+HAL_StatusTypeDef uHostUartOpen(UART_HandleTypeDef *huart, const char *linkPath, void (*irqHandler)(void));
+
+/** Gives back the name of the slave side of the pseudo-terminal, for example /dev/pts/3.
+ */
+const char *uHostUartName(void);
+
+#endif /* UHOSTHAL_H_ */
@@ -0,0 +1,18 @@
+/**
+  * @file     usart.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Stands for the CubeMX generated usart.h in the host build.
+  *         Both UART handlers of the boards exist, the MESSAGE_UART_MAIN of the UrabrosConfig.h gets the pseudo-terminal.
+  */
+
+#ifndef USART_H_
+#define USART_H_
+
+#include "main.h"
+
+extern UART_HandleTypeDef huart2;
+extern UART_HandleTypeDef huart3;
+
+#endif /* USART_H_ */
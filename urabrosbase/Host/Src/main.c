@@ -0,0 +1,63 @@
+/**
+  * @file     main.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Entry of the host build, it runs the framework of a board configuration as a Linux process.
+  *
+  *         Usage: urabros_host [link path]
+  *         The slave side of the pseudo-terminal is printed at start, if a link path is given a symbolic link is
+  *         created to it, for example: urabros_host /tmp/urabros  and the PC tester opens /tmp/urabros.
+  */
+
+#include "main.h"
+#include "usart.h"
+#include "UrabrosMaster.h"
+#include "uIncomingMessageHandler.h"
+#include "cmsis_os.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+UART_HandleTypeDef huart2;
+UART_HandleTypeDef huart3;
+
+/** Same as the USARTx_IRQHandler() of the boards, it is called by the simulated interrupt.
+ */
+static void HOST_UART_IRQHandler(void)
+{
+    HAL_UART_IRQHandler(MESSAGE_UART_MAIN_PTR);
+
+    if (__HAL_UART_GET_FLAG(MESSAGE_UART_MAIN_PTR, UART_FLAG_IDLE)){
+        __HAL_UART_CLEAR_IDLEFLAG(MESSAGE_UART_MAIN_PTR);
+        if(uMsgPutFromDMA() != uMsg_Ok) {
+            //TODO handle message error
+        }
+    }
+}
+
+void vAssertCalled(const char *file, unsigned long line)
+{
+    fprintf(stderr, "FreeRTOS assert: %s:%lu\n", file, line);
+    abort();
+}
+
+int main(int argc, char *argv[])
+{
+    const char *linkPath = (argc > 1) ? argv[1] : NULL;
+
+    if(uHostUartOpen(MESSAGE_UART_MAIN_PTR, linkPath, HOST_UART_IRQHandler) != HAL_OK) {
+        perror("Urabros host: can't open the pseudo-terminal");
+        return EXIT_FAILURE;
+    }
+    printf("Urabros host: UART on %s\n", uHostUartName());
+    if(linkPath != NULL) {
+        printf("Urabros host: linked to %s\n", linkPath);
+    }
+    fflush(stdout);
+
+    UrabrosInit();
+    osKernelStart();
+
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,298 @@
+/**
+  * @file     uHostHal.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Linux implementation of the HAL functions, further informations in the header file.
+  */
+
+#define _GNU_SOURCE
+#include "uHostHal.h"
+#include "UrabrosConfig.h"
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#if CRC_BACKEND == CRC_BACKEND_HARDWARE || CRC_BENCHMARK_ENABLE
+    #error "The host build has no CRC peripheral, use CRC_BACKEND_SOFTWARE and CRC_BENCHMARK_ENABLE 0"
+#endif
+
+#define HOST_ISR_STACK_SIZE     configMINIMAL_STACK_SIZE
+#define HOST_ISR_PRIORITY       (configMAX_PRIORITIES - 1)  /**< Above every thread of the framework, like a real interrupt*/
+
+/** State of the simulated UART and its DMA.
+ */
+typedef struct {
+    UART_HandleTypeDef  *huart;         /**< The opened UART, NULL before uHostUartOpen()*/
+    void                (*irqHandler)(void);
+    int                 masterFd;       /**< Master side of the pseudo-terminal, the framework side*/
+    int                 slaveFd;        /**< Slave side, kept open so the line settings stay and the master never sees a hangup*/
+    char                slaveName[64];
+    DMA_Stream_TypeDef  rxStream;       /**< The DMA counter read by the framework*/
+    DMA_HandleTypeDef   rxDma;
+    uint8_t             *rxBuffer;      /**< The circular receive buffer given by HAL_UART_Receive_DMA()*/
+    uint16_t            rxSize;
+    uint16_t            rxPos;          /**< Next byte to be written by the DMA*/
+    volatile uint8_t    txPending;      /**< 1 if a transmit is waiting for its Tx complete callback*/
+    TaskHandle_t        isrThread;
+}uHostUartTypeDef;
+
+static uHostUartTypeDef uHostUart = { .masterFd = -1, .slaveFd = -1 };
+static __thread uint32_t uHostIsrActive = 0;       /**< Nonzero in the thread of the simulated interrupt while it runs a handler*/
+static SysTick_Type uHostSysTickRegs;
+SCB_Type uHostScb;
+static volatile uint64_t uHostLastTickUs = 0;       /**< Time of the last FreeRTOS tick, written by the tick hook*/
+
+/** Microseconds of the POSIX monotonic clock.
+ */
+static uint64_t uHostNowUs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000ULL + (uint64_t)now.tv_nsec / 1000ULL;
+}
+
+uint32_t HAL_GetTick(void)
+{
+    static uint64_t startUs = 0;
+
+    if(!startUs) {
+        startUs = uHostNowUs();
+    }
+    return (uint32_t)((uHostNowUs() - startUs) / 1000ULL);
+}
+
+SysTick_Type *uHostSysTick(void)
+{
+    uint64_t elapsed = uHostNowUs() - uHostLastTickUs;
+
+    uHostSysTickRegs.LOAD = (1000000UL / configTICK_RATE_HZ) - 1;
+    if(elapsed > uHostSysTickRegs.LOAD) {
+        elapsed = uHostSysTickRegs.LOAD;
+    }
+    uHostSysTickRegs.VAL = uHostSysTickRegs.LOAD - (uint32_t)elapsed;
+    return &uHostSysTickRegs;
+}
+
+/** The SysTick reloads in every tick.
+ */
+void vApplicationTickHook(void)
+{
+    uHostLastTickUs = uHostNowUs();
+}
+
+/** osSystickHandler() of the cmsis_os.c refers to it, on the POSIX port the tick comes from a signal of the port.
+ */
+void xPortSysTickHandler(void)
+{
+}
+
+uint32_t __get_IPSR(void)
+{
+    return uHostIsrActive;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    if(huart != uHostUart.huart || pData == NULL || !Size) {
+        return HAL_ERROR;
+    }
+
+    uHostUart.rxBuffer          = pData;
+    uHostUart.rxSize            = Size;
+    uHostUart.rxPos             = 0;
+    uHostUart.rxStream.NDTR     = Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size)
+{
+    ssize_t written;
+
+    if(huart != uHostUart.huart || pData == NULL || !Size) {
+        return HAL_ERROR;
+    }
+    if(huart->gState == HAL_UART_STATE_BUSY_TX) {
+        return HAL_BUSY;
+    }
+
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    while(Size) {
+        written = write(uHostUart.masterFd, pData, Size);
+        if(written < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            // Nobody reads the line and the pseudo-terminal is full, the rest is lost like on a disconnected wire.
+            break;
+        }
+        pData   += written;
+        Size    -= written;
+    }
+
+    uHostUart.txPending = 1;
+    if(uHostUart.isrThread != NULL) {
+        xTaskNotifyGive(uHostUart.isrThread);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_AbortTransmit(UART_HandleTypeDef *huart)
+{
+    uHostUart.txPending = 0;
+    huart->gState       = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_DMAStop(UART_HandleTypeDef *huart)
+{
+    uHostUart.rxBuffer  = NULL;
+    huart->gState       = HAL_UART_STATE_READY;
+    return HAL_OK;
+}
+
+void HAL_UART_IRQHandler(UART_HandleTypeDef *huart)
+{
+    // The flags are raised by the simulated interrupt, there is nothing to read from a register.
+    (void)huart;
+}
+
+/** Copies the received bytes to the DMA buffer, raises the half and full transfer callbacks at the same positions as the DMA.
+ */
+static void uHostRxDma(const uint8_t *data, uint16_t len)
+{
+    uint16_t half = uHostUart.rxSize / 2;
+    uint16_t chunk;
+
+    while(len) {
+        // Copy until the next point where the DMA would raise an interrupt.
+        chunk = (uHostUart.rxPos < half ? half : uHostUart.rxSize) - uHostUart.rxPos;
+        if(chunk > len) {
+            chunk = len;
+        }
+
+        for(uint16_t idx = 0; idx < chunk; idx++) {
+            uHostUart.rxBuffer[uHostUart.rxPos + idx] = data[idx];
+        }
+        uHostUart.rxPos    += chunk;
+        data               += chunk;
+        len                -= chunk;
+
+        if(uHostUart.rxPos == uHostUart.rxSize) {
+            uHostUart.rxPos = 0;
+        }
+        uHostUart.rxStream.NDTR = uHostUart.rxSize - uHostUart.rxPos;
+
+        if(uHostUart.rxPos == half) {
+            HAL_UART_RxHalfCpltCallback(uHostUart.huart);
+        } else if(uHostUart.rxPos == 0) {
+            HAL_UART_RxCpltCallback(uHostUart.huart);
+        }
+    }
+}
+
+/** The simulated interrupts: Tx complete, DMA receive and IDLE line.
+ *  It wakes up in every tick and when a transmit is started.
+ *  In one round at most half of the DMA buffer is received, so the parser can keep up like on the board,
+ *  the IDLE comes only when the pseudo-terminal is empty.
+ */
+static void uHostIsrThread(void *argument)
+{
+    uint8_t rxChunk[DMA_RX_BUFFER_SIZE / 2];
+    ssize_t received;
+    uint8_t lineBusy = 0;
+
+    (void)argument;
+    for(;;) {
+        ulTaskNotifyTake(pdTRUE, 1);
+        uHostIsrActive = 1;
+
+        if(uHostUart.txPending) {
+            uHostUart.txPending     = 0;
+            uHostUart.huart->gState = HAL_UART_STATE_READY;
+            HAL_UART_TxCpltCallback(uHostUart.huart);
+        }
+
+        received = 0;
+        if(uHostUart.rxBuffer != NULL) {
+            received = read(uHostUart.masterFd, rxChunk, sizeof(rxChunk));
+        }
+        if(received > 0) {
+            uHostRxDma(rxChunk, (uint16_t)received);
+            lineBusy = 1;
+        }
+
+        // Everything what arrived was read out, the line is idle now.
+        if(lineBusy && received < (ssize_t)sizeof(rxChunk) && (uHostUart.huart->enabledIt & UART_IT_IDLE)) {
+            lineBusy = 0;
+            uHostUart.huart->flags |= UART_FLAG_IDLE;
+            if(uHostUart.irqHandler != NULL) {
+                uHostUart.irqHandler();
+            }
+        }
+
+        uHostIsrActive = 0;
+    }
+}
+
+HAL_StatusTypeDef uHostUartOpen(UART_HandleTypeDef *huart, const char *linkPath, void (*irqHandler)(void))
+{
+    struct termios  raw;
+    const char      *name;
+
+    if(uHostUart.huart != NULL || huart == NULL) {
+        return HAL_ERROR;
+    }
+
+    uHostUart.masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if(uHostUart.masterFd < 0 || grantpt(uHostUart.masterFd) || unlockpt(uHostUart.masterFd)) {
+        return HAL_ERROR;
+    }
+    name = ptsname(uHostUart.masterFd);
+    if(name == NULL) {
+        return HAL_ERROR;
+    }
+    snprintf(uHostUart.slaveName, sizeof(uHostUart.slaveName), "%s", name);
+
+    // Binary line, no echo and no line editing.
+    uHostUart.slaveFd = open(uHostUart.slaveName, O_RDWR | O_NOCTTY);
+    if(uHostUart.slaveFd < 0 || tcgetattr(uHostUart.slaveFd, &raw)) {
+        return HAL_ERROR;
+    }
+    cfmakeraw(&raw);
+    tcsetattr(uHostUart.slaveFd, TCSANOW, &raw);
+    fcntl(uHostUart.masterFd, F_SETFL, fcntl(uHostUart.masterFd, F_GETFL) | O_NONBLOCK);
+
+    if(linkPath != NULL) {
+        unlink(linkPath);
+        if(symlink(uHostUart.slaveName, linkPath)) {
+            return HAL_ERROR;
+        }
+    }
+
+    uHostUart.rxDma.Instance    = &uHostUart.rxStream;
+    huart->hdmarx               = &uHostUart.rxDma;
+    huart->gState               = HAL_UART_STATE_READY;
+    huart->flags                = 0;
+    huart->enabledIt            = 0;
+    uHostUart.irqHandler        = irqHandler;
+    uHostUart.huart             = huart;
+
+    if(xTaskCreate(uHostIsrThread, "HostISR", HOST_ISR_STACK_SIZE, NULL, HOST_ISR_PRIORITY, &uHostUart.isrThread) != pdPASS) {
+        return HAL_ERROR;
+    }
+    return HAL_OK;
+}
+
+const char *uHostUartName(void)
+{
+    return uHostUart.slaveName;
+}
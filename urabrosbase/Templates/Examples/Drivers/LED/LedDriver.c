@@ -29,7 +29,7 @@ void ledDriver_Init(void)
         return;
 
     // Create the mutex
-    Driver.mutex        = xSemaphoreCreateMutex();
+    Driver.mutex        = uMutexCreate();
     Driver.mutexTimeout = LED_MUTEX_TIMEOUT;
 
     // PUT HERE THE DRIVER SPECIFIC INIT PARTS
@@ -30,7 +30,7 @@ void motorOneDriver_Init(void)
         return;
 
     // Create the mutex
-    Driver.mutex        = xSemaphoreCreateMutex();
+    Driver.mutex        = uMutexCreate();
     Driver.mutexTimeout = MOTOR_ONE_MUTEX_TIMEOUT;
 
     // Init Motor Driver Pins
@@ -22,8 +22,8 @@ Urabros_TaskPtrTypeDef timeOutTaskPtr = &Task;
 
 static void timeout_function_A(void const *argument);
 static void timeout_function_B(void const *argument);
-osThreadDef(timeOutThread_A, timeout_function_A, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
-osThreadDef(timeOutThread_B, timeout_function_B, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
+uThreadDef(timeOutThread_A, timeout_function_A, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
+uThreadDef(timeOutThread_B, timeout_function_B, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
 
 uint8_t innerCommand = 0;
 
@@ -31,15 +31,13 @@ void initTimeOutTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_OneTime;
-    Task.queueMaster        = xQueueCreate(4, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(timeOutThread_A), NULL);
-    Task.threadIdArray[1]   = osThreadCreate(osThread(timeOutThread_B), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(timeOutThread_A, NULL);
+    Task.threadIdArray[1]   = uThreadCreate(timeOutThread_B, NULL);
 
     dprint("ID: %d - "UTASK_NAME" - Init done\n", Task.responsibleTaskId);
 }
@@ -16,30 +16,33 @@ Urabros_TaskPtrTypeDef dataManagerTaskPtr = &Task;
 #include "uOutgoingMessageHandler.h"
 #include "uMessageCommon.h"
 
+#define DATA_MANAGER_SLOT_SIZE      60  /**< Maximal length of one data block*/
+#define DATA_MANAGER_SLOT_COUNT     2   /**< Number of data blocks can wait at the same time*/
+
+static uint8_t dataManagerSlots[URABROS_TASK_DATA_BUFFER_SIZE(DATA_MANAGER_SLOT_SIZE, DATA_MANAGER_SLOT_COUNT)];
+
 static void dataManager_thread_function(void const *argument);
-osThreadDef(dataManagerThread, dataManager_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 2);
+uThreadDef(dataManagerThread, dataManager_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 2);
 
 void initDataManagerTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_OneTime;
-    Task.queueMaster        = xQueueCreate(60, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
+    uTaskDataInit(dataManagerSlots, DATA_MANAGER_SLOT_SIZE, DATA_MANAGER_SLOT_COUNT);
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(dataManagerThread), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(dataManagerThread, NULL);
 
     dprint("ID: %d - "UTASK_NAME" - Init done\n", Task.responsibleTaskId);
 }
 
 static void dataManager_thread_function(void const *argument)
 {
-    uint8_t         recData         = 0;
-    uint8_t         numOfWaiting    = 0;
-    uint8_t         dataBuffer[60]  = {0};
+    uint8_t         *dataPtr        = NULL;
+    uint8_t         dataLen         = 0;
     Urabros_Msg     uMsgTx          = {0};
     Urabros_MsgPtr  uMsgTxPtr       = &uMsgTx;
     uint8_t         msgBlockCntr    = 0;
@@ -57,32 +60,26 @@ static void dataManager_thread_function(void const *argument)
         // Receive two message blocks than goes to finished state.
         msgBlockCntr = 0;
         while(msgBlockCntr < 4) {
-            numOfWaiting = uxQueueMessagesWaiting(Task.queueMaster);
-            if(numOfWaiting) {
-                dprintln("Data arrived: %d", msgBlockCntr);
-                for(uint8_t i = 0; i <  numOfWaiting; i++) {
-                    if(xQueueReceive(Task.queueMaster, &recData, (TickType_t)10) == pdTRUE) {
-                        dataBuffer[i] = recData;
-                    }
-                }
-
-                uMsgSendMessageFromTask(&Task, dataBuffer, numOfWaiting);
-
-                uMsgReset(uMsgTxPtr);
-                uMsgAppendBufferFromTask(&Task, uMsgTxPtr, dataBuffer, numOfWaiting);
-                uMsgAppendBufferFromTask(&Task, uMsgTxPtr, dataBuffer, numOfWaiting);
-                uMsgSetCrc(uMsgTxPtr);
-                uMsgOutPut(uMsgTxPtr);
-
-                msgBlockCntr++;
-                /*
-                // This is equal with the uMsgAppendBufferFromTask(...) for the first time calling, than its like uMsgAppendBuffer(...)
-                uMsgAppend(uMsgTxPtr, uCommand_DATA_FROM_TASK);
-                uMsgAppend(uMsgTxPtr, Task.responsibleTaskId);
-                uMsgAppendBuffer(uMsgTxPtr, dataBuffer, numOfWaiting);
-                */
-            }
-            osDelay(10);
+            // Sleeps until a whole data block arrives.
+            dataLen = uTaskDataReceive(&dataPtr, portMAX_DELAY);
+            dprintln("Data arrived: %d", msgBlockCntr);
+
+            uMsgSendMessageFromTask(&Task, dataPtr, dataLen);
+
+            uMsgReset(uMsgTxPtr);
+            uMsgAppendBufferFromTask(&Task, uMsgTxPtr, dataPtr, dataLen);
+            uMsgAppendBufferFromTask(&Task, uMsgTxPtr, dataPtr, dataLen);
+            uMsgSetCrc(uMsgTxPtr);
+            uMsgOutPut(uMsgTxPtr);
+
+            uTaskDataRelease();
+            msgBlockCntr++;
+            /*
+            // This is equal with the uMsgAppendBufferFromTask(...) for the first time calling, than its like uMsgAppendBuffer(...)
+            uMsgAppend(uMsgTxPtr, uCommand_DATA_FROM_TASK);
+            uMsgAppend(uMsgTxPtr, Task.responsibleTaskId);
+            uMsgAppendBuffer(uMsgTxPtr, dataPtr, dataLen);
+            */
         }
 
         dprintln("Wait for ACK...");
@@ -16,21 +16,25 @@ Urabros_TaskPtrTypeDef ledBlinkerTaskPtr = &Task;
 #define UTASK_NAME "LED"
 #include "uDebugPrint.h"
 
+#define LED_BLINKER_SLOT_SIZE   4   /**< One block holds the 4 delays*/
+#define LED_BLINKER_SLOT_COUNT  2   /**< Number of blocks can wait at the same time*/
+
+static uint8_t ledBlinkerSlots[URABROS_TASK_DATA_BUFFER_SIZE(LED_BLINKER_SLOT_SIZE, LED_BLINKER_SLOT_COUNT)];
+
 static void blinker_thread_function(void const *argument);
-osThreadDef(ledBLinkerThread, blinker_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
+uThreadDef(ledBLinkerThread, blinker_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
 
 void initLedBlinkerTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_Continious;
-    Task.queueMaster        = xQueueCreate(4, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
+    uTaskDataInit(ledBlinkerSlots, LED_BLINKER_SLOT_SIZE, LED_BLINKER_SLOT_COUNT);
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(ledBLinkerThread), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(ledBLinkerThread, NULL);
 
     // Init Modules
     ledDriver_Init();
@@ -40,8 +44,8 @@ void initLedBlinkerTask(Urabros_CommandIdTypedef responsibleID)
 
 static void blinker_thread_function(void const *argument)
 {
-    uint8_t recData = 0;
-    uint8_t numOfWaiting = 0;
+    uint8_t *dataPtr = NULL;
+    uint8_t dataLen = 0;
     uint32_t delays[4] = {100,250,100,250};
 
     uTaskSetStatus(uTaskStatusRunning);
@@ -49,15 +53,15 @@ static void blinker_thread_function(void const *argument)
     for(;;)
     {
 
-        numOfWaiting = uxQueueMessagesWaiting(Task.queueMaster);
-        if(numOfWaiting) {
-            dprintln("Num of waiting: %d", numOfWaiting);
-            for(uint8_t i = 0; i < numOfWaiting; i++) {
-                if(xQueueReceive(Task.queueMaster, &recData, (TickType_t)10) == pdTRUE) {
-                    delays[i] = recData;
-                    dprintln("Delay[%d]: %X", i, recData);
-                }
+        // The blinking doesn't stop, so it only checks if new delays arrived.
+        dataLen = uTaskDataReceive(&dataPtr, 0);
+        if(dataLen) {
+            dprintln("Num of delays: %d", dataLen);
+            for(uint8_t i = 0; i < dataLen; i++) {
+                delays[i] = dataPtr[i];
+                dprintln("Delay[%d]: %X", i, dataPtr[i]);
             }
+            uTaskDataRelease();
         }
 
         for(uint8_t i = 0; i < 3; i++) {
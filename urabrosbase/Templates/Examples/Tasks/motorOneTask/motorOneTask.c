@@ -9,6 +9,7 @@
 #include "MotorOneDriver.h"
 #include "motorOneTask.h"
 #include "UrabrosTask.h"
+#include "UrabrosEmergencyStop.h"
 
 Urabros_TaskPtrTypeDef motorOneTaskPtr = &Task;
 
@@ -16,33 +17,39 @@ Urabros_TaskPtrTypeDef motorOneTaskPtr = &Task;
 #define UTASK_NAME "MOTOR ONE"
 #include "uDebugPrint.h"
 
+#define MOTOR_ONE_SLOT_SIZE     12  /**< Maximal length of one motor command*/
+#define MOTOR_ONE_SLOT_COUNT    2   /**< Number of motor commands can wait at the same time*/
+
+static uint8_t motorOneSlots[URABROS_TASK_DATA_BUFFER_SIZE(MOTOR_ONE_SLOT_SIZE, MOTOR_ONE_SLOT_COUNT)];
+
 static void motor_one_thread_function(void const *argument);
-osThreadDef(motorOneThread, motor_one_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
+uThreadDef(motorOneThread, motor_one_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
 
 void initMotorOneTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_Continious;
-    Task.queueMaster        = xQueueCreate(13, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
+    uTaskDataInit(motorOneSlots, MOTOR_ONE_SLOT_SIZE, MOTOR_ONE_SLOT_COUNT);
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(motorOneThread), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(motorOneThread, NULL);
 
     // Init Drivers
     motorOneDriver_Init();
 
+    // The emergency stop halts every motor before anything else
+    uEmergencyStopRegister(MotorStopAll);
+
     dprint("ID: %d - "UTASK_NAME" - Init done\n", Task.responsibleTaskId);
 }
 
 static void motor_one_thread_function(void const *argument)
 {
-    uint8_t         recData             = 0;
-    uint8_t         numOfWaiting        = 0;
-    uint8_t         dataBuffer[12]      = {0};
+    uint8_t         *dataPtr            = NULL;
+    uint8_t         dataLen             = 0;
 
     for(;;)
     {
@@ -52,35 +59,25 @@ static void motor_one_thread_function(void const *argument)
         // Wait for 3 data
         dprintln("Waiting for Motor command data")
 
-        numOfWaiting = 0;
-        while(!numOfWaiting) {
-            numOfWaiting = uxQueueMessagesWaiting(Task.queueMaster);
-            osDelay(10);
-        }
+        dataLen = uTaskDataReceive(&dataPtr, portMAX_DELAY);
 
-        if(numOfWaiting == 1) {
-            xQueueReceive(Task.queueMaster, &recData, portMAX_DELAY);
-            switch(recData){
+        if(dataLen == 1) {
+            switch(dataPtr[0]){
                 case 0:
                     break;
                 default:
                     break;
             }
 
-        } else if(numOfWaiting == 2) {
+        } else if(dataLen == 2) {
             //Freerun mode
-        } else if(numOfWaiting > 2){
+        } else if(dataLen >= 6){
             // Mode with data.
-            for(uint8_t i = 0; i <  numOfWaiting; i++) {
-                if(xQueueReceive(Task.queueMaster, &recData, portMAX_DELAY) == pdTRUE) {
-                    dataBuffer[i] = recData;
-                }
-            }
             MotorCommandMove command;
-            command.cMode       = dataBuffer[0];
-            command.cDirection  = dataBuffer[1];
-            command.cUserUnitDifference = (dataBuffer[2] << 8) + dataBuffer[3];
-            uint32_t timeoutVal = (dataBuffer[4] << 8) + dataBuffer[5];
+            command.cMode       = dataPtr[0];
+            command.cDirection  = dataPtr[1];
+            command.cUserUnitDifference = (dataPtr[2] << 8) + dataPtr[3];
+            uint32_t timeoutVal = (dataPtr[4] << 8) + dataPtr[5];
 
             if(timeoutVal) {
                 dprintln("With timeout mode: %d, dir: %d, Step: %d",command.cMode, command.cDirection, command.cUserUnitDifference);
@@ -92,6 +89,7 @@ static void motor_one_thread_function(void const *argument)
             }
 
         }
+        uTaskDataRelease();
 
 
     }
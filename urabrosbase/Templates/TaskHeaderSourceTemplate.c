@@ -23,22 +23,26 @@ void initTempTask(Urabros_CommandIdTypedef responsibleID);
 
 Urabros_TaskPtrTypeDef tempTaskPtr = &Task;
 
+// Only needed if the task receives #uCommand_SEND_DATA payloads, see at uTaskDataReceive()
+#define TEMP_SLOT_SIZE      8
+#define TEMP_SLOT_COUNT     2
+static uint8_t tempSlots[URABROS_TASK_DATA_BUFFER_SIZE(TEMP_SLOT_SIZE, TEMP_SLOT_COUNT)];
+
 static void temp_thread_function(void const *argument);
-osThreadDef(tempThread, temp_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 2);
+uThreadDef(tempThread, temp_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 2);
 
 
 void initTempTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_OneTime;
-    Task.queueMaster        = xQueueCreate(4, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
+    uTaskDataInit(tempSlots, TEMP_SLOT_SIZE, TEMP_SLOT_COUNT);
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(tempThread), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(tempThread, NULL);
 }
 
 void helloWorld_thread_function(void const *argument)
@@ -0,0 +1,162 @@
+/**
+  * @file     UrabrosDiagnostics.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Runtime statistics for the #uCommand_GET_DIAGNOSTICS command, further informations in the header file.
+  */
+
+#include "UrabrosDiagnostics.h"
+#include "UrabrosTime.h"
+#include "uMessageCommon.h"
+#include "uIncomingMessageHandler.h"
+#include "uOutgoingMessageHandler.h"
+#include <string.h>
+
+#if !configUSE_TRACE_FACILITY || !INCLUDE_uxTaskGetStackHighWaterMark
+    #error "The diagnostics need configUSE_TRACE_FACILITY 1 and INCLUDE_uxTaskGetStackHighWaterMark 1 in the FreeRTOSConfig.h"
+#endif
+
+#define DIAG_THREAD_HEADER_LEN  8   /**< Bytes of one thread in the answer without its name*/
+
+static TaskStatus_t uDiagThreads[DIAG_THREAD_MAX];      /**< The last thread snapshot*/
+static uint16_t uDiagCpu[DIAG_THREAD_MAX];              /**< CPU load of the threads of the snapshot in 0.1%*/
+static UBaseType_t uDiagThreadNum = 0;                  /**< Number of the threads in the snapshot*/
+static uint32_t uDiagPrevCounter[DIAG_THREAD_MAX];      /**< Run-time counters of the previous snapshot*/
+static UBaseType_t uDiagPrevNumber[DIAG_THREAD_MAX];    /**< Thread numbers of the previous snapshot*/
+static UBaseType_t uDiagPrevNum = 0;
+static uint32_t uDiagPrevTotal = 0;                     /**< Run-time of the previous snapshot*/
+static uint32_t uDiagWindow = 0;                        /**< Microseconds between the last two snapshots*/
+
+uint32_t uDiagGetRunTimeCounter(void)
+{
+    // It is called from the context switch, so the interrupt safe version is used.
+    return uTimeGetUsFromISR();
+}
+
+/** Takes a new thread snapshot and calculates the CPU loads from the previous one.
+ *  Only the command handler thread calls it, so the snapshot needs no protection.
+ */
+static void uDiagTakeSnapshot(void)
+{
+    uint32_t total = 0;
+    uint32_t prevCounter;
+    uint64_t cpu;
+    uint32_t newCounter[DIAG_THREAD_MAX];
+    UBaseType_t newNumber[DIAG_THREAD_MAX];
+
+    uDiagThreadNum = uxTaskGetSystemState(uDiagThreads, DIAG_THREAD_MAX, &total);
+    if(!uDiagThreadNum && uxTaskGetNumberOfTasks() > DIAG_THREAD_MAX) {
+        // The array is too small for all the threads, the snapshot is empty, see at DIAG_THREAD_MAX.
+        return;
+    }
+    uDiagWindow = total - uDiagPrevTotal;
+
+    // The threads come grouped by their state, so their order changes. The previous snapshot is kept until all of them are found.
+    for(UBaseType_t thread = 0; thread < uDiagThreadNum; thread++) {
+#if configGENERATE_RUN_TIME_STATS
+        // A thread not found in the previous snapshot was created since then.
+        prevCounter = 0;
+        for(UBaseType_t prev = 0; prev < uDiagPrevNum; prev++) {
+            if(uDiagPrevNumber[prev] == uDiagThreads[thread].xTaskNumber) {
+                prevCounter = uDiagPrevCounter[prev];
+                break;
+            }
+        }
+        cpu = uDiagWindow ? (((uint64_t)(uDiagThreads[thread].ulRunTimeCounter - prevCounter) * 1000) / uDiagWindow) : 0;
+        uDiagCpu[thread] = (cpu > 1000) ? 1000 : (uint16_t)cpu;
+#else
+        (void)prevCounter;
+        uDiagCpu[thread] = DIAG_CPU_UNKNOWN;
+#endif
+        newNumber[thread]   = uDiagThreads[thread].xTaskNumber;
+        newCounter[thread]  = uDiagThreads[thread].ulRunTimeCounter;
+    }
+    memcpy(uDiagPrevNumber, newNumber, uDiagThreadNum * sizeof(newNumber[0]));
+    memcpy(uDiagPrevCounter, newCounter, uDiagThreadNum * sizeof(newCounter[0]));
+    uDiagPrevNum    = uDiagThreadNum;
+    uDiagPrevTotal  = total;
+}
+
+static void uDiagCreateSystem(Urabros_MsgPtr uTxPtr)
+{
+    uint32_t drops;
+    uint32_t overruns;
+    uint8_t highWater;
+
+    uMsgAppend32(uTxPtr, (uint32_t)xPortGetFreeHeapSize());
+    uMsgAppend32(uTxPtr, (uint32_t)xPortGetMinimumEverFreeHeapSize());
+
+    uMsgInGetStats(&drops, &highWater, &overruns);
+    uMsgAppend(uTxPtr, highWater);
+    uMsgAppend(uTxPtr, MESSAGE_IN_ARRAY_LENGTH);
+    uMsgAppend32(uTxPtr, drops);
+
+    uMsgAppend(uTxPtr, uMsgOutPrio_Count);
+    for(uint8_t prio = 0; prio < uMsgOutPrio_Count; prio++) {
+        uMsgOutGetStats((Urabros_MsgOutPriorityTypeDef)prio, &drops, NULL, &highWater);
+        uMsgAppend(uTxPtr, highWater);
+        uMsgAppend(uTxPtr, MESSAGE_OUT_ARRAY_LENGTH);
+        uMsgAppend32(uTxPtr, drops);
+    }
+
+    uMsgAppend32(uTxPtr, uDiagWindow);
+    uMsgAppend(uTxPtr, (uint8_t)uxTaskGetNumberOfTasks());
+    uMsgAppend32(uTxPtr, overruns);
+}
+
+static void uDiagCreateThreads(Urabros_MsgPtr uTxPtr, uint8_t first)
+{
+    TaskStatus_t *threadPtr;
+    uint32_t stackFree;
+    uint8_t nameLen;
+
+    if(!first) {
+        uDiagTakeSnapshot();
+    }
+    uMsgAppend(uTxPtr, (uint8_t)uDiagThreadNum);
+    uMsgAppend(uTxPtr, first);
+
+    // As many threads as fit into the answer, the PC asks the rest with a bigger first index.
+    for(UBaseType_t thread = first; thread < uDiagThreadNum; thread++) {
+        threadPtr = uDiagThreads + thread;
+        nameLen = (uint8_t)strnlen(threadPtr->pcTaskName, configMAX_TASK_NAME_LEN);
+        if(uTxPtr->dataLen + DIAG_THREAD_HEADER_LEN + nameLen >= MESSAGE_BUFFER_LENGTH) {
+            break;
+        }
+
+        stackFree = (uint32_t)threadPtr->usStackHighWaterMark * sizeof(StackType_t);
+        if(stackFree > 0xFFFF) {
+            stackFree = 0xFFFF;
+        }
+        uMsgAppend(uTxPtr, (uint8_t)threadPtr->xTaskNumber);
+        uMsgAppend(uTxPtr, (uint8_t)threadPtr->eCurrentState);
+        uMsgAppend(uTxPtr, (uint8_t)threadPtr->uxCurrentPriority);
+        uMsgAppend(uTxPtr, (uint8_t)(uDiagCpu[thread] >> 8));
+        uMsgAppend(uTxPtr, (uint8_t)uDiagCpu[thread]);
+        uMsgAppend(uTxPtr, (uint8_t)(stackFree >> 8));
+        uMsgAppend(uTxPtr, (uint8_t)stackFree);
+        uMsgAppend(uTxPtr, nameLen);
+        uMsgAppendBuffer(uTxPtr, (uint8_t *)threadPtr->pcTaskName, nameLen);
+    }
+}
+
+void uDiagCreateResponse(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr)
+{
+    uint8_t section = (uRxPtr->dataLen > 1) ? uRxPtr->data[1] : uDiagSection_SYSTEM;
+    uint8_t first   = (uRxPtr->dataLen > 2) ? uRxPtr->data[2] : 0;
+
+    uMsgAppend(uTxPtr, section);
+    switch(section) {
+        case uDiagSection_SYSTEM :
+            uDiagCreateSystem(uTxPtr);
+            break;
+
+        case uDiagSection_THREADS :
+            uDiagCreateThreads(uTxPtr, first);
+            break;
+
+        default :
+            break;
+    }
+}
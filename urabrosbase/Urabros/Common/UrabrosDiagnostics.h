@@ -0,0 +1,48 @@
+/**
+  * @file     UrabrosDiagnostics.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Runtime statistics for the #uCommand_GET_DIAGNOSTICS command: CPU load and stack high-water mark of every thread,
+  *         heap usage, high-water marks and drops of the incoming and outgoing message queues.\n
+  *         The whole snapshot doesn't fit into one message, so the command has sections, all numbers are big endian:\n
+  *         Request: | 0x0C | section | first thread |\n
+  *         #uDiagSection_SYSTEM:  | 0x0C | 0 | heap free 4 | heap min free 4 | in high-water | in size | in drops 4 |
+  *                                | lane count | high-water | size | drops 4 | ... for every lane | window us 4 | thread count | in overruns 4 |\n
+  *         #uDiagSection_THREADS: | 0x0C | 1 | thread count | first | number | state | priority | CPU 0.1% 2 | stack free byte 2 | name len | name... | ...\n
+  *         A new thread snapshot is taken when the first thread is 0, the CPU load is counted from the previous snapshot
+  *         (window us). The other requests read the same snapshot, so the PC asks the threads from the given first
+  *         index until it has all of them.\n
+  *         The run-time counter of FreeRTOS is @see uTimeGetUsFromISR(), it needs these in the FreeRTOSConfig.h:\n
+  *         configUSE_TRACE_FACILITY 1, configGENERATE_RUN_TIME_STATS 1, INCLUDE_uxTaskGetStackHighWaterMark 1,
+  *         portGET_RUN_TIME_COUNTER_VALUE() uDiagGetRunTimeCounter(). Without the run-time stats the CPU load is #DIAG_CPU_UNKNOWN.
+  */
+
+#ifndef COMMON_URABROSDIAGNOSTICS_H_
+#define COMMON_URABROSDIAGNOSTICS_H_
+
+#include "UrabrosTypeDef.h"
+
+#define DIAG_CPU_UNKNOWN    0xFFFF  /**< CPU load of a thread if the run-time stats are not enabled*/
+
+/**
+ *  An enum for the sections of the #uCommand_GET_DIAGNOSTICS command, it is the second byte of the message.
+ */
+typedef enum
+{
+    uDiagSection_SYSTEM     = 0x00, /**< Heap and message queues*/
+    uDiagSection_THREADS    = 0x01, /**< CPU load, stack and name of the threads*/
+}Urabros_DiagSectionTypeDef;
+
+/** Run-time counter of the FreeRTOS statistics, it is called by the kernel at every context switch.
+ *  @return The time in microseconds.
+ */
+uint32_t uDiagGetRunTimeCounter(void);
+
+/** Builds the answer of the #uCommand_GET_DIAGNOSTICS command.
+ *  @param uRxPtr The request.
+ *  @param uTxPtr The answer, the command byte must be already in it.
+ */
+void uDiagCreateResponse(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr);
+
+#endif /* COMMON_URABROSDIAGNOSTICS_H_ */
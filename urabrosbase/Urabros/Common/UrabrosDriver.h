@@ -14,6 +14,7 @@
 
 #include "UrabrosTypeDef.h"
 #include "UrabrosDriverSharedResources.h"
+#include "UrabrosStatic.h"
 #include "main.h"
 
 /** A static handler variable, the other source files make modifications on this varaible.
@@ -23,7 +24,7 @@ static Urabros_DriverTypeDef Driver;
 /** @brief  Takes the mutex driver, it is important, because multiple tasks can use thge same driver, and with this problems can be avoided.
  *      
  *      Example of usage. Write theese in the tempDriver.c / initTempDriver() function:
- *      Driver.mutex        = xSemaphoreCreateMutex();
+ *      Driver.mutex        = uMutexCreate();
  *      Driver.mutexTimeout = TEMP_DRIVER_TIMEOUT; // This value is defined in the tempDriver.h 
  *      Than in the logic of the tempDriver.c: 
  *      if(uDriverMutexTake() == uStatusOk) {//DoStuff} else {//DoStuff}
@@ -0,0 +1,54 @@
+/**
+  * @file     UrabrosEmergencyStop.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Fast path of the emergency stop, further informations in the header file.
+  */
+
+#include "UrabrosEmergencyStop.h"
+#include "UrabrosMaster.h"
+#include "UrabrosTime.h"
+
+static Urabros_EmergencyStopHook uEmergencyStopHooks[EMERGENCY_STOP_MAX_HOOKS];    /**< The registered stop hooks*/
+static uint8_t uEmergencyStopHookNum = 0;                                           /**< Number of the registered stop hooks*/
+static Urabros_EmergencyStopDiagTypeDef uEmergencyStopDiag = {0};                   /**< Latency counters, only the parser thread writes it*/
+
+Urabros_StatusTypeDef uEmergencyStopRegister(Urabros_EmergencyStopHook hook)
+{
+    if(hook == NULL || uEmergencyStopHookNum >= EMERGENCY_STOP_MAX_HOOKS) {
+        return uStatusError;
+    }
+
+    uEmergencyStopHooks[uEmergencyStopHookNum] = hook;
+    uEmergencyStopHookNum++;
+    return uStatusOk;
+}
+
+void uEmergencyStopTrigger(uint32_t rxTimeUs)
+{
+    uint32_t elapsedUs;
+
+    // The outputs go first, everything else can wait.
+    for(uint8_t hookIdx = 0; hookIdx < uEmergencyStopHookNum; hookIdx++) {
+        uEmergencyStopHooks[hookIdx]();
+    }
+    elapsedUs = uTimeGetUs() - rxTimeUs;
+
+    taskENTER_CRITICAL();
+    uEmergencyStopDiag.lastUs = elapsedUs;
+    if(elapsedUs > uEmergencyStopDiag.maxUs) {
+        uEmergencyStopDiag.maxUs = elapsedUs;
+    }
+    uEmergencyStopDiag.count++;
+    taskEXIT_CRITICAL();
+
+    UrabrosSetAllTasksError(URABROS_ESTOP_ERROR_CODE);
+}
+
+void uEmergencyStopGetDiag(Urabros_EmergencyStopDiagTypeDef *diag)
+{
+    taskENTER_CRITICAL();
+    *diag = uEmergencyStopDiag;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,65 @@
+/**
+  * @file     UrabrosEmergencyStop.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Fast path of the #uCommand_EMERGENCY_STOP command.\n
+  *         The parser recognizes the | 0x01 | 0xFF | CRC | frame as soon as its CRC is checked and calls
+  *         @see uEmergencyStopTrigger() right away, the frame doesn't wait in the incoming queue.
+  *         The parser thread runs on the highest priority and it is woken by the receive interrupt.\n
+  *         The trigger calls the registered stop hooks first (for example MotorStopAll()),
+  *         than all the uTasks are set to #uTaskStatusError with #URABROS_ESTOP_ERROR_CODE.\n
+  *         The time from the interrupt of the last received byte until the hooks returned is measured.
+  *
+  *         Usage, in the init function of the uTask what owns the outputs:
+  *         uEmergencyStopRegister(MotorStopAll);
+  *
+  *         The hooks run in the parser thread, they must be short and they must not block.
+  */
+
+#ifndef COMMON_URABROSEMERGENCYSTOP_H_
+#define COMMON_URABROSEMERGENCYSTOP_H_
+
+#include "UrabrosTypeDef.h"
+
+#define URABROS_ESTOP_ERROR_CODE    0x1F    /**< Minor status of the uTasks stopped by the emergency stop*/
+
+/** Type of a stop hook, it has to disable the outputs it is responsible for.
+ */
+typedef void (*Urabros_EmergencyStopHook)(void);
+
+/** @struct Urabros_EmergencyStopDiagTypeDef
+ *  @brief Latency counters of the emergency stop.
+ *  @var Urabros_EmergencyStopDiagTypeDef::lastUs
+ *  Time of the last stop in microseconds, from the interrupt of the last received byte until the hooks returned
+ *  @var Urabros_EmergencyStopDiagTypeDef::maxUs
+ *  The longest stop time in microseconds since the start
+ *  @var Urabros_EmergencyStopDiagTypeDef::count
+ *  Number of the emergency stops
+ */
+typedef struct {
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint32_t count;
+}Urabros_EmergencyStopDiagTypeDef;
+
+/** Registers a stop hook, it can be called only at the init phase.
+ *  @param hook the function to be called by the emergency stop
+ *  @return executing status:\n
+ *  - uStatusError if there are already #EMERGENCY_STOP_MAX_HOOKS hooks or the hook is NULL\n
+ *  - uStatusOk otherwise
+ */
+Urabros_StatusTypeDef uEmergencyStopRegister(Urabros_EmergencyStopHook hook);
+
+/** Calls all the stop hooks, measures the latency and sets all the uTasks to error.
+ *  It is called by the parser thread, it must not be called from an interrupt.
+ *  @param rxTimeUs time of the interrupt of the last received byte, see at uTimeGetUsFromISR()
+ */
+void uEmergencyStopTrigger(uint32_t rxTimeUs);
+
+/** Gives back a copy of the latency counters.
+ *  @param diag Pointer to the variable to be loaded.
+ */
+void uEmergencyStopGetDiag(Urabros_EmergencyStopDiagTypeDef *diag);
+
+#endif /* COMMON_URABROSEMERGENCYSTOP_H_ */
@@ -0,0 +1,157 @@
+/**
+  * @file     UrabrosProfile.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Execution time probes, further informations in the header file.
+  */
+
+#include "UrabrosProfile.h"
+#include "uMessageCommon.h"
+#include <string.h>
+
+#if PROFILE_ENABLE
+
+_Static_assert(PROFILE_PROBE_NUM >= uProfile_USER && PROFILE_PROBE_NUM < PROFILE_RESET, "PROFILE_PROBE_NUM has to cover the probes of the framework");
+
+static Urabros_ProfileProbeStatTypeDef uProfileProbes[PROFILE_PROBE_NUM];  /**< Written by the probes in a critical section*/
+static Urabros_ProfileProbeStatTypeDef uProfileSnapshot;                    /**< Copy of the probe being downloaded, only the command handler uses it*/
+
+void uProfileInit(void)
+{
+#if PROFILE_COUNTER_DWT
+    CoreDebug->DEMCR   |= CoreDebug_DEMCR_TRCENA_Msk;
+    #if (__CORTEX_M == 7U)
+    DWT->LAR            = 0xC5ACCE55;   // The DWT of the Cortex-M7 is locked after reset
+    #endif
+    DWT->CYCCNT         = 0;
+    DWT->CTRL          |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+    for(uint8_t probe = 0; probe < PROFILE_PROBE_NUM; probe++) {
+        uProfileReset(probe);
+    }
+}
+
+void uProfileRecord(uint8_t probe, uint32_t start)
+{
+    uint32_t elapsed = uProfileElapsed(start);
+    Urabros_ProfileProbeStatTypeDef *probePtr;
+    UBaseType_t interruptMask;
+    uint8_t bin;
+
+    if(probe >= PROFILE_PROBE_NUM) {
+        return;
+    }
+    probePtr = uProfileProbes + probe;
+
+    // floor(log2(elapsed)), 0 and 1 cycle go to the first bin.
+    bin = elapsed ? (uint8_t)(31 - __builtin_clz(elapsed)) : 0;
+    if(bin >= PROFILE_HIST_BINS) {
+        bin = PROFILE_HIST_BINS - 1;
+    }
+
+    // The same probe can be hit by a thread and an interrupt.
+    interruptMask = taskENTER_CRITICAL_FROM_ISR();
+    probePtr->count++;
+    probePtr->sum += elapsed;
+    if(elapsed < probePtr->min) {
+        probePtr->min = elapsed;
+    }
+    if(elapsed > probePtr->max) {
+        probePtr->max = elapsed;
+    }
+    probePtr->hist[bin]++;
+    taskEXIT_CRITICAL_FROM_ISR(interruptMask);
+}
+
+Urabros_StatusTypeDef uProfileGet(uint8_t probe, Urabros_ProfileProbeStatTypeDef *statPtr)
+{
+    UBaseType_t interruptMask;
+
+    if(probe >= PROFILE_PROBE_NUM) {
+        return uStatusError;
+    }
+
+    interruptMask = taskENTER_CRITICAL_FROM_ISR();
+    *statPtr = uProfileProbes[probe];
+    taskEXIT_CRITICAL_FROM_ISR(interruptMask);
+    return uStatusOk;
+}
+
+void uProfileReset(uint8_t probe)
+{
+    UBaseType_t interruptMask;
+
+    if(probe >= PROFILE_PROBE_NUM) {
+        return;
+    }
+
+    interruptMask = taskENTER_CRITICAL_FROM_ISR();
+    memset(uProfileProbes + probe, 0, sizeof(Urabros_ProfileProbeStatTypeDef));
+    uProfileProbes[probe].min = UINT32_MAX;
+    taskEXIT_CRITICAL_FROM_ISR(interruptMask);
+}
+
+void uProfileCreateResponse(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr)
+{
+    uint8_t probe   = (uRxPtr->dataLen > 1) ? uRxPtr->data[1] : 0;
+    uint8_t first   = (uRxPtr->dataLen > 2) ? uRxPtr->data[2] : 0;
+
+    if(first == PROFILE_RESET) {
+        uProfileReset(probe);
+        first = 0;
+    }
+    // A new snapshot for the first bins, the other bins are sent from the same one.
+    if(!first && uProfileGet(probe, &uProfileSnapshot) != uStatusOk) {
+        memset(&uProfileSnapshot, 0, sizeof(uProfileSnapshot));
+    }
+
+    uMsgAppend(uTxPtr, probe);
+    uMsgAppend(uTxPtr, PROFILE_PROBE_NUM);
+    uMsgAppend(uTxPtr, PROFILE_HIST_BINS);
+    uMsgAppend32(uTxPtr, configCPU_CLOCK_HZ);
+    uMsgAppend32(uTxPtr, uProfileSnapshot.count);
+    uMsgAppend32(uTxPtr, uProfileSnapshot.count ? uProfileSnapshot.min : 0);
+    uMsgAppend32(uTxPtr, uProfileSnapshot.max);
+    uMsgAppend32(uTxPtr, uProfileSnapshot.count ? (uint32_t)(uProfileSnapshot.sum / uProfileSnapshot.count) : 0);
+    uMsgAppend(uTxPtr, first);
+
+    // As many bins as fit into the answer.
+    for(uint8_t bin = first; bin < PROFILE_HIST_BINS && uTxPtr->dataLen + 4 <= MESSAGE_BUFFER_LENGTH; bin++) {
+        uMsgAppend32(uTxPtr, uProfileSnapshot.hist[bin]);
+    }
+}
+
+#else
+
+void uProfileInit(void)
+{
+}
+
+void uProfileRecord(uint8_t probe, uint32_t start)
+{
+    (void)probe;
+    (void)start;
+}
+
+Urabros_StatusTypeDef uProfileGet(uint8_t probe, Urabros_ProfileProbeStatTypeDef *statPtr)
+{
+    (void)probe;
+    (void)statPtr;
+    return uStatusError;
+}
+
+void uProfileReset(uint8_t probe)
+{
+    (void)probe;
+}
+
+void uProfileCreateResponse(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr)
+{
+    // No probes: | 0x0D | probe | 0 | 0 |
+    uMsgAppend(uTxPtr, (uRxPtr->dataLen > 1) ? uRxPtr->data[1] : 0);
+    uMsgAppend(uTxPtr, 0);
+    uMsgAppend(uTxPtr, 0);
+}
+
+#endif /* PROFILE_ENABLE */
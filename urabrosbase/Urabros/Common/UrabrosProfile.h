@@ -0,0 +1,178 @@
+/**
+  * @file     UrabrosProfile.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Execution time probes for the hot paths, they can stay in the production build.\n
+  *         A probe measures the cycles between its begin and end, and collects the count, min, max, mean and a log2 histogram
+  *         of them in RAM. The data can be downloaded with the #uCommand_GET_PROFILE command.\n
+  *         The counter is the DWT cycle counter on the cores having it (Cortex-M3 and above, the H7),
+  *         on the Cortex-M0+ of the G0 it is the SysTick, there a probe can measure at most one tick.\n
+  *
+  *         Usage, the probe ID must be a name of #Urabros_ProfileProbeTypeDef or a define:
+  *         uProfileBegin(uProfile_CRC_MODBUS);
+  *         crc = crc16_update(CRC_START_MODBUS, input_str, num_bytes);
+  *         uProfileEnd(uProfile_CRC_MODBUS);
+  *
+  *         The probes can be used in threads and in interrupts which are allowed to call FreeRTOS FromISR functions.
+  *         With PROFILE_ENABLE 0 the probes compile to nothing.\n
+  *
+  *         Request: | 0x0D | probe | first bin |   PROFILE_RESET as first bin clears the probe.\n
+  *         Answer:  | 0x0D | probe | probe count | bin count | clock Hz 4 | count 4 | min 4 | max 4 | mean 4 | first bin | bin 4 | ... |\n
+  *         Bin n counts the measurements of 2^n - 2^(n+1)-1 cycles, the last bin counts everything above. The bins which don't
+  *         fit into one answer can be asked with a bigger first bin, the same snapshot is used until the first bin is 0 again.
+  */
+
+#ifndef COMMON_URABROSPROFILE_H_
+#define COMMON_URABROSPROFILE_H_
+
+#include "UrabrosTypeDef.h"
+#include BOARD_HAL_HEADER
+#include "FreeRTOS.h"
+#include "task.h"
+
+#define PROFILE_RESET       0xFF    /**< First bin value of the request clearing the probe*/
+
+/** The probes of the framework, the user probes can be numbered from #uProfile_USER up to #PROFILE_PROBE_NUM - 1.
+ */
+typedef enum
+{
+    uProfile_MSG_PUT_FROM_DMA   = 0, /**< @see uMsgPutFromDMA() in the UART interrupt*/
+    uProfile_MSG_SEND           = 1, /**< Encoding and starting a frame in the sender thread, without the wait for the line*/
+    uProfile_CRC_MODBUS         = 2, /**< @see crc16_update(), every CRC of the messages*/
+    uProfile_MOTOR_PULSE        = 3, /**< MotorPulseCallback() in the timer interrupt*/
+    uProfile_MOTOR_ACCELERATE   = 4, /**< MotorAccelerateSpeed() in the timer interrupt*/
+    uProfile_USER               = 5, /**< First probe free for the uTasks*/
+}Urabros_ProfileProbeTypeDef;
+
+/** @struct Urabros_ProfileProbeStatTypeDef
+ *  @brief Collected times of one probe, all in counter cycles.
+ *  @var Urabros_ProfileProbeStatTypeDef::count
+ *  Number of the measurements
+ *  @var Urabros_ProfileProbeStatTypeDef::min
+ *  The shortest measurement
+ *  @var Urabros_ProfileProbeStatTypeDef::max
+ *  The longest measurement
+ *  @var Urabros_ProfileProbeStatTypeDef::sum
+ *  Sum of the measurements for the mean
+ *  @var Urabros_ProfileProbeStatTypeDef::hist
+ *  The log2 histogram
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t hist[PROFILE_HIST_BINS];
+}Urabros_ProfileProbeStatTypeDef;
+
+#if PROFILE_ENABLE
+
+#if defined(__CORTEX_M) && (__CORTEX_M >= 3U)
+    #define PROFILE_COUNTER_DWT     1   /**< The DWT cycle counter is used*/
+#else
+    #define PROFILE_COUNTER_DWT     0   /**< The SysTick is used*/
+#endif
+
+/** Starts a probe, it declares the start time in the current scope.
+ */
+#define uProfileBegin(probe)    uint32_t uProfileStart_##probe = uProfileNow()
+
+/** Ends a probe started in the same scope and stores the elapsed time.
+ */
+#define uProfileEnd(probe)      uProfileRecord((probe), uProfileStart_##probe)
+
+/** Stops the clock of a probe started in the same scope, e.g. while the thread sleeps, @see uProfileResume().
+ */
+#define uProfilePause(probe)    uint32_t uProfileSpent_##probe = uProfileElapsed(uProfileStart_##probe)
+
+/** Continues a paused probe, the time of the pause is not counted.
+ */
+#define uProfileResume(probe)   uProfileStart_##probe = uProfileBefore(uProfileSpent_##probe)
+
+/**
+ * @brief Gives back the current value of the cycle counter.
+ * @return uint32_t counter value, only the difference of two values should be used.
+ */
+static inline uint32_t uProfileNow(void)
+{
+#if PROFILE_COUNTER_DWT
+    return DWT->CYCCNT;
+#else
+    return SysTick->VAL;
+#endif
+}
+
+/**
+ * @brief Gives back the cycles since the start value.
+ * @param start Value of @see uProfileNow() at the begin of the probe.
+ * @return uint32_t elapsed cycles.
+ */
+static inline uint32_t uProfileElapsed(uint32_t start)
+{
+#if PROFILE_COUNTER_DWT
+    return DWT->CYCCNT - start;
+#else
+    // The SysTick counts down and reloads in every tick.
+    uint32_t now    = SysTick->VAL;
+    uint32_t reload = SysTick->LOAD + 1;
+
+    return (start >= now) ? (start - now) : (start + reload - now);
+#endif
+}
+
+/**
+ * @brief Gives back the counter value the given cycles ago, the start of a resumed probe.
+ * @param cycles Cycles measured before the pause, less than one tick with the SysTick.
+ * @return uint32_t start value for @see uProfileElapsed().
+ */
+static inline uint32_t uProfileBefore(uint32_t cycles)
+{
+#if PROFILE_COUNTER_DWT
+    return DWT->CYCCNT - cycles;
+#else
+    uint32_t now    = SysTick->VAL;
+    uint32_t reload = SysTick->LOAD + 1;
+
+    return (now + cycles < reload) ? (now + cycles) : (now + cycles - reload);
+#endif
+}
+
+#else
+
+#define uProfileBegin(probe)
+#define uProfileEnd(probe)
+#define uProfilePause(probe)
+#define uProfileResume(probe)
+
+#endif /* PROFILE_ENABLE */
+
+/** Starts the cycle counter, it is called by UrabrosInit().
+ */
+void uProfileInit(void);
+
+/** Stores one measurement of a probe, it is called by @see uProfileEnd().
+ *  @param probe The probe ID, the invalid IDs are ignored.
+ *  @param start Value of @see uProfileNow() at the begin of the probe.
+ */
+void uProfileRecord(uint8_t probe, uint32_t start);
+
+/** Copies the collected times of a probe.
+ *  @param probe The probe ID.
+ *  @param statPtr Loaded with the times.
+ *  @return #uStatusOk, or #uStatusError if the probe ID is not valid.
+ */
+Urabros_StatusTypeDef uProfileGet(uint8_t probe, Urabros_ProfileProbeStatTypeDef *statPtr);
+
+/** Clears the collected times of a probe.
+ *  @param probe The probe ID.
+ */
+void uProfileReset(uint8_t probe);
+
+/** Builds the answer of the #uCommand_GET_PROFILE command.
+ *  @param uRxPtr The request.
+ *  @param uTxPtr The answer, the command byte must be already in it.
+ */
+void uProfileCreateResponse(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr);
+
+#endif /* COMMON_URABROSPROFILE_H_ */
@@ -0,0 +1,21 @@
+/**
+  * @file     UrabrosStatic.c
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Counter of the statically reserved RAM, further informations in the header file.
+  */
+
+#include "UrabrosStatic.h"
+
+static uint32_t uStaticReserved = 0;   /**< Bytes reserved by the static kernel objects, only the init phase writes it*/
+
+void uStaticReserve(uint32_t size)
+{
+    uStaticReserved += size;
+}
+
+uint32_t uStaticGetReserved(void)
+{
+    return uStaticReserved;
+}
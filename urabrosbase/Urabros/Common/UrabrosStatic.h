@@ -0,0 +1,88 @@
+/**
+  * @file     UrabrosStatic.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  Creation of the kernel objects of the framework and the uTasks.\n
+  *         With #URABROS_STATIC_ALLOCATION = 1 every queue, semaphore, mutex and thread gets its storage
+  *         at compile time through the xQueueCreateStatic() / xTaskCreateStatic() family, nothing is taken from the heap.
+  *         With #URABROS_STATIC_ALLOCATION = 0 the same macros call the dynamic functions.\n
+  *         The bytes reserved by the static objects are summed up, see at uStaticGetReserved().
+  *
+  *         Usage, instead of the FreeRTOS / CMSIS functions:
+  *         uThreadDef(myThread, my_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE);
+  *         Task.threadIdArray[0]   = uThreadCreate(myThread, NULL);
+  *         Task.mutex              = uMutexCreate();
+  *         Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
+  *
+  *         The storage of the simple macros belongs to the place where the macro is written,
+  *         so one macro must create only one object. In a loop use the ...At() macros with an own array of buffers:
+  *         #if URABROS_STATIC_ALLOCATION
+  *         static StaticSemaphore_t semBuffers[N];
+  *         #endif
+  *         sem[i] = uBinarySemaphoreCreateAt(&semBuffers[i]);
+  *
+  *         The instances parameter of uThreadDef() must be 1.
+  */
+
+#ifndef COMMON_URABROSSTATIC_H_
+#define COMMON_URABROSSTATIC_H_
+
+#include "UrabrosTypeDef.h"
+#include "semphr.h"
+#include "queue.h"
+
+/** Adds bytes to the reserved static RAM counter, it is called by the macros of this file.
+ *  @param size number of the reserved bytes
+ */
+void uStaticReserve(uint32_t size);
+
+/** Gives back the RAM reserved by the statically created kernel objects (control blocks, stacks, queue storages).
+ *  @return number of bytes, 0 if #URABROS_STATIC_ALLOCATION is disabled
+ */
+uint32_t uStaticGetReserved(void);
+
+#if URABROS_STATIC_ALLOCATION
+
+#if configSUPPORT_STATIC_ALLOCATION != 1
+    #error "URABROS_STATIC_ALLOCATION needs configSUPPORT_STATIC_ALLOCATION 1 in the FreeRTOSConfig.h"
+#endif
+
+#define uMutexCreateAt(buffer)                          (uStaticReserve(sizeof(StaticSemaphore_t)), xSemaphoreCreateMutexStatic(buffer))
+#define uBinarySemaphoreCreateAt(buffer)                (uStaticReserve(sizeof(StaticSemaphore_t)), xSemaphoreCreateBinaryStatic(buffer))
+#define uCountingSemaphoreCreateAt(max, init, buffer)   (uStaticReserve(sizeof(StaticSemaphore_t)), xSemaphoreCreateCountingStatic(max, init, buffer))
+
+#define uMutexCreate()                      ({ static StaticSemaphore_t uStaticSem; uMutexCreateAt(&uStaticSem); })
+#define uBinarySemaphoreCreate()            ({ static StaticSemaphore_t uStaticSem; uBinarySemaphoreCreateAt(&uStaticSem); })
+#define uCountingSemaphoreCreate(max, init) ({ static StaticSemaphore_t uStaticSem; uCountingSemaphoreCreateAt(max, init, &uStaticSem); })
+
+#define uQueueCreate(length, itemSize)      ({ static StaticQueue_t uStaticQueue;                           \
+                                               static uint8_t uStaticQueueStorage[(length) * (itemSize)];   \
+                                               uStaticReserve(sizeof(uStaticQueue) + sizeof(uStaticQueueStorage)); \
+                                               xQueueCreateStatic(length, itemSize, uStaticQueueStorage, &uStaticQueue); })
+
+#define uThreadDef(name, thread, priority, instances, stacksz)  \
+    static StackType_t name##Stack[stacksz];                    \
+    static StaticTask_t name##Tcb;                              \
+    osThreadStaticDef(name, thread, priority, instances, stacksz, name##Stack, &name##Tcb)
+
+#define uThreadCreate(name, argument)       (uStaticReserve(sizeof(name##Stack) + sizeof(name##Tcb)), osThreadCreate(osThread(name), argument))
+
+#else
+
+#define uMutexCreateAt(buffer)                          xSemaphoreCreateMutex()
+#define uBinarySemaphoreCreateAt(buffer)                xSemaphoreCreateBinary()
+#define uCountingSemaphoreCreateAt(max, init, buffer)   xSemaphoreCreateCounting(max, init)
+
+#define uMutexCreate()                      xSemaphoreCreateMutex()
+#define uBinarySemaphoreCreate()            xSemaphoreCreateBinary()
+#define uCountingSemaphoreCreate(max, init) xSemaphoreCreateCounting(max, init)
+
+#define uQueueCreate(length, itemSize)      xQueueCreate(length, itemSize)
+
+#define uThreadDef(name, thread, priority, instances, stacksz)  osThreadDef(name, thread, priority, instances, stacksz)
+#define uThreadCreate(name, argument)       osThreadCreate(osThread(name), argument)
+
+#endif /* URABROS_STATIC_ALLOCATION */
+
+#endif /* COMMON_URABROSSTATIC_H_ */
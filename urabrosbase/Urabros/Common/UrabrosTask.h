@@ -17,6 +17,8 @@
 
 #include "UrabrosSharedResources.h"
 #include "UrabrosTypeDef.h"
+#include "UrabrosMaster.h"
+#include "UrabrosStatic.h"
 
 /** A static handler variable, the other source files make modifications on this varaible.
  */
@@ -62,81 +64,178 @@ static inline Urabros_StatusTypeDef uTaskResume(void)
     return uStatusOk;
 }
 
+/** Publishes a new status byte of the uTask with an increased sequence number, see at @see UrabrosPublishTaskStatus().
+ *  @param mask the bits of the status byte to be changed
+ *  @param value the new value of the changed bits
+ */
+static inline void uTaskPublishStatus(uint8_t mask, uint8_t value)
+{
+    UrabrosPublishTaskStatus(&Task, mask, value);
+}
+
 /** Sets the status of the uTask.
  *  @param the desired status of the uTask
  *  @return executing status:\n
- *  - uStatusOk every time. Maybe a timeout should be added if we don't use portMAX_DELAY
+ *  - uStatusOk every time.
  */
 static inline Urabros_StatusTypeDef uTaskSetStatus(Urabros_TaskStatusTypeDef status)
 {
-    xSemaphoreTake(Task.mutex, portMAX_DELAY);
-    Task.status = status;
-    xSemaphoreGive(Task.mutex);
+    uTaskPublishStatus((uint8_t)~URABROS_STATUS_MINOR_MASK, URABROS_STATUS_WORD(status, 0));
     return uStatusOk;
 }
 
 /** Sets the errorCode of the uTask.
- *  @param the desired error code of the uTask
+ *  @param the desired error code of the uTask, 0 - 31
  *  @return executing status:\n
- *  - uStatusOk every time. Maybe a timeout should be added if we don't use portMAX_DELAY
+ *  - uStatusOk every time.
  */
 static inline Urabros_StatusTypeDef uTaskSetErrorCode(uint8_t errCode)
 {
-    xSemaphoreTake(Task.mutex, portMAX_DELAY);
-    Task.errorCode = errCode;
-    xSemaphoreGive(Task.mutex);
+    uTaskPublishStatus(URABROS_STATUS_MINOR_MASK, errCode);
     return uStatusOk;
 }
 
-/** Sets the status and the error code of the uTask.
+/** Sets the status and the error code of the uTask at once.
  *  @param the desired status of the uTask
- *  @param the desired error code of the uTask
+ *  @param the desired error code of the uTask, 0 - 31
  *  @return executing status:\n
- *  - uStatusOk every time. Maybe a timeout should be added if we don't use portMAX_DELAY
+ *  - uStatusOk every time.
  */
 static inline Urabros_StatusTypeDef uTaskSetStatusAndErrorCode(Urabros_TaskStatusTypeDef status, uint8_t errCode)
 {
-    xSemaphoreTake(Task.mutex, portMAX_DELAY);
-    Task.status = status;
-    Task.errorCode = errCode;
-    xSemaphoreGive(Task.mutex);
+    uTaskPublishStatus(URABROS_STATUS_BYTE_MASK, URABROS_STATUS_WORD(status, errCode));
     return uStatusOk;
 }
 
+/** Sets up the data channel of the uTask, it has to be called in the init function before the threads are created.
+ *  Without it the uTask can't receive #uCommand_SEND_DATA payloads.
+ *  @param buffer the slots, its size must be URABROS_TASK_DATA_BUFFER_SIZE(slotSize, slotCount)
+ *  @param slotSize maximal length of one payload
+ *  @param slotCount number of payloads can wait at the same time, it must be a power of two
+ *  @return executing status:\n
+ *  - uStatusError if the slotCount is not a power of two or the semaphore can't be created\n
+ *  - uStatusOk otherwise
+ */
+static inline Urabros_StatusTypeDef uTaskDataInit(uint8_t *buffer, uint8_t slotSize, uint8_t slotCount)
+{
+    if(!slotSize || !slotCount || (slotCount & (slotCount - 1)) || slotCount > 128)
+        return uStatusError;
+
+    Task.dataChannel.filled = uCountingSemaphoreCreate(slotCount, 0);
+    if(Task.dataChannel.filled == NULL)
+        return uStatusError;
+
+    Task.dataChannel.slotSize   = slotSize;
+    Task.dataChannel.slotCount  = slotCount;
+    Task.dataChannel.writeIdx   = 0;
+    Task.dataChannel.readIdx    = 0;
+    Task.dataChannel.buffer     = buffer;
+    return uStatusOk;
+}
+
+/** Waits for the next payload from the UrabrosMaster.c, the thread sleeps until it arrives.
+ *  The payload stays in its slot until @see uTaskDataRelease() is called, so it is not copied.
+ *  Only one thread of the uTask is allowed to receive.
+ *  @param dataPtr loaded with the address of the payload
+ *  @param timeout maximal waiting time in ticks, 0 for polling, portMAX_DELAY for waiting forever
+ *  @return length of the payload, 0 if nothing arrived
+ */
+static inline uint8_t uTaskDataReceive(uint8_t **dataPtr, TickType_t timeout)
+{
+    uint8_t *slotPtr;
+
+    if(xSemaphoreTake(Task.dataChannel.filled, timeout) != pdTRUE)
+        return 0;
+
+    slotPtr = Task.dataChannel.buffer + (Task.dataChannel.readIdx & (Task.dataChannel.slotCount - 1)) * (Task.dataChannel.slotSize + 1);
+    *dataPtr = slotPtr + 1;
+    return slotPtr[0];
+}
+
+/** Gives back the slot of the payload got by @see uTaskDataReceive(), the pointer is invalid after it.
+ */
+static inline void uTaskDataRelease(void)
+{
+    Task.dataChannel.readIdx++;
+}
+
+/** Safe point of the first thread of the uTask for #uCommand_PAUSE, the thread parks here while the uTask is paused.
+ *  The status is #uTaskStatusStopped while parking, the previous status is set back after #uCommand_RESUME.
+ *  It is called by @see uTaskWaitForSignal(), a long running loop should call it too, where the thread holds no mutex.
+ *  The other signals arriving while parking are kept for the next wait.
+ *  @return 1 if the thread parked, 0 if the uTask is not paused
+ */
+static inline uint8_t uTaskPausePoint(void)
+{
+    uint32_t received   = 0;
+    uint32_t kept       = 0;
+    uint8_t statusByte;
+
+    if(!Task.paused)
+        return 0;
+
+    statusByte = URABROS_STATUS_BYTE(Task.statusWord);
+    uTaskSetStatus(uTaskStatusStopped);
+    while(Task.paused) {
+        xTaskNotifyWait(0, URABROS_SIGNAL_ALL, &received, portMAX_DELAY);
+        kept |= received;
+    }
+    uTaskPublishStatus(URABROS_STATUS_BYTE_MASK, statusByte);
+
+    kept &= ~(uint32_t)(uSignalStop | uSignalResume);
+    if(kept)
+        xTaskNotify(xTaskGetCurrentTaskHandle(), kept, eSetBits);
+
+    return 1;
+}
+
+/** Waits until one of the given signals arrives, the other signals arrived meanwhile are dropped.
+ *  The signals are task notification bits, only the first thread of the uTask (threadIdArray[0]) can wait for them.
+ *  The thread parks here if the uTask is paused, see at @see uTaskPausePoint().
+ *  @param signals mask of the awaited #Urabros_SignalMasterTypeDef signals
+ *  @return the awaited signals what arrived
+ */
+static inline uint32_t uTaskWaitForSignal(uint32_t signals)
+{
+    uint32_t received = 0;
+
+    for(;;) {
+        uTaskPausePoint();
+        xTaskNotifyWait(0, URABROS_SIGNAL_ALL, &received, portMAX_DELAY);
+        if(Task.paused) {
+            // The signals are given back to the thread, uTaskPausePoint() keeps them until the resume.
+            xTaskNotify(xTaskGetCurrentTaskHandle(), received, eSetBits);
+            continue;
+        }
+        if(received & signals)
+            break;
+    }
+
+    return received & signals;
+}
+
 /** Set uTask's status to #uTaskStatusWaitingForStartSignal\n
  *  than it is waiting until the #uSignalStart arrives, than set it's status to #uTaskStatusRunning
  *  @return executing status:\n
- *  - uStatusError if the received signal is not #uSignalStart\n
- *  - uStatusOk if it went well.
+ *  - uStatusOk every time, the other signals are dropped while waiting.
  */
 static inline Urabros_StatusTypeDef uTaskWaitForSignalStart()
 {
-    uint8_t recData = 0;
     uTaskSetStatus(uTaskStatusWaitingForStartSignal);
-    xQueueReceive(Task.queueMaster, &recData, portMAX_DELAY);
-    if(recData == uSignalStart) {
-        uTaskSetStatus(uTaskStatusRunning);
-        return uStatusOk;
-    } else {
-        return uStatusError;
-    }
+    uTaskWaitForSignal(uSignalStart);
+    uTaskSetStatus(uTaskStatusRunning);
+    return uStatusOk;
 }
 
 /** Set uTask's status to #uTaskStatusWaitingForACKSignal\n
  *  than it is waiting until the #uSignalACK arrives.
  *  @return executing status:\n
- *  - uStatusError if the received signal is not #uSignalStart\n
- *  - uStatusOk if it went well.
+ *  - uStatusOk every time.
  */
 static inline Urabros_StatusTypeDef uTaskWaitFoSignalACK()
 {
-    uint8_t recData = 0;
     uTaskSetStatus(uTaskStatusWaitingForACKSignal);
-
-    while(recData != uSignalACK) {
-        xQueueReceive(Task.queueMaster, &recData, portMAX_DELAY);
-    }
-
+    uTaskWaitForSignal(uSignalACK);
     return uStatusOk;
 }
 
@@ -0,0 +1,85 @@
+/**
+  * @file     UrabrosTime.h
+  * @author   marton.lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  This header contains static functions for measuring short times with microsecond resolution.\n
+  *         The time is calculated from the FreeRTOS tick counter and the current value of the SysTick timer,
+  *         so it works on every Cortex-M core without any extra peripheral.\n
+  *         uTimeGetUs() can be called only from threads, interrupts have to use uTimeGetUsFromISR().
+  *         The value overflows after ~71 minutes, so only differences of two values should be used.\n
+  *         The time never goes back, even if the SysTick reloaded but its interrupt couldn't run yet (critical section,
+  *         PendSV of the context switch): then the pending SysTick interrupt is counted as a tick.
+  */
+
+#ifndef COMMON_URABROSTIME_H_
+#define COMMON_URABROSTIME_H_
+
+#include "UrabrosConfig.h"
+#include <stdint.h>
+#include BOARD_HAL_HEADER
+#include "FreeRTOS.h"
+#include "task.h"
+
+/** Length of one FreeRTOS tick in microseconds.
+ */
+#define UTIME_US_PER_TICK   (1000000UL / configTICK_RATE_HZ)
+
+/**
+ * @brief Adds the SysTick position to the tick count. If the SysTick interrupt is pending the tick count is
+ *        one behind, so it is increased and the SysTick is read again, the first reading could be before the reload.
+ * @param tick The FreeRTOS tick count.
+ * @return uint32_t time in microseconds.
+ */
+static inline uint32_t uTimeFromTick(uint32_t tick)
+{
+    uint32_t load       = SysTick->LOAD + 1;
+    uint32_t elapsed    = load - SysTick->VAL; // SysTick counts down
+
+    if(SCB->ICSR & SCB_ICSR_PENDSTSET_Msk) {
+        tick++;
+        elapsed = load - SysTick->VAL;
+        if(elapsed >= load) {
+            elapsed = 0; // Reached 0 but not reloaded yet
+        }
+    }
+
+    return (tick * UTIME_US_PER_TICK) + ((elapsed * UTIME_US_PER_TICK) / load);
+}
+
+/**
+ * @brief Gives back the time since the start of the scheduler in microseconds.
+ *        If the tick interrupt comes while reading the SysTick, the reading is repeated.
+ * @return uint32_t time in microseconds.
+ */
+static inline uint32_t uTimeGetUs(void)
+{
+    uint32_t tick;
+    uint32_t timeUs;
+
+    do {
+        tick    = xTaskGetTickCount();
+        timeUs  = uTimeFromTick(tick);
+    } while(tick != xTaskGetTickCount());
+
+    return timeUs;
+}
+
+/**
+ * @brief Same as @see uTimeGetUs() but it can be called from interrupts.
+ * @return uint32_t time in microseconds.
+ */
+static inline uint32_t uTimeGetUsFromISR(void)
+{
+    uint32_t tick;
+    uint32_t timeUs;
+
+    do {
+        tick    = xTaskGetTickCountFromISR();
+        timeUs  = uTimeFromTick(tick);
+    } while(tick != xTaskGetTickCountFromISR());
+
+    return timeUs;
+}
+
+#endif /* COMMON_URABROSTIME_H_ */
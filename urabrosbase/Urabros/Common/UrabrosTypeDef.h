@@ -71,47 +71,83 @@ typedef enum
     uCommand_PAUSE          = 0x05, /**< Pause a Task with a given ID.*/
     uCommand_RESUME         = 0x06, /**< Resume a Task with a given ID.*/
     uCommand_DATA_FROM_TASK = 0x07, /**< If a task sends data to PC directly.*/
+    uCommand_BULK           = 0x08, /**< Fragmented bulk transfer between the PC and a Task, see at uBulkTransfer.h*/
+    uCommand_GET_LINK_STATS = 0x09, /**< Gets the byte, frame and drop counters of the streams sharing the UART, see at uLinkScheduler.h*/
+    uCommand_SUBSCRIBE      = 0x0A, /**< Turns on (1) or off (0) the #uCommand_STATUS_NOTIFY messages, the answer echoes the value.*/
+    uCommand_STATUS_NOTIFY  = 0x0B, /**< Sent by the MCU without request when task statuses changed: | 0x0B | id | status | id | status |...*/
+    uCommand_GET_DIAGNOSTICS = 0x0C, /**< Gets the CPU load and stack of the threads, the heap and the message queue statistics, see at UrabrosDiagnostics.h*/
+    uCommand_GET_PROFILE    = 0x0D, /**< Gets the execution times collected by a probe, see at UrabrosProfile.h*/
     uCommand_RECEIVE_ERROR  = 0xFE, /**< If one of the incoming data were corrupted or badly designed, this indicates its failure.*/
     uCommand_EMERGENCY_STOP = 0xFF, /**< Calls emergency stop function*/
 }Urabros_CommandType;
 
-/** @struct Urabros_CommandTypedef
- *  @brief This structure is holding the status of a command it's size is 1 byte, because main is 3 bit and minor is 5 bit long.
- *  @var Urabros_CommandStatusTypeDef::main
- *  Holds the main status of the Task (Running, waiting, etc...)
- *  @var Urabros_CommandStatusTypeDef::minor
- *  Holds the minor status of the Task
+/**
+ *  An enum for the sub operations of the #uCommand_BULK command, it is the second byte of the message.
  */
-typedef struct {
-    uint8_t main    : 3;
-    uint8_t minor   : 5;
-}Urabros_CommandStatusTypeDef, *Urabros_CommandStatusPtrTypeDef;
+typedef enum
+{
+    uBulkOp_OPEN            = 0x01, /**< Starts a transfer, it carries the total length.*/
+    uBulkOp_DATA            = 0x02, /**< One fragment of the data with its sequence number.*/
+    uBulkOp_ACK             = 0x03, /**< Cumulative acknowledge, carries the next expected sequence number.*/
+    uBulkOp_ABORT           = 0x04, /**< Cancels the transfer, carries the reason.*/
+}Urabros_BulkOpTypeDef;
+
+/**
+ *  An enum for the result of a bulk transfer.
+ */
+typedef enum
+{
+    uBulkOk                 = 0x00, /**< Transfer accepted or finished.*/
+    uBulkNoReceiver         = 0x01, /**< The Task is not waiting for bulk data.*/
+    uBulkTooBig             = 0x02, /**< The data doesn't fit in the buffer of the Task.*/
+    uBulkBusy               = 0x03, /**< There is no free session or a transfer is already running.*/
+    uBulkAborted            = 0x04, /**< The other side aborted the transfer.*/
+    uBulkTimeout            = 0x05, /**< No progress in time, the retries are over.*/
+    uBulkBadFragment        = 0x06, /**< Fragment length or sequence number is not valid.*/
+}Urabros_BulkStatusTypeDef;
+
+/* Status word of an uTask, see at Urabros_TaskTypeDef::statusWord */
+#define URABROS_STATUS_MAIN_SHIFT       5           /**< The main status is the top 3 bits of the status byte*/
+#define URABROS_STATUS_MINOR_MASK       0x1F        /**< The minor status (error code) is the bottom 5 bits of the status byte*/
+#define URABROS_STATUS_BYTE_MASK        0xFF        /**< The status byte is the lowest byte of the status word, it is sent as it is to the PC*/
+#define URABROS_STATUS_SEQ_STEP         0x100       /**< The sequence counter is in the top 24 bits of the status word*/
+#define URABROS_STATUS_WORD(main, minor)    ((uint32_t)((((uint32_t)(main)) << URABROS_STATUS_MAIN_SHIFT) | ((minor) & URABROS_STATUS_MINOR_MASK))) /**< Status word with 0 sequence number*/
+#define URABROS_STATUS_BYTE(word)       ((uint8_t)((word) & URABROS_STATUS_BYTE_MASK))                          /**< The status byte of a status word*/
+#define URABROS_STATUS_MAIN(word)       ((Urabros_TaskStatusTypeDef)(URABROS_STATUS_BYTE(word) >> URABROS_STATUS_MAIN_SHIFT)) /**< The main status of a status word*/
+#define URABROS_STATUS_MINOR(word)      ((uint8_t)((word) & URABROS_STATUS_MINOR_MASK))                         /**< The minor status of a status word*/
+#define URABROS_STATUS_SEQ(word)        ((uint32_t)(word) >> 8)                                                 /**< The sequence number of a status word, it is increased by every change*/
+
+/* Forward declaration, the command holds a pointer to its uTask */
+struct Urabros_TaskTypeDef_s;
 
 /** @struct Urabros_CommandTypedef
  *  @brief The commandType structure, the command list is made of theese structs.
  *  @var Urabros_CommandTypedef::id
  *  Id of the command and the connected Task
- *  @var Urabros_CommandTypedef::status
- *  Main and Minor status of the connected Task
+ *  @var Urabros_CommandTypedef::task
+ *  The connected Task, its status is read directly from its status word, see at Urabros_TaskTypeDef::statusWord
  */
 typedef struct {
     Urabros_CommandIdTypedef        id;
-    Urabros_CommandStatusTypeDef    status;
+    struct Urabros_TaskTypeDef_s    *task;
 }Urabros_CommandTypedef, *Urabros_CommandPtrTypedef;
 
 /* URABROS TASK RELEVANT TYPEDEFS */
 /**
  *  An enum conatins the most important signals what can be sent from UrabrosMaster to target Task.
+ *  Every signal is one task notification bit of the first thread of the Task (threadIdArray[0]), see at @see uTaskWaitForSignal().
  */
 typedef enum
 {
-    uSignalStart    = 0xAA, /**< This signal starts the Task if its in uTaskStatusWaitingForStartSignal state*/
-    uSignalACK      = 0xBB, /**< This signal is sent to Task if it's in uTaskStatusWaitingForACKSignal,\nthan the Task goes to waitng for start signal phase*/
-    uSignalSendData = 0xCC, /**< This signal is tells that data will be arriving from Urabros Master,\nthis is not used at the moment.*/
-    uSignalStop     = 0XDD, /**< This signal stops the Task.\nThis not implemented jet.*/
-    uSignalResume   = 0XEE, /**< This signal resumes the Task.\nThis isnot implemented jet.*/
+    uSignalStart    = 0x01, /**< This signal starts the Task if its in uTaskStatusWaitingForStartSignal state*/
+    uSignalACK      = 0x02, /**< This signal is sent to Task if it's in uTaskStatusWaitingForACKSignal,\nthan the Task goes to waitng for start signal phase*/
+    uSignalSendData = 0x04, /**< This signal is tells that data will be arriving from Urabros Master,\nthis is not used at the moment, the data has its own channel.*/
+    uSignalStop     = 0x08, /**< This signal pauses the Task, it is sent by #uCommand_PAUSE.\nThe Task parks itself at its next safe point, see at @see uTaskPausePoint().*/
+    uSignalResume   = 0x10, /**< This signal resumes the Task paused by #uSignalStop, it is sent by #uCommand_RESUME.*/
 }Urabros_SignalMasterTypeDef;
 
+#define URABROS_SIGNAL_ALL  0x1F    /**< Mask of all the signal bits, the other notification bits of the Task are free to use*/
+
 /**
  *  An enum for describing the current status of a uTask
  */
@@ -157,6 +193,37 @@ typedef enum
     uTaskMode_Continious                = 1, /**< The task doesn't wait for any signal form the Urabros. It is continuously doing it's job*/
 }Urabros_TaskMode;
 
+/** Size of the buffer an uTask has to give to @see uTaskDataInit(), every slot holds a length byte and slotSize data bytes.
+ */
+#define URABROS_TASK_DATA_BUFFER_SIZE(slotSize, slotCount)  (((slotSize) + 1) * (slotCount))
+
+/** @struct Urabros_TaskDataChannelTypeDef
+ *  @brief Channel carrying the #uCommand_SEND_DATA payloads from the UrabrosMaster.c to an uTask, one payload in one slot.
+ *         The UrabrosMaster.c copies the payload into the next free slot, the uTask gets a pointer to the slot,
+ *         so the payload keeps its boundaries and the uTask wakes up at once. See at @see uTaskDataReceive().
+ *  @var Urabros_TaskDataChannelTypeDef::buffer
+ *  The slots, given by the uTask, NULL if the uTask doesn't receive data.
+ *  @var Urabros_TaskDataChannelTypeDef::slotSize
+ *  Maximal length of one payload.
+ *  @var Urabros_TaskDataChannelTypeDef::slotCount
+ *  Number of the slots, it must be a power of two.
+ *  @var Urabros_TaskDataChannelTypeDef::writeIdx
+ *  Free running index of the next slot to be filled, only the UrabrosMaster.c changes it.
+ *  @var Urabros_TaskDataChannelTypeDef::readIdx
+ *  Free running index of the next slot to be read, only the uTask changes it.
+ *  @var Urabros_TaskDataChannelTypeDef::filled
+ *  Counting semaphore, it is given for every filled slot.
+ */
+typedef struct
+{
+    uint8_t             *buffer;
+    uint8_t             slotSize;
+    uint8_t             slotCount;
+    volatile uint8_t    writeIdx;
+    volatile uint8_t    readIdx;
+    SemaphoreHandle_t   filled;
+}Urabros_TaskDataChannelTypeDef;
+
 /** @struct Urabros_TaskTypeDef
  *  @brief Structure to describe an Urabros Tak
  *         In shoreter name: uTask, this is one of the most important variable int the framework.\n
@@ -167,13 +234,13 @@ typedef enum
  *  @var Urabros_TaskTypeDef::mode
  *  This variable indicates it the task is behaves as OneTime or Continious.
  * 
- *  @var Urabros_TaskTypeDef::status
- *  This varibale holds the status of the uTask. It values are fixed.
- * 
- *  @var Urabros_TaskTypeDef::errorCode
- *  This variable holds the errorCode of the current uTask,
- *  It's values should be implemented in the tasks header.
- *  Even if it is an uint8_t the value can be between only 0 - 31 !!!
+ *  @var Urabros_TaskTypeDef::statusWord
+ *  This variable holds the status and the errorCode of the uTask and a sequence number in one 32 bit word.\n
+ *  Bit 7-5: status (main), its values are fixed see at #Urabros_TaskStatusTypeDef.\n
+ *  Bit 4-0: errorCode (minor), its values should be implemented in the tasks header, it can be between only 0 - 31 !!!\n
+ *  Bit 31-8: sequence number, it is increased by every change.\n
+ *  The uTask publishes it with one store (@see uTaskSetStatus()), so the readers always see a consistent status without mutex.
+ *  Read it with the URABROS_STATUS_MAIN(), URABROS_STATUS_MINOR() and URABROS_STATUS_SEQ() macros.
  * 
  *  @var Urabros_TaskTypeDef::threadIdArrayLen
  *  Number of the CMSIS-RTOS threads this uTasks uses.
@@ -194,9 +261,13 @@ typedef enum
  *  UrabrosMaster.c and the Task are using the taskTypedef variable,
  *  so it is necessary to have a mutex here.
  * 
- *  @var Urabros_TaskTypeDef::queueMaster
- *  This queue variable is for the communication between the UrabrosMaster.c and this Task
- *  The Task only receive messages from UrabrosMaster.c so this is an RX queue
+ *  @var Urabros_TaskTypeDef::paused
+ *  1 between #uCommand_PAUSE and #uCommand_RESUME, only the UrabrosMaster.c writes it.
+ *  The first thread of the Task parks while it is set, see at @see uTaskPausePoint().
+ * 
+ *  @var Urabros_TaskTypeDef::dataChannel
+ *  The payloads of the #uCommand_SEND_DATA commands arrive here, see at #Urabros_TaskDataChannelTypeDef.
+ *  It is set up by @see uTaskDataInit(), the Task can't receive data without it.
  * 
  *  @var Urabros_TaskTypeDef::queueTask
  *  This queue variable is for receiving data from other Tasks.
@@ -204,17 +275,17 @@ typedef enum
  *  but if there is no other way use this. For using this variable each Tasks has to see
  *  the others taskTypeDef variables. Use extern for it.
  */
-typedef struct
+typedef struct Urabros_TaskTypeDef_s
 {
     Urabros_TaskMode            mode;
-    Urabros_TaskStatusTypeDef   status;
-    uint8_t                     errorCode;
+    volatile uint32_t           statusWord;
     uint8_t                     threadIdArrayLen;
     osThreadId                  threadIdArray[MAX_SUBTHREADS];
     Urabros_CommandIdTypedef    responsibleTaskId;
     SemaphoreHandle_t           mutex;
-    QueueHandle_t               queueMaster;
+    volatile uint8_t            paused;
     QueueHandle_t               queueTask;
+    Urabros_TaskDataChannelTypeDef dataChannel;
 }Urabros_TaskTypeDef, *Urabros_TaskPtrTypeDef;
 
 /** @struct Urabros_DriverTypeDef
@@ -274,42 +345,153 @@ typedef enum {
  * 
  *  @var Urabros_Msg::crc16Code
  *  an uint16_t varaible holding the calculated or received CRC16 number. The CRC only calculated to the data part.
+ * 
+ *  @var Urabros_Msg::crcLen
+ *  Number of data bytes already included in crc16Code. The uMsgAppend functions update the CRC while appending,
+ *  so @see uMsgSetCrc() has to calculate only the rest. 0 means crc16Code is not a running CRC.
  */
 typedef struct {
     uint8_t  dataLen;
     uint8_t  data[MESSAGE_BUFFER_LENGTH];
     uint16_t crc16Code;
+    uint8_t  crcLen;
 }Urabros_Msg, *Urabros_MsgPtr;
 
-// Holds the incoming messages in a filo buffer
+// Holds the incoming messages in a fifo buffer
 
 /** @struct Urabros_MsgInBuffer
- *  @brief Structure for holding the incoming messages ina filo buffer.
- * 
+ *  @brief Structure for holding the incoming messages in a single producer / single consumer lock-free fifo buffer.
+ *         The receive path (producer) fills the slot pointed by writeIdx in place, than publishes it by incrementing writeIdx.\n
+ *         The UrabrosMaster (consumer) processes the slot pointed by readIdx by reference, than releases it by incrementing readIdx.\n
+ *         Both indexes are free running counters, the slot is selected by masking, so #MESSAGE_IN_ARRAY_LENGTH must be a power of two.
+ *
  *  @var Urabros_MsgInBuffer::msgBuff[MESSAGE_IN_ARRAY_LENGTH]
  *  An array of #Urabros_Msg type variables. The  size can be modified here: #MESSAGE_IN_ARRAY_LENGTH
- * 
- *  @var Urabros_MsgInBuffer::numOfMsg
- *  This variable holds the current number of messages inside the buffer. Its max value is 255.
+ *
+ *  @var Urabros_MsgInBuffer::rxTimeUs[MESSAGE_IN_ARRAY_LENGTH]
+ *  The time in microseconds when the message of the same slot was put into the buffer, see @see uTimeGetUs().
+ *
+ *  @var Urabros_MsgInBuffer::writeIdx
+ *  Number of messages ever put into the buffer. Only the producer writes it.
+ *
+ *  @var Urabros_MsgInBuffer::readIdx
+ *  Number of messages ever released from the buffer. Only the consumer writes it.
+ *
+ *  @var Urabros_MsgInBuffer::dropCount
+ *  Number of incoming messages dropped, because the buffer was full.
+ *
+ *  @var Urabros_MsgInBuffer::highWater
+ *  The maximum number of messages were waiting in the buffer at the same time.
  */
 typedef struct {
     Urabros_Msg         msgBuff[MESSAGE_IN_ARRAY_LENGTH];
-    uint8_t             numOfMsg;       // How many messages are in the buffer
+    uint32_t            rxTimeUs[MESSAGE_IN_ARRAY_LENGTH]; // Time of arrival of the messages
+    volatile uint32_t   writeIdx;       // Producer index
+    volatile uint32_t   readIdx;        // Consumer index
+    uint32_t            dropCount;      // How many messages were lost
+    uint8_t             highWater;      // Maximum number of waiting messages
 }Urabros_MsgInBuffer, *Urabros_MsgInBufferPtr;
 
 
+/**
+ * An enum for describe the priority classes of the outgoing messages.
+ * The lower value is sent out first.
+ */
+typedef enum {
+    uMsgOutPrio_Response    = 0, /**< Command responses and statuses, they are sent out first.*/
+    uMsgOutPrio_Bulk        = 1, /**< Data from the tasks (#uCommand_DATA_FROM_TASK), sent out if there is no response waiting.*/
+    uMsgOutPrio_Count       = 2, /**< Number of priority classes, leave it as the last one.*/
+}Urabros_MsgOutPriorityTypeDef;
+
+/** @struct Urabros_MsgOutLane
+ *  @brief Structure for holding the outgoing messages of one priority class in a fifo buffer.
+ *
+ *  @var Urabros_MsgOutLane::msgBuff[MESSAGE_OUT_ARRAY_LENGTH]
+ *  An array of #Urabros_Msg type variables. The  size can be modified here: #MESSAGE_OUT_ARRAY_LENGTH
+ *
+ *  @var Urabros_MsgOutLane::readIdx
+ *  Index of the oldest message in the lane.
+ *
+ *  @var Urabros_MsgOutLane::writeIdx
+ *  Index of the slot where the next message will be placed.
+ *
+ *  @var Urabros_MsgOutLane::numOfMsg
+ *  The current number of messages inside the lane.
+ *
+ *  @var Urabros_MsgOutLane::freeSlots
+ *  Counting semaphore holding the number of free slots, the blocking put waits on it.
+ *
+ *  @var Urabros_MsgOutLane::dropCount
+ *  How many messages were refused because the lane was full.
+ *
+ *  @var Urabros_MsgOutLane::highWater
+ *  The maximum number of messages were waiting in the lane at the same time.
+ */
+typedef struct {
+    Urabros_Msg         msgBuff[MESSAGE_OUT_ARRAY_LENGTH];
+    uint8_t             readIdx;        // Oldest message
+    uint8_t             writeIdx;       // Next free slot
+    uint8_t             numOfMsg;       // How many messages are in the lane
+    SemaphoreHandle_t   freeSlots;      // Number of free slots
+    uint32_t            dropCount;      // How many messages were lost
+    uint8_t             highWater;      // Maximum number of waiting messages
+}Urabros_MsgOutLane, *Urabros_MsgOutLanePtr;
+
 /** @struct Urabros_MsgOutBuffer
- *  @brief Structure for holding the outgoing messages ina filo buffer.
+ *  @brief Structure for holding the outgoing messages in priority ordered fifo lanes.
  * 
- *  @var Urabros_MsgOutBuffer::msgBuff[MESSAGE_OUT_ARRAY_LENGTH]
- *  An array of #Urabros_Msg type variables. The  size can be modified here: #MESSAGE_OUT_ARRAY_LENGTH
+ *  @var Urabros_MsgOutBuffer::lane[uMsgOutPrio_Count]
+ *  One fifo for every priority class, see at #Urabros_MsgOutPriorityTypeDef.
  * 
  *  @var Urabros_MsgOutBuffer::numOfMsg
- *  This variable holds the current number of messages inside the buffer. Its max value is 255.
+ *  This variable holds the current number of messages inside all the lanes. Its max value is 255.
  */
 typedef struct {
-    Urabros_Msg         msgBuff[MESSAGE_OUT_ARRAY_LENGTH];
+    Urabros_MsgOutLane  lane[uMsgOutPrio_Count];
     uint8_t             numOfMsg;       // How many messages are in the buffer
 }Urabros_MsgOutBuffer, *Urabros_MsgOutBufferPtr;
 
+/** @struct Urabros_TxSegmentTypeDef
+ *  @brief One piece of a frame sent out by DMA directly from its place, see @see uMsgTxStartSegments().
+ *
+ *  @var Urabros_TxSegmentTypeDef::data
+ *  Address of the first byte, it must stay valid until the transfer is finished.
+ *
+ *  @var Urabros_TxSegmentTypeDef::len
+ *  Number of bytes.
+ */
+typedef struct {
+    const uint8_t   *data;
+    uint16_t        len;
+}Urabros_TxSegmentTypeDef, *Urabros_TxSegmentPtrTypeDef;
+
+/**
+ * An enum for the streams sharing the UART, see at uLinkScheduler.h.
+ * The first ones are the lanes of the outgoing queue.
+ */
+typedef enum {
+    uLinkStream_Response    = uMsgOutPrio_Response, /**< Command responses and statuses.*/
+    uLinkStream_TaskData    = uMsgOutPrio_Bulk,     /**< Data from the tasks and the bulk transfers.*/
+    uLinkStream_Debug       = uMsgOutPrio_Count,    /**< Debug text or binary log.*/
+    uLinkStream_Count,                              /**< Number of streams, leave it as the last one.*/
+}Urabros_LinkStreamTypeDef;
+
+/** @struct Urabros_LinkStatsTypeDef
+ *  @brief Counters of one stream sharing the UART.
+ *
+ *  @var Urabros_LinkStatsTypeDef::bytes
+ *  Number of bytes sent out, with the frame bytes.
+ *
+ *  @var Urabros_LinkStatsTypeDef::frames
+ *  Number of frames sent out.
+ *
+ *  @var Urabros_LinkStatsTypeDef::drops
+ *  Number of messages dropped because the buffer of the stream was full.
+ */
+typedef struct {
+    uint32_t    bytes;
+    uint32_t    frames;
+    uint32_t    drops;
+}Urabros_LinkStatsTypeDef, *Urabros_LinkStatsPtrTypeDef;
+
 #endif /* URABROSTYPEDEF_H_ */
@@ -29,8 +29,8 @@
  * <b>Outgoing Message Handler</b>  
  * found at urabrosMessageSenderFunction() handles the outgoing messages.  
  * uMessages are the topp priority, if there are no more uMessage to be send than, it can send out ASCII debug messages if there are some in the buffer.  
- * <b>Update Task List</b>  
- * found at urabrosLogicControlFunction() it updates the statuses in the commandlist, depending on the acttive uTasks's statuses.
+ * <b>Task statuses</b>  
+ * Every uTask publishes its status in one status word (Urabros_TaskTypeDef::statusWord), the commandlist points to the uTasks so the statuses are read directly from there.
  * <hr>
  * @subsection step3 uTask
  * <img src="Urabros_uTask.png" align="left"><div style="clear: both"></div>
@@ -54,8 +54,8 @@
  * There are two important Arrays from the communication view.
  * One is shared between the PC and the MC we call it commandList. #uCommandList  
  * The other one is for collecting all the uTasks we call it TaskList. #uTasks  
- * The TaskList holds all the task pointers and it is refreshed by the urabrosLogicControlFunction().  
- * The commandList holds all actie tasks and it's statuses. The status is separated to two parts main: 3 bit and minor:5bit see at: #Urabros_CommandStatusTypeDef  
+ * The TaskList holds all the task pointers, it is filled at init.  
+ * The commandList holds all actie tasks, their statuses are in the status words of the tasks. The status is separated to two parts main: 3 bit and minor:5bit see at: Urabros_TaskTypeDef::statusWord  
  * The main status can be on;y predefined values with predefined meanings: #Urabros_TaskStatusTypeDef minor can be 0 - 31 and its meaning is different for each uTasks.
  * <hr>
  * @subsection step6 Master to Slave protocol
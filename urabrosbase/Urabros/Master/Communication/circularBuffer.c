@@ -8,135 +8,150 @@
   */
 
 #include "circularBuffer.h"
+#include "string.h"
 
-typedef enum {
-    READER_TO_WRITER,
-    WRITER_TO_READER,
-}pointerDistanceType;
+/* The data must be in the buffer before the other side sees the new index, and the other way around. */
+#define CIRC_BARRIER()  __sync_synchronize()
 
-typedef enum {
-    NOT_TURNED,
-    TURNED,
-}bufferTurnedType;
+// Private function
+static void copyIn(circularBufferPtr cBuff, uint16_t pos, const uint8_t *data, uint16_t len)
+{
+    uint16_t idx    = pos & cBuff->mask;
+    uint16_t first  = cBuff->mask + 1 - idx;
+
+    if(first > len) {
+        first = len;
+    }
+    memcpy(cBuff->buffer + idx, data, first);
+    memcpy(cBuff->buffer, data + first, len - first);
+}
 
 // Private function
-static uint16_t distancePointers(circularBufferPtr cBuff, pointerDistanceType distanceType, uint8_t *turned )
+static void copyOut(circularBufferPtr cBuff, uint16_t pos, uint8_t *data, uint16_t len)
 {
-    uint8_t *A;
-    uint8_t *B;
-
-    *turned = NOT_TURNED;
-
-    if(distanceType == READER_TO_WRITER) {
-        A = cBuff->reader;
-        B = cBuff->writer;
-        if(A == B) {
-            if(cBuff->isFull) {
-                if(A != cBuff->head) {
-                    *turned = TURNED;
-                }
-                return cBuff->bufferSize;
-            } else {
-                return 0;
-            }
-        }
-    } else if(distanceType == WRITER_TO_READER) {
-        A = cBuff->writer;
-        B = cBuff->reader;
-        if(A == B) {
-            if(A != cBuff->head) {
-                *turned = TURNED;
-            }
-            return cBuff->bufferSize;
-        }
+    uint16_t idx    = pos & cBuff->mask;
+    uint16_t first  = cBuff->mask + 1 - idx;
+
+    if(first > len) {
+        first = len;
     }
+    memcpy(data, cBuff->buffer + idx, first);
+    memcpy(data + first, cBuff->buffer, len - first);
+}
 
-    if (A < B) {
-        return B - A;
-    } else { // A > B
-        *turned = TURNED;
-        return (cBuff->tail - A) + (B - cBuff->head);
+uint8_t circularBufferInit(circularBufferPtr cBuff, uint8_t *buffer, uint16_t bufferSize)
+{
+    if(!bufferSize || (bufferSize & (bufferSize - 1)) || bufferSize > 0x8000) {
+        return 1;
     }
+
+    cBuff->buffer   = buffer;
+    cBuff->mask     = bufferSize - 1;
+    cBuff->writeIdx = 0;
+    cBuff->readIdx  = 0;
+    return 0;
 }
 
+uint16_t circularBufferUsed(circularBufferPtr cBuff)
+{
+    return (uint16_t)(cBuff->writeIdx - cBuff->readIdx);
+}
 
-void circularBufferInit(circularBufferPtr cBuff, uint8_t *buffer, uint16_t bufferSize)
+uint16_t circularBufferFree(circularBufferPtr cBuff)
 {
-    cBuff->bufferSize   = bufferSize;
-    cBuff->head         = buffer;
-    cBuff->tail         = buffer + (bufferSize - 1);
-    cBuff->reader       = buffer;
-    cBuff->writer       = buffer;
-    cBuff->isFull       = 0;
-
-    for(uint16_t i = 0; i < bufferSize; i++) {
-        buffer[i] = 0;
+    return cBuff->mask + 1 - circularBufferUsed(cBuff);
+}
+
+uint8_t circularBufferWrite(circularBufferPtr cBuff, const uint8_t *dataWrite, uint16_t dataWriteLen)
+{
+    if(dataWriteLen > circularBufferFree(cBuff)) {
+        return 1; // Not enough space to write
     }
+
+    copyIn(cBuff, cBuff->writeIdx, dataWrite, dataWriteLen);
+    circularBufferProduce(cBuff, dataWriteLen);
+    return 0;
 }
 
-uint8_t circularBufferWrite(circularBufferPtr cBuff, uint8_t *dataWrite, uint16_t dataWriteLen)
+void circularBufferCopyIn(circularBufferPtr cBuff, uint16_t offset, const uint8_t *dataWrite, uint16_t dataWriteLen)
 {
-    uint8_t turned;
-    uint16_t distance = distancePointers(cBuff, WRITER_TO_READER, &turned);
+    copyIn(cBuff, cBuff->writeIdx + offset, dataWrite, dataWriteLen);
+}
 
-    if(dataWriteLen > distance) {
-        return 1; // Not enough space to write
-    } else if(dataWriteLen == distance) {
-        cBuff->isFull = 1;
-    } else if(cBuff->isFull) {
-        return 2; // Buffer is full
+void circularBufferProduce(circularBufferPtr cBuff, uint16_t len)
+{
+    CIRC_BARRIER();
+    cBuff->writeIdx += len;
+}
+
+uint8_t circularBufferPeek(circularBufferPtr cBuff, uint16_t offset, uint8_t *dataRead, uint16_t dataReadLen)
+{
+    if(offset + dataReadLen > circularBufferUsed(cBuff)) {
+        return 1;
+    }
+
+    CIRC_BARRIER();
+    copyOut(cBuff, cBuff->readIdx + offset, dataRead, dataReadLen);
+    return 0;
+}
+
+uint16_t circularBufferPeekSpans(circularBufferPtr cBuff, circularBufferSpan spans[2])
+{
+    uint16_t used = circularBufferUsed(cBuff);
+
+    circularBufferPeekSpansAt(cBuff, 0, used, spans);
+    return used;
+}
+
+uint8_t circularBufferPeekSpansAt(circularBufferPtr cBuff, uint16_t offset, uint16_t len, circularBufferSpan spans[2])
+{
+    uint16_t idx    = (cBuff->readIdx + offset) & cBuff->mask;
+    uint16_t first  = cBuff->mask + 1 - idx;
+
+    if(offset + len > circularBufferUsed(cBuff)) {
+        return 1;
     }
 
-    for(uint16_t i = 0; i < dataWriteLen; i++) {
-        *(cBuff->writer) = *(dataWrite + i);
-        if(cBuff->writer == cBuff->tail)
-            cBuff->writer = cBuff->head;
-        else
-            cBuff->writer++;
+    CIRC_BARRIER();
+    if(first > len) {
+        first = len;
     }
 
+    spans[0].data   = cBuff->buffer + idx;
+    spans[0].len    = first;
+    spans[1].data   = cBuff->buffer;
+    spans[1].len    = len - first;
     return 0;
 }
 
+void circularBufferConsume(circularBufferPtr cBuff, uint16_t len)
+{
+    CIRC_BARRIER();
+    cBuff->readIdx += len;
+}
+
 uint8_t circularBufferRead(circularBufferPtr cBuff, uint8_t *dataRead, uint16_t *dataReadLen)
 {
-    uint16_t dataReadIndex = 0;
-    uint8_t turned = NOT_TURNED;
+    return circularBufferReadMax(cBuff, dataRead, cBuff->mask + 1, dataReadLen);
+}
 
-    *dataReadLen = distancePointers(cBuff, READER_TO_WRITER, &turned);
+uint8_t circularBufferReadMax(circularBufferPtr cBuff, uint8_t *dataRead, uint16_t maxLen, uint16_t *dataReadLen)
+{
+    uint16_t available = circularBufferUsed(cBuff);
 
-    if (!*dataReadLen && !cBuff->isFull) {
+    *dataReadLen = 0;
+    if (!available) {
         return 1; // Buffer is empty
     }
 
-    if(turned) {
-        uint16_t toTail = cBuff->tail - cBuff->reader + 1;
-        uint16_t fromHead = cBuff->writer - cBuff->head;
-
-        for(uint16_t i = 0; i < toTail; i++) {
-            *(dataRead + dataReadIndex) = *cBuff->reader;
-            *cBuff->reader = 0;
-            cBuff->reader++;
-            dataReadIndex++;
-        }
-        cBuff->reader = cBuff->head;
-
-        for(uint16_t i = 0; i < fromHead; i++) {
-            *(dataRead + dataReadIndex) = *cBuff->reader;
-            *cBuff->reader = 0;
-            cBuff->reader++;
-            dataReadIndex++;
-        }
-
-    } else { // Not turned
-        for(uint16_t i = 0; i < *dataReadLen; i++) {
-            *(dataRead + dataReadIndex) = *cBuff->reader;
-            *cBuff->reader = '\0';
-            cBuff->reader++;
-            dataReadIndex++;
-        }
+    if(available > maxLen) {
+        available = maxLen;
     }
 
-    cBuff->isFull = 0;
+    CIRC_BARRIER();
+    copyOut(cBuff, cBuff->readIdx, dataRead, available);
+    circularBufferConsume(cBuff, available);
+
+    *dataReadLen = available;
     return 0;
 }
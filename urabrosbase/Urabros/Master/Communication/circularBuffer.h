@@ -5,6 +5,17 @@
   *
   * @brief    A circular buffer for holding uint8_t datas.
   *           It is used with the uDebugPrint.h, but if any other project needs a circural buffer like this, it is free to use.
+  *
+  *           The size of the buffer must be a power of two, so the indexes are masked instead of compared.
+  *           The write and read indexes are free running, the writer changes only the write index and the reader
+  *           changes only the read index, so one writer and one reader can use it without lock.
+  *           Data is moved with memcpy in at most two pieces, and the read data is not cleared.
+  *
+  *           Reading without copy:
+  *           circularBufferSpan spans[2];
+  *           uint16_t len = circularBufferPeekSpans(&cBuff, spans); // The waiting data in one or two contiguous pieces
+  *           ... send spans[0] and spans[1] ...
+  *           circularBufferConsume(&cBuff, len);                   // Release the place for the writer
   */
 
 #ifndef MASTER_COMMUNICATION_CIRCULARBUFFER_H_
@@ -14,56 +25,141 @@
 
 /** @struct circularBuffer
  *  @brief A Circural buffer structure, holding all the necesary values.
- *  @var circularBuffer::head
+ *  @var circularBuffer::buffer
  *  Circ Buff array's first element's address
- *  @var circularBuffer::tail
- *  Circ Buff array's last element's address
- *  @var circularBuffer::reader
- *  The reader pointer
- *  @var circularBuffer::writer
- *  The writer pointer
- *  @var circularBuffer::bufferSize
- *  Size of the buffer
- *  @var circularBuffer::isFull
- *  Flag for indicate is buffer is foll of data or not.
+ *  @var circularBuffer::mask
+ *  Size of the buffer - 1
+ *  @var circularBuffer::writeIdx
+ *  Free running write index, only the writer changes it
+ *  @var circularBuffer::readIdx
+ *  Free running read index, only the reader changes it
  */
 typedef struct {
-    uint8_t *head;
-    uint8_t *tail;
-    uint8_t *reader;
-    uint8_t *writer;
-    uint16_t bufferSize;
-    uint8_t isFull;
+    uint8_t             *buffer;
+    uint16_t            mask;
+    volatile uint16_t   writeIdx;
+    volatile uint16_t   readIdx;
 }circularBuffer, *circularBufferPtr;
 
+/** @struct circularBufferSpan
+ *  @brief A contiguous piece of the data in the circular buffer.
+ *  @var circularBufferSpan::data
+ *  Address of the first byte
+ *  @var circularBufferSpan::len
+ *  Number of bytes, 0 if the piece is empty
+ */
+typedef struct {
+    uint8_t     *data;
+    uint16_t    len;
+}circularBufferSpan;
+
 /**
   * @brief   Creates the circural buffer.
   *          The array in the buffer is not dynamically allocated. so it has to passed by this function.
   * @param   cBuff - Pointer to a cirBuffer
   * @param   buffer - Pointer for the array what will be assigned to circuralBuffer
-  * @param   bufferSize - Size of the array.
+  * @param   bufferSize - Size of the array, it must be a power of two and maximum 32768.
+  * @return  0 - Init done\n
+  *          1 - The size is not a power of two.
+*/
+uint8_t circularBufferInit(circularBufferPtr cBuff, uint8_t *buffer, uint16_t bufferSize);
+
+/**
+  * @param   cBuff - Pointer to the circBuffer
+  * @return  Number of bytes waiting to be read.
+*/
+uint16_t circularBufferUsed(circularBufferPtr cBuff);
+
+/**
+  * @param   cBuff - Pointer to the circBuffer
+  * @return  Number of bytes what can be written.
 */
-void circularBufferInit(circularBufferPtr cBuff, uint8_t *buffer, uint16_t bufferSize);
+uint16_t circularBufferFree(circularBufferPtr cBuff);
 
 /**
-  * @brief  Writes data to the circbuffer.
-  * @param  cBuff - Pointer to the circBuffer 
+  * @brief  Writes data to the circbuffer, the data is written whole or not at all.
+  * @param  cBuff - Pointer to the circBuffer
   * @param  dataWrite - Ponter to the array where are the datas staying for be writen in to the circbuff
-  * @param  dataReadLen - Length of the data we want to write into the buffer.
+  * @param  dataWriteLen - Length of the data we want to write into the buffer.
   * @return 0 - if write is done\n
-  *         1 - There is not enough space in the buffer for #bufferSize of data.\n 
-  *         2 - If bufer is full, and data cant be writen in.
+  *         1 - There is not enough space in the buffer for the data.
+*/
+uint8_t circularBufferWrite(circularBufferPtr cBuff, const uint8_t *dataWrite, uint16_t dataWriteLen);
+
+/**
+  * @brief  Copies data after the written data, but the reader doesn't see it until @see circularBufferProduce() is called.
+  *         So a message can be assembled from more pieces. The caller has to check the free space before.
+  * @param  cBuff - Pointer to the circBuffer
+  * @param  offset - Distance from the write index.
+  * @param  dataWrite - Pointer to the data.
+  * @param  dataWriteLen - Length of the data.
 */
-uint8_t circularBufferWrite(circularBufferPtr cBuff, uint8_t *dataWrite, uint16_t dataReadLen);
+void circularBufferCopyIn(circularBufferPtr cBuff, uint16_t offset, const uint8_t *dataWrite, uint16_t dataWriteLen);
+
+/**
+  * @brief  Makes the data copied by @see circularBufferCopyIn() visible for the reader.
+  * @param  cBuff - Pointer to the circBuffer
+  * @param  len - Number of bytes to be published.
+*/
+void circularBufferProduce(circularBufferPtr cBuff, uint16_t len);
+
+/**
+  * @brief   Copies data from the buffer without removing it.
+  * @param   cBuff - Pointer to the circBuffer
+  * @param   offset - Distance from the read index.
+  * @param   dataRead - Pointer for the outgoing array.
+  * @param   dataReadLen - Number of bytes to copy.
+  * @return  0 - Copy done\n
+  *          1 - There is not so much data in the buffer.
+*/
+uint8_t circularBufferPeek(circularBufferPtr cBuff, uint16_t offset, uint8_t *dataRead, uint16_t dataReadLen);
+
+/**
+  * @brief   Gives back the waiting data in at most two contiguous pieces without copy.
+  *          The data stays in the buffer until @see circularBufferConsume() is called.
+  * @param   cBuff - Pointer to the circBuffer
+  * @param   spans - Array of two spans, loaded with the pieces. The second is empty if the data doesn't turn around.
+  * @return  Number of bytes in the two spans.
+*/
+uint16_t circularBufferPeekSpans(circularBufferPtr cBuff, circularBufferSpan spans[2]);
+
+/**
+  * @brief   Gives back a part of the waiting data in at most two contiguous pieces without copy.
+  * @param   cBuff - Pointer to the circBuffer
+  * @param   offset - Distance of the first byte from the read index.
+  * @param   len - Number of bytes.
+  * @param   spans - Array of two spans, loaded with the pieces. The second is empty if the part doesn't turn around.
+  * @return  0 - Done\n
+  *          1 - There is not so much data in the buffer.
+*/
+uint8_t circularBufferPeekSpansAt(circularBufferPtr cBuff, uint16_t offset, uint16_t len, circularBufferSpan spans[2]);
+
+/**
+  * @brief   Removes data from the buffer, the place can be written again.
+  * @param   cBuff - Pointer to the circBuffer
+  * @param   len - Number of bytes to remove, it can't be more than @see circularBufferUsed().
+*/
+void circularBufferConsume(circularBufferPtr cBuff, uint16_t len);
 
 /**
   * @brief   Reads all the data stored in the circular buffer.
-  * @param   cBuff - Pointer to the circBuffer 
+  * @param   cBuff - Pointer to the circBuffer
+  * @param   dataRead - Pointer for the outgoing array, this function fills this array with the readed values.
+  * @param   dataReadLen - Pointer for a variable, this will be loaded with the value of how many datas were readed by this function.
+  * @return  0 - Read done\n
+  *          1 - Buffer is empty, cant read.
+*/
+uint8_t circularBufferRead(circularBufferPtr cBuff, uint8_t *dataRead, uint16_t *dataReadLen);
+
+/**
+  * @brief   Reads the oldest datas stored in the circular buffer, but at most maxLen of them.
+  * @param   cBuff - Pointer to the circBuffer
   * @param   dataRead - Pointer for the outgoing array, this function fills this array with the readed values.
+  * @param   maxLen - The size of the outgoing array.
   * @param   dataReadLen - Pointer for a variable, this will be loaded with the value of how many datas were readed by this function.
   * @return  0 - Read done\n
-  *          1 - Buffer is empty, cant read. 
+  *          1 - Buffer is empty, cant read.
 */
-uint8_t circularBufferRead( circularBufferPtr cBuff, uint8_t *dataRead, uint16_t *dataReadLen);
+uint8_t circularBufferReadMax(circularBufferPtr cBuff, uint8_t *dataRead, uint16_t maxLen, uint16_t *dataReadLen);
 
 #endif /* MASTER_COMMUNICATION_CIRCULARBUFFER_H_ */
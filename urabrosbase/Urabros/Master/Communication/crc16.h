@@ -13,6 +13,7 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include "UrabrosConfig.h"
 
 /**
  * #define CRC_POLY_xxxx
@@ -38,4 +39,61 @@
 */
 uint16_t crc_modbus(const unsigned char *input_str, size_t num_bytes);
 
+/**
+  * @brief  Continues a CRC16 MODBUS calculation with the next part of the data, so the CRC can be calculated while the data is assembled.
+  *         crc16_update(crc16_update(CRC_START_MODBUS, a, n), b, m) is equal with the crc_modbus() of a and b after each other.
+  * @param   crc - The CRC of the previous parts, or #CRC_START_MODBUS at the beginning
+  * @param   input_str - Pointer to the next part of the data
+  * @param   num_bytes - Size of the next part
+  * @return calculated Crc16 modbus value
+*/
+uint16_t crc16_update(uint16_t crc, const unsigned char *input_str, size_t num_bytes);
+
+/**
+  * @brief  Continues a CRC16 MODBUS calculation with one byte.
+  * @param   crc - The CRC of the previous bytes
+  * @param   c - The next byte
+  * @return calculated Crc16 modbus value
+*/
+uint16_t update_crc_16(uint16_t crc, unsigned char c);
+
+/**
+  * @brief  Prepares the selected CRC backend, with #CRC_BACKEND_HARDWARE it enables the clock of the CRC peripheral
+  *         and creates the mutex of it.
+  *         It has to be called before the first CRC calculation.
+*/
+void crc16_init(void);
+
+#if CRC_BENCHMARK_ENABLE
+/** @struct crc16_benchmark_t
+ *  @brief Result of the @see crc16_benchmark() function.
+ *  @var crc16_benchmark_t::bytes
+ *  Number of bytes processed by each backend
+ *  @var crc16_benchmark_t::us_bytewise
+ *  Time in microseconds of the one byte per loop table kernel
+ *  @var crc16_benchmark_t::us_slice4
+ *  Time in microseconds of the slice-by-4 kernel
+ *  @var crc16_benchmark_t::us_hardware
+ *  Time in microseconds of the CRC peripheral
+ *  @var crc16_benchmark_t::crc_bytewise
+ *  Result of the kernels, all the three has to be equal
+ */
+typedef struct {
+    uint32_t bytes;
+    uint32_t us_bytewise;
+    uint32_t us_slice4;
+    uint32_t us_hardware;
+    uint16_t crc_bytewise;
+    uint16_t crc_slice4;
+    uint16_t crc_hardware;
+}crc16_benchmark_t;
+
+/**
+  * @brief  Measures the throughput of all the CRC backends on the same data.
+  *         It has to be called from a thread, after the @see crc16_init().
+  * @param   result - Pointer to the variable to be loaded with the results.
+*/
+void crc16_benchmark(crc16_benchmark_t *result);
+#endif
+
 #endif // CRC16_H_INCLUDED
@@ -0,0 +1,435 @@
+/**
+ * @file     uBulkTransfer.c
+ * @author   Marton.Lorinczi
+ * @date     Oct 17, 2026
+ *
+ * @brief  BulkTransfer moves data bigger than #MESSAGE_BUFFER_LENGTH between the PC and an uTask.
+ *         Further informations in the header file.
+ */
+#include "uBulkTransfer.h"
+#include "uMessageCommon.h"
+#include "UrabrosStatic.h"
+#include "uOutgoingMessageHandler.h"
+#include "string.h"
+
+#define DPRINT_LOCAL_ENABLE 1
+#include "uDebugPrint.h"
+
+#if BULK_WINDOW_SIZE >= MESSAGE_IN_ARRAY_LENGTH
+    #error "BULK_WINDOW_SIZE must be smaller than MESSAGE_IN_ARRAY_LENGTH, the window and one more message have to fit in the incoming buffer"
+#endif
+
+/** States of a bulk session.
+ */
+typedef enum {
+    uBulkSessionFree        = 0, /**< The session is not used.*/
+    uBulkSessionWaitOpen    = 1, /**< An uTask waits for a transfer from the PC.*/
+    uBulkSessionReceiving   = 2, /**< The PC is sending the fragments.*/
+    uBulkSessionSending     = 3, /**< The uTask is sending the fragments.*/
+    uBulkSessionDone        = 4, /**< All the fragments arrived.*/
+    uBulkSessionAborted     = 5, /**< The other side aborted the transfer.*/
+}Urabros_BulkSessionStateTypeDef;
+
+/** @struct Urabros_BulkSessionTypeDef
+ *  @brief Holds the state of one bulk transfer.
+ *  @var Urabros_BulkSessionTypeDef::state
+ *  State of the session
+ *  @var Urabros_BulkSessionTypeDef::taskId
+ *  Id of the uTask owning the session
+ *  @var Urabros_BulkSessionTypeDef::rxBuff
+ *  Buffer of the uTask where the received fragments are copied
+ *  @var Urabros_BulkSessionTypeDef::txBuff
+ *  Data of the uTask to be sent
+ *  @var Urabros_BulkSessionTypeDef::maxLen
+ *  Size of the receive buffer
+ *  @var Urabros_BulkSessionTypeDef::total
+ *  Length of the transferred data
+ *  @var Urabros_BulkSessionTypeDef::fragCount
+ *  Number of fragments of the transfer
+ *  @var Urabros_BulkSessionTypeDef::nextSeq
+ *  Receiving: the next expected fragment. Sending: the first not acknowledged fragment.
+ *  @var Urabros_BulkSessionTypeDef::semaphore
+ *  Wakes up the uTask on progress
+ */
+typedef struct {
+    Urabros_BulkSessionStateTypeDef state;
+    uint8_t                         taskId;
+    uint8_t                         *rxBuff;
+    const uint8_t                   *txBuff;
+    uint32_t                        maxLen;
+    uint32_t                        total;
+    uint16_t                        fragCount;
+    uint16_t                        nextSeq;
+    SemaphoreHandle_t               semaphore;
+}Urabros_BulkSessionTypeDef, *Urabros_BulkSessionPtrTypeDef;
+
+static Urabros_BulkSessionTypeDef   uBulkSessions[BULK_SESSION_NUM];    /**< The bulk sessions.*/
+static SemaphoreHandle_t            uBulkMutex;                         /**< Protects the sessions, they are used by the master and the uTasks.*/
+#if URABROS_STATIC_ALLOCATION
+static StaticSemaphore_t            uBulkSemaphoreBuffer[BULK_SESSION_NUM]; /**< Storage of the semaphores of the sessions.*/
+#endif
+
+/** Gives back the session of the uTask, it must be called with taken mutex.
+ *  @param taskId Id of the uTask
+ *  @return Pointer to the session or NULL if the uTask has no active session.
+ */
+static Urabros_BulkSessionPtrTypeDef uBulkFindSession(uint8_t taskId)
+{
+    for(uint8_t idx = 0; idx < BULK_SESSION_NUM; idx++) {
+        if(uBulkSessions[idx].state != uBulkSessionFree && uBulkSessions[idx].taskId == taskId) {
+            return uBulkSessions + idx;
+        }
+    }
+    return NULL;
+}
+
+/** Reserves a session for the uTask, it must be called with taken mutex.
+ *  @param taskId Id of the uTask
+ *  @return Pointer to the session or NULL if the uTask already has one, or there is no free session.
+ */
+static Urabros_BulkSessionPtrTypeDef uBulkAllocSession(uint8_t taskId)
+{
+    if(uBulkFindSession(taskId) != NULL) {
+        return NULL;
+    }
+
+    for(uint8_t idx = 0; idx < BULK_SESSION_NUM; idx++) {
+        if(uBulkSessions[idx].state == uBulkSessionFree) {
+            uBulkSessions[idx].taskId   = taskId;
+            uBulkSessions[idx].nextSeq  = 0;
+            // Drop a give left from an earlier transfer.
+            xSemaphoreTake(uBulkSessions[idx].semaphore, 0);
+            return uBulkSessions + idx;
+        }
+    }
+    return NULL;
+}
+
+/** Calculates the number of fragments of the given length.
+ */
+static uint16_t uBulkFragCount(uint32_t len)
+{
+    return (uint16_t)((len + BULK_FRAGMENT_SIZE - 1) / BULK_FRAGMENT_SIZE);
+}
+
+/** Starts a bulk message: | 0x08 | op | taskId |
+ */
+static void uBulkMsgStart(Urabros_MsgPtr uMsgPtr, Urabros_BulkOpTypeDef op, uint8_t taskId)
+{
+    uMsgReset(uMsgPtr);
+    uMsgAppend(uMsgPtr, uCommand_BULK);
+    uMsgAppend(uMsgPtr, op);
+    uMsgAppend(uMsgPtr, taskId);
+}
+
+/** Appends a big endian uint16_t to the message.
+ */
+static void uBulkAppend16(Urabros_MsgPtr uMsgPtr, uint16_t value)
+{
+    uMsgAppend(uMsgPtr, value >> 8);
+    uMsgAppend(uMsgPtr, value);
+}
+
+/** Appends a big endian uint32_t to the message.
+ */
+static void uBulkAppend32(Urabros_MsgPtr uMsgPtr, uint32_t value)
+{
+    uBulkAppend16(uMsgPtr, value >> 16);
+    uBulkAppend16(uMsgPtr, value);
+}
+
+/** Sends an ABORT message to the PC from an uTask.
+ */
+static void uBulkSendAbort(uint8_t taskId, Urabros_BulkStatusTypeDef reason)
+{
+    Urabros_Msg uMsg;
+
+    uBulkMsgStart(&uMsg, uBulkOp_ABORT, taskId);
+    uMsgAppend(&uMsg, reason);
+    uMsgSetCrc(&uMsg);
+    uMsgOutPut(&uMsg);
+}
+
+Urabros_StatusTypeDef uBulkInit(void)
+{
+    uBulkMutex = uMutexCreate();
+    for(uint8_t idx = 0; idx < BULK_SESSION_NUM; idx++) {
+        uBulkSessions[idx].state        = uBulkSessionFree;
+        uBulkSessions[idx].semaphore    = uBinarySemaphoreCreateAt(&uBulkSemaphoreBuffer[idx]);
+    }
+    return uStatusOk;
+}
+
+uint8_t uBulkProcess(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr)
+{
+    Urabros_BulkSessionPtrTypeDef   session;
+    Urabros_BulkStatusTypeDef       status;
+    uint8_t                         taskId;
+    uint8_t                         respond = 0;
+    uint16_t                        seq;
+    uint32_t                        offset;
+    uint32_t                        fragLen;
+    uint32_t                        payloadLen;
+
+    uMsgReset(uTxPtr);
+
+    if(uRxPtr->dataLen < 3) {
+        return 0;
+    }
+    taskId = uRxPtr->data[2];
+
+    xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+    session = uBulkFindSession(taskId);
+
+    switch(uRxPtr->data[1]) {
+
+        case uBulkOp_OPEN :
+            if(uRxPtr->dataLen < 7) {
+                break;
+            }
+
+            if(session == NULL || session->state != uBulkSessionWaitOpen) {
+                status = (session == NULL) ? uBulkNoReceiver : uBulkBusy;
+            } else {
+                session->total = ((uint32_t)uRxPtr->data[3] << 24) | ((uint32_t)uRxPtr->data[4] << 16) |
+                                 ((uint32_t)uRxPtr->data[5] << 8)  | uRxPtr->data[6];
+                if(session->total > session->maxLen) {
+                    status = uBulkTooBig;
+                } else {
+                    status              = uBulkOk;
+                    session->fragCount  = uBulkFragCount(session->total);
+                    session->nextSeq    = 0;
+                    session->state      = uBulkSessionReceiving;
+                    if(!session->fragCount) {
+                        session->state  = uBulkSessionDone;
+                        xSemaphoreGive(session->semaphore);
+                    }
+                }
+            }
+
+            uBulkMsgStart(uTxPtr, uBulkOp_OPEN, taskId);
+            uMsgAppend(uTxPtr, status);
+            uMsgAppend(uTxPtr, BULK_WINDOW_SIZE);
+            uMsgAppend(uTxPtr, BULK_FRAGMENT_SIZE);
+            respond = 1;
+            break;
+
+        case uBulkOp_DATA :
+            if(uRxPtr->dataLen < BULK_HEADER_SIZE) {
+                break;
+            }
+            payloadLen = (uint32_t)uRxPtr->dataLen - BULK_HEADER_SIZE;
+
+            if(session == NULL || (session->state != uBulkSessionReceiving && session->state != uBulkSessionDone)) {
+                uBulkMsgStart(uTxPtr, uBulkOp_ABORT, taskId);
+                uMsgAppend(uTxPtr, uBulkNoReceiver);
+                respond = 1;
+                break;
+            }
+
+            seq = ((uint16_t)uRxPtr->data[3] << 8) | uRxPtr->data[4];
+            if(seq == session->nextSeq && session->state == uBulkSessionReceiving) {
+                offset  = (uint32_t)seq * BULK_FRAGMENT_SIZE;
+                fragLen = session->total - offset;
+                if(fragLen > BULK_FRAGMENT_SIZE) {
+                    fragLen = BULK_FRAGMENT_SIZE;
+                }
+
+                if(payloadLen == fragLen) {
+                    // Reassemble directly in the buffer of the uTask.
+                    memcpy(session->rxBuff + offset, uRxPtr->data + BULK_HEADER_SIZE, fragLen);
+                    session->nextSeq++;
+
+                    if(session->nextSeq == session->fragCount) {
+                        session->state = uBulkSessionDone;
+                        xSemaphoreGive(session->semaphore);
+                        respond = 1;
+                    } else if(!(session->nextSeq % BULK_ACK_EVERY)) {
+                        respond = 1;
+                    }
+                } else {
+                    respond = 1;
+                }
+            } else {
+                // Repeated or out of order fragment, tell the sender where to go back.
+                respond = 1;
+            }
+
+            if(respond) {
+                uBulkMsgStart(uTxPtr, uBulkOp_ACK, taskId);
+                uBulkAppend16(uTxPtr, session->nextSeq);
+            }
+            break;
+
+        case uBulkOp_ACK :
+            if(uRxPtr->dataLen < BULK_HEADER_SIZE || session == NULL || session->state != uBulkSessionSending) {
+                break;
+            }
+
+            seq = ((uint16_t)uRxPtr->data[3] << 8) | uRxPtr->data[4];
+            if(seq > session->nextSeq && seq <= session->fragCount) {
+                session->nextSeq = seq;
+                xSemaphoreGive(session->semaphore);
+            }
+            break;
+
+        case uBulkOp_ABORT :
+            if(session != NULL && session->state != uBulkSessionDone) {
+                session->state = uBulkSessionAborted;
+                xSemaphoreGive(session->semaphore);
+            }
+            break;
+
+        default :
+            break;
+    }
+
+    xSemaphoreGive(uBulkMutex);
+    return respond;
+}
+
+Urabros_BulkStatusTypeDef uBulkReceive(Urabros_TaskPtrTypeDef uTaskPtr, uint8_t *buff, uint32_t maxLen, uint32_t *receivedLen, TickType_t timeout)
+{
+    Urabros_BulkSessionPtrTypeDef   session;
+    Urabros_BulkStatusTypeDef       status;
+    uint8_t                         taskId = uTaskPtr->responsibleTaskId;
+
+    *receivedLen = 0;
+
+    xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+    session = uBulkAllocSession(taskId);
+    if(session == NULL) {
+        xSemaphoreGive(uBulkMutex);
+        return uBulkBusy;
+    }
+    session->rxBuff = buff;
+    session->maxLen = maxLen;
+    session->state  = uBulkSessionWaitOpen;
+    xSemaphoreGive(uBulkMutex);
+
+    xSemaphoreTake(session->semaphore, timeout);
+
+    xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+    switch(session->state) {
+        case uBulkSessionDone :
+            *receivedLen    = session->total;
+            status          = uBulkOk;
+            break;
+        case uBulkSessionAborted :
+            status          = uBulkAborted;
+            break;
+        case uBulkSessionReceiving :
+            uBulkSendAbort(taskId, uBulkTimeout);
+            status          = uBulkTimeout;
+            break;
+        default :
+            status          = uBulkTimeout;
+            break;
+    }
+    session->state = uBulkSessionFree;
+    xSemaphoreGive(uBulkMutex);
+
+    return status;
+}
+
+Urabros_BulkStatusTypeDef uBulkSend(Urabros_TaskPtrTypeDef uTaskPtr, const uint8_t *buff, uint32_t len)
+{
+    Urabros_BulkSessionPtrTypeDef   session;
+    Urabros_BulkSessionStateTypeDef state;
+    Urabros_Msg                     uMsg;
+    uint8_t                         taskId  = uTaskPtr->responsibleTaskId;
+    uint16_t                        base    = 0;
+    uint16_t                        lastBase= 0;
+    uint16_t                        next    = 0;
+    uint8_t                         retries = 0;
+    uint32_t                        offset;
+    uint32_t                        fragLen;
+
+    xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+    session = uBulkAllocSession(taskId);
+    if(session == NULL) {
+        xSemaphoreGive(uBulkMutex);
+        return uBulkBusy;
+    }
+    session->txBuff     = buff;
+    session->total      = len;
+    session->fragCount  = uBulkFragCount(len);
+    session->state      = uBulkSessionSending;
+    xSemaphoreGive(uBulkMutex);
+
+    // Tell the PC what is coming.
+    uBulkMsgStart(&uMsg, uBulkOp_OPEN, taskId);
+    uBulkAppend32(&uMsg, len);
+    uMsgAppend(&uMsg, BULK_WINDOW_SIZE);
+    uMsgAppend(&uMsg, BULK_FRAGMENT_SIZE);
+    uMsgSetCrc(&uMsg);
+    uMsgOutPutPriority(&uMsg, uMsgOutPrio_Bulk, portMAX_DELAY);
+
+    for(;;) {
+        xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+        base    = session->nextSeq;
+        state   = session->state;
+        xSemaphoreGive(uBulkMutex);
+
+        if(state == uBulkSessionAborted || base >= session->fragCount) {
+            break;
+        }
+
+        if(base != lastBase) {
+            lastBase    = base;
+            retries     = 0;
+        }
+        if(next < base) {
+            next = base;
+        }
+
+        // Fill the window.
+        while(next < session->fragCount && next < base + BULK_WINDOW_SIZE) {
+            offset  = (uint32_t)next * BULK_FRAGMENT_SIZE;
+            fragLen = len - offset;
+            if(fragLen > BULK_FRAGMENT_SIZE) {
+                fragLen = BULK_FRAGMENT_SIZE;
+            }
+
+            uBulkMsgStart(&uMsg, uBulkOp_DATA, taskId);
+            uBulkAppend16(&uMsg, next);
+            uMsgAppendBuffer(&uMsg, (uint8_t*)buff + offset, fragLen);
+            uMsgSetCrc(&uMsg);
+            if(uMsgOutPutPriority(&uMsg, uMsgOutPrio_Bulk, pdMS_TO_TICKS(BULK_RETRY_TIMEOUT)) != uMsg_Ok) {
+                break;
+            }
+            next++;
+        }
+
+        // Wait for an ACK, if nothing comes go back to the first not acknowledged fragment.
+        if(xSemaphoreTake(session->semaphore, pdMS_TO_TICKS(BULK_RETRY_TIMEOUT)) != pdTRUE) {
+            retries++;
+            if(retries > BULK_MAX_RETRIES) {
+                break;
+            }
+            next = base;
+            dprintln("Bulk retry: %d seq: %d", retries, base);
+        }
+    }
+
+    xSemaphoreTake(uBulkMutex, portMAX_DELAY);
+    if(session->state == uBulkSessionAborted) {
+        state = uBulkSessionAborted;
+    } else if(session->nextSeq >= session->fragCount) {
+        state = uBulkSessionDone;
+    } else {
+        state = uBulkSessionSending;
+    }
+    session->state = uBulkSessionFree;
+    xSemaphoreGive(uBulkMutex);
+
+    switch(state) {
+        case uBulkSessionDone :
+            return uBulkOk;
+        case uBulkSessionAborted :
+            return uBulkAborted;
+        default :
+            uBulkSendAbort(taskId, uBulkTimeout);
+            return uBulkTimeout;
+    }
+}
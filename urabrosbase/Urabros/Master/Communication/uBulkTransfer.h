@@ -0,0 +1,81 @@
+/**
+  * @file     uBulkTransfer.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  BulkTransfer moves data bigger than #MESSAGE_BUFFER_LENGTH between the PC and an uTask.
+  *
+  *         The data is cut to fragments, every fragment is one #uCommand_BULK message with a sequence number.
+  *         The sender can have #BULK_WINDOW_SIZE not acknowledged fragments on the line, the receiver acknowledges
+  *         cumulatively, so the sender doesn't have to wait for a round trip after every fragment (Go-Back-N).
+  *         The receiver takes only the next expected fragment, and copies it directly to the buffer of the uTask.
+  *         If a fragment is lost, the receiver repeats the ACK of the last good one, and the sender goes back to it.
+  *
+  *         Message layouts, all numbers are big endian:
+  *         | 0x08 | OPEN  | taskId | total 4 byte |                                          PC -> MCU
+  *         | 0x08 | OPEN  | taskId | status | window | fragment size |                       MCU -> PC answer
+  *         | 0x08 | OPEN  | taskId | total 4 byte | window | fragment size |                 MCU -> PC
+  *         | 0x08 | DATA  | taskId | seq 2 byte | data... |                                  both directions
+  *         | 0x08 | ACK   | taskId | next expected seq 2 byte |                              both directions
+  *         | 0x08 | ABORT | taskId | reason |                                               both directions
+  *         The offset of a fragment in the data is seq * #BULK_FRAGMENT_SIZE.
+  *
+  *         Usage in an uTask:
+  *         uint8_t table[2048];
+  *         uint32_t len;
+  *         if(uBulkReceive(&Task, table, sizeof(table), &len, portMAX_DELAY) == uBulkOk) {...}   // PC -> Task
+  *         uBulkSend(&Task, table, len);                                                       // Task -> PC
+  *
+  *         Only the UrabrosMaster.c is allowed to call the @see uBulkProcess() function.
+  */
+
+#ifndef MASTER_COMMUNICATION_UBULKTRANSFER_H_
+#define MASTER_COMMUNICATION_UBULKTRANSFER_H_
+
+#include "UrabrosTypeDef.h"
+
+/** Size of the bulk header: | 0x08 | op | taskId | seq 2 byte |
+ */
+#define BULK_HEADER_SIZE    5
+
+/** Maximal data bytes in one fragment, it fits in an #Urabros_Msg with the header.
+ */
+#define BULK_FRAGMENT_SIZE  (MESSAGE_BUFFER_LENGTH - BULK_HEADER_SIZE - 1)
+
+/** Initialize the bulk sessions and their semaphores.
+ *  @return #uStatusOk
+ */
+Urabros_StatusTypeDef uBulkInit(void);
+
+/** Processes an incoming #uCommand_BULK message, and builds the answer if it is needed.
+ *  @param uRxPtr The incoming message.
+ *  @param uTxPtr The answer, it is reset by the function.
+ *  @return 1 if the uTxPtr has to be sent out, 0 if there is no answer.
+ */
+uint8_t uBulkProcess(Urabros_MsgPtr uRxPtr, Urabros_MsgPtr uTxPtr);
+
+/** Receives a bulk transfer from the PC directly to the given buffer. It blocks until the transfer is finished.
+ *  @param uTaskPtr Pointer of the caller uTask, always use: &Task here.
+ *  @param buff The buffer where the data is assembled.
+ *  @param maxLen Size of the buffer, the PC gets #uBulkTooBig if the data is longer.
+ *  @param receivedLen Loaded with the number of received bytes.
+ *  @param timeout How many ticks to wait for the whole transfer.
+ *  @return #uBulkOk if the transfer finished\n
+ *          #uBulkBusy if there is no free session\n
+ *          #uBulkAborted if the PC aborted the transfer\n
+ *          #uBulkTimeout if the transfer didn't finish in time.
+ */
+Urabros_BulkStatusTypeDef uBulkReceive(Urabros_TaskPtrTypeDef uTaskPtr, uint8_t *buff, uint32_t maxLen, uint32_t *receivedLen, TickType_t timeout);
+
+/** Sends the given buffer to the PC with a bulk transfer. It blocks until all the fragments are acknowledged.
+ *  @param uTaskPtr Pointer of the caller uTask, always use: &Task here.
+ *  @param buff The data to be sent.
+ *  @param len Length of the data.
+ *  @return #uBulkOk if the PC acknowledged all the data\n
+ *          #uBulkBusy if there is no free session\n
+ *          #uBulkAborted if the PC aborted the transfer\n
+ *          #uBulkTimeout if there was no progress after #BULK_MAX_RETRIES retries.
+ */
+Urabros_BulkStatusTypeDef uBulkSend(Urabros_TaskPtrTypeDef uTaskPtr, const uint8_t *buff, uint32_t len);
+
+#endif /* MASTER_COMMUNICATION_UBULKTRANSFER_H_ */
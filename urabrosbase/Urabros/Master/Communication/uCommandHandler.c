@@ -7,6 +7,8 @@
 */
 
 #include "uCommandHandler.h"
+#include "UrabrosStatic.h"
+#include "string.h"
 
 #define DPRINT_LOCAL_ENABLE 1
 #include "uDebugPrint.h"
@@ -16,18 +18,30 @@ SemaphoreHandle_t        uCommandListMutex;
 uint8_t                  uCommandListStatusBuffer[TASK_COUNT * 2];
 uint8_t                  uCommandNumber;
 
+#define COMMAND_INDEX_NONE  0xFF    /**< The ID is not on the command list, #TASK_COUNT is at most 255 so it is never a valid index*/
 
+#if TASK_COUNT > 255
+    #error "TASK_COUNT can't be more than 255, the IDs are 8 bit long and 0 is TASK_ID_NONE"
+#endif
+
+static uint8_t uCommandIndex[256];  /**< Index of the command in the #uCommandList by ID, #COMMAND_INDEX_NONE if it is not on the list*/
+
+/** Checks if the command can be added to the list. It must be called with taken #uCommandListMutex.
+ *  @param commandPtr The command to be added.
+ *  @return #uCommandOk or the reason why it can't be added.
+ */
 static Urabros_CommandReturnStatus uCommandCheck(Urabros_CommandPtrTypedef commandPtr);
 
 Urabros_StatusTypeDef uCommandHandlerInit(void)
 {
     // Define global variables
-    uCommandListMutex = xSemaphoreCreateMutex();
+    uCommandListMutex = uMutexCreate();
 
     // Clear command list
     for(uint16_t i = 0; i < TASK_COUNT; i++) {
         uCommandClear(uCommandList + i);
     }
+    memset(uCommandIndex, COMMAND_INDEX_NONE, sizeof(uCommandIndex));
 
     uCommandNumber = 0;
 
@@ -36,150 +50,124 @@ Urabros_StatusTypeDef uCommandHandlerInit(void)
 
 Urabros_CommandReturnStatus uCommandAppend(Urabros_CommandPtrTypedef commandPtr)
 {
-    Urabros_CommandReturnStatus retStat = uCommandCheck(commandPtr);
-
-    // If there was a problem return with status
-    if(retStat != uCommandOk) {
-        return retStat;
-    }
-
-    if(uCommandNumber >= TASK_COUNT) {
-        return uCommandOwerFlow;
-    }
+    Urabros_CommandReturnStatus retStat;
 
-    if(commandPtr->id > TASK_ID_LAST && commandPtr->id != TASK_ID_TEST) {
-        return uCommandIdOutOfRange;
+    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) != pdTRUE) {
+        return uCommandTimedOut;
     }
 
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
+    // The check and the insert are under the same lock, so the same ID can't be added twice.
+    retStat = uCommandCheck(commandPtr);
+    if(retStat == uCommandOk) {
         uCommandList[uCommandNumber].id             = commandPtr->id;
-        uCommandList[uCommandNumber].status.main    = 0x00;
-        uCommandList[uCommandNumber].status.minor   = 0x00;
-        xSemaphoreGive(uCommandListMutex);
+        uCommandList[uCommandNumber].task           = commandPtr->task;
+        uCommandIndex[commandPtr->id]               = uCommandNumber;
         uCommandNumber++;
-        return uCommandAdded;
-    } else {
-        return uCommandTimedOut;
+        retStat = uCommandAdded;
     }
+    xSemaphoreGive(uCommandListMutex);
+    return retStat;
 }
 
-Urabros_CommandReturnStatus uCommandCheck(Urabros_CommandPtrTypedef commandPtr)
+static Urabros_CommandReturnStatus uCommandCheck(Urabros_CommandPtrTypedef commandPtr)
 {
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
+    if(uCommandIndex[commandPtr->id] != COMMAND_INDEX_NONE) {
+        return uCommandIdAlreadyUsed;
+    }
 
-        uint8_t idAlreadyExists  = 0;
-        for(uint16_t i = 0; i < uCommandNumber; i++) {
-           if(uCommandList[i].id == commandPtr->id) {
-               idAlreadyExists = 1;
-               break;
-           }
-        }
-        xSemaphoreGive(uCommandListMutex);
-        if(idAlreadyExists)
-           return uCommandIdAlreadyUsed;
-        else
-           return uCommandOk;
-   } else {
-       return uCommandTimedOut;
-   }
+    if(uCommandNumber >= TASK_COUNT) {
+        return uCommandOwerFlow;
+    }
+
+    if(commandPtr->id > TASK_ID_LAST && commandPtr->id != TASK_ID_TEST) {
+        return uCommandIdOutOfRange;
+    }
+    return uCommandOk;
 }
 
 Urabros_CommandReturnStatus uCommandRemoveById(Urabros_CommandIdTypedef commandId)
 {
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
-        uint8_t foundStatus = 0;
-        for(uint8_t i = 0; i < uCommandNumber; i++) {
-            if(uCommandList[i].id == commandId) {
-                if(uCommandList[i].status.main != uTaskStatusWaitingForACKSignal) {
-                    foundStatus = 1;
-                    break;
-                }
-                foundStatus = 2;
-                // If it is the last of the array than resetit.
-                if(i == TASK_COUNT -1) {
-                    uCommandClear(uCommandList + i);
-                } else {
-                    for(uint8_t j = i; j <= uCommandNumber; j++) {
-                        uCommandList[j].id              = uCommandList[j+1].id;
-                        uCommandList[j].status.main     = uCommandList[j+1].status.main;
-                        uCommandList[j].status.minor    = uCommandList[j+1].status.minor;
-                    }
-                }
-                uCommandNumber--;
-            }
-        }
-        xSemaphoreGive(uCommandListMutex);
+    Urabros_CommandReturnStatus retStat = uCommandDeleted;
+    uint8_t                     cmdIdx;
+    uint8_t                     lastIdx;
 
-        if(foundStatus == 0)
-            return uCommandNotFound;
-        else if(foundStatus == 1)
-            return uCommandNotFinished;
-        else if(foundStatus == 2)
-            return uCommandDeleted;
-    } else {
+    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) != pdTRUE) {
         return uCommandTimedOut;
     }
+
+    cmdIdx = uCommandIndex[commandId];
+    if(cmdIdx == COMMAND_INDEX_NONE) {
+        retStat = uCommandNotFound;
+    } else if(uCommandList[cmdIdx].task != NULL && URABROS_STATUS_MAIN(uCommandList[cmdIdx].task->statusWord) != uTaskStatusWaitingForACKSignal) {
+        retStat = uCommandNotFinished;
+    } else {
+        // The last command moves to the place of the removed one, so nothing has to be shifted.
+        lastIdx = uCommandNumber - 1;
+        if(cmdIdx != lastIdx) {
+            uCommandList[cmdIdx]                        = uCommandList[lastIdx];
+            uCommandIndex[uCommandList[cmdIdx].id]      = cmdIdx;
+        }
+        uCommandClear(uCommandList + lastIdx);
+        uCommandIndex[commandId] = COMMAND_INDEX_NONE;
+        uCommandNumber--;
+    }
+
+    xSemaphoreGive(uCommandListMutex);
+    return retStat;
 }
 
 Urabros_CommandReturnStatus uCommandGetIndexById(Urabros_CommandIdTypedef commandId, uint8_t *cmdIndex)
 {
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
-        uint8_t foundIt = 0;
-        for(uint8_t i = 0; i < uCommandNumber; i++) {
-            if(uCommandList[i].id == commandId) {
-                foundIt = 1;
-                *cmdIndex = i;
-                break;
-            }
-        }
-        xSemaphoreGive(uCommandListMutex);
-        if(foundIt) {
+    uint8_t foundIdx;
 
-            return uCommandOk;
-        } else {
-            return uCommandNotFound;
-        }
-    } else {
+    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) != pdTRUE) {
         return uCommandTimedOut;
     }
+    foundIdx = uCommandIndex[commandId];
+    xSemaphoreGive(uCommandListMutex);
+
+    if(foundIdx == COMMAND_INDEX_NONE) {
+        return uCommandNotFound;
+    }
+    *cmdIndex = foundIdx;
+    return uCommandOk;
 }
 
 Urabros_CommandReturnStatus uCommandGetById(Urabros_CommandIdTypedef commandId, Urabros_CommandPtrTypedef commandRetPtr)
 {
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
-        uint8_t foundIt = 0;
-        for(uint8_t i = 0; i < uCommandNumber; i++) {
-            if(uCommandList[i].id == commandId) {
-                foundIt = 1;
-                commandRetPtr = uCommandList + i;
-                break;
-            }
-        }
-        xSemaphoreGive(uCommandListMutex);
-        if(foundIt) {
-            return uCommandOk;
-        } else {
-            return uCommandNotFound;
-        }
-    } else {
+    uint8_t foundIdx;
+
+    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) != pdTRUE) {
         return uCommandTimedOut;
     }
+    foundIdx = uCommandIndex[commandId];
+    if(foundIdx != COMMAND_INDEX_NONE) {
+        *commandRetPtr = uCommandList[foundIdx];
+    }
+    xSemaphoreGive(uCommandListMutex);
+
+    if(foundIdx == COMMAND_INDEX_NONE) {
+        return uCommandNotFound;
+    }
+    return uCommandOk;
 }
 
 Urabros_CommandReturnStatus uCommandClear(Urabros_CommandPtrTypedef commandPtr)
 {
     commandPtr->id              = TASK_ID_NONE;
-    commandPtr->status.main     = 0x00;
-    commandPtr->status.minor    = 0x00;
+    commandPtr->task            = NULL;
     return uCommandOk;
 }
 
 Urabros_CommandReturnStatus uCommandPrint(Urabros_CommandPtrTypedef commandPtr)
 {
-    if(commandPtr == NULL)
+    uint32_t statusWord;
+
+    if(commandPtr == NULL || commandPtr->task == NULL)
         return;
 
-    dprintln("Id: %d | main: %d | minor: %d", commandPtr->id, commandPtr->status.main, commandPtr->status.minor);
+    statusWord = commandPtr->task->statusWord;
+    dprintln("Id: %d | main: %d | minor: %d", commandPtr->id, URABROS_STATUS_MAIN(statusWord), URABROS_STATUS_MINOR(statusWord));
 }
 
 Urabros_CommandReturnStatus uCommandPrintList(void)
@@ -10,9 +10,14 @@
   *           An uTask has two kind of "status" one of them is teh status the other is errorCode.
   *           These two values are shifted in to one 8 bit value. (Status = main = 3bit long. Error code = minor = 5 bit long)
   *           From theese two values one is created with the @see urabrosCreateStatusResponse() funcion.
+  *           The uTask publishes them in its status word, the command points to its uTask so the status is read directly from there.
   *           So the driver PC will get all of the IDs of a the currently running tasks and their stauties.
   *           The drier can add and delete tasks from the command list. The maximum size of the command list is #TASK_COUNT
   *           because every command can have only one runnin instance in this architecture. 
+  *
+  *           Every command can be found by its ID in one step with a 256 entry index table, so the cost of the
+  *           lookups doesn't grow with the number of tasks. When a command is removed the last one of the list
+  *           takes its place, so the order of the list is not the order of the additions.
   */
 
 #ifndef MASTER_COMMUNICATION_UCOMMANDHANDLER_H_
@@ -30,29 +35,29 @@ extern uint8_t                  uCommandNumber;
 */
 Urabros_StatusTypeDef uCommandHandlerInit(void);
 /**
-  * @brief  
-  * @param   commandPtr - 
-  * @return  
+  * @brief  Adds a command to the end of the command list.
+  * @param   commandPtr - The command, its ID and its uTask pointer are copied.
+  * @return  #uCommandAdded, #uCommandIdAlreadyUsed, #uCommandOwerFlow, #uCommandIdOutOfRange or #uCommandTimedOut
 */
 Urabros_CommandReturnStatus uCommandAppend(Urabros_CommandPtrTypedef commandPtr);
 /**
-  * @brief  
-  * @param   commandId - 
-  * @return  
+  * @brief  Removes a finished command from the command list, the last command of the list takes its place.
+  * @param   commandId - ID of the command.
+  * @return  #uCommandDeleted, #uCommandNotFound, #uCommandNotFinished if the task is not waiting for ACK, or #uCommandTimedOut
 */
 Urabros_CommandReturnStatus uCommandRemoveById(Urabros_CommandIdTypedef commandId);
 /**
-  * @brief  
-  * @param   commandId - 
-  * @param   cmdIndex - 
-  * @return 
+  * @brief  Gives back the index of the command in the #uCommandList.
+  * @param   commandId - ID of the command.
+  * @param   cmdIndex - Loaded with the index if the command was found.
+  * @return #uCommandOk, #uCommandNotFound or #uCommandTimedOut
 */
 Urabros_CommandReturnStatus uCommandGetIndexById(Urabros_CommandIdTypedef commandId, uint8_t *cmdIndex);
 /**
-  * @brief  
-  * @param  commandId - 
-  * @param  commandRetPtr - 
-  * @return 
+  * @brief  Gives back a copy of the command.
+  * @param  commandId - ID of the command.
+  * @param  commandRetPtr - Loaded with the command if it was found.
+  * @return #uCommandOk, #uCommandNotFound or #uCommandTimedOut
 */
 Urabros_CommandReturnStatus uCommandGetById(Urabros_CommandIdTypedef commandId, Urabros_CommandPtrTypedef commandRetPtr);
 /**
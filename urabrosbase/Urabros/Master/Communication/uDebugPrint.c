@@ -12,21 +12,262 @@
 /* Includes ------------------------------------------------------------------*/
 #include "string.h"
 #include "usart.h"
+#include "UrabrosTime.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "uOutgoingMessageHandler.h"
+
+/* Private defines -----------------------------------------------------------*/
+#if DPRINT_ENABLE
+#define DLOG_SYNC               0xA5                    /**< First byte of every binary log record, the PC resyncs on it*/
+#define DPRINT_RING_ISR         DPRINT_RING_NUM         /**< Index of the buffer of the interrupts*/
+#define DPRINT_RING_SHARED      (DPRINT_RING_NUM + 1)   /**< Index of the buffer of the threads without own buffer*/
+#define DPRINT_RING_ALL         (DPRINT_RING_NUM + 2)   /**< Number of all the buffers*/
+#define DPRINT_ENTRY_HEADER     5                       /**< | len | timestamp 4 byte | of every message in the meta buffers*/
+#define DPRINT_META_SIZE        (DPRINT_RING_SIZE / 2)  /**< Size of the meta buffers, the headers of the messages are stored apart, so the texts of a thread are contiguous*/
+
+#if DPRINT_TX_CHUNK_SIZE > 0xFF
+    #define DPRINT_ENTRY_MAX_LEN    0xFF
+#else
+    #define DPRINT_ENTRY_MAX_LEN    DPRINT_TX_CHUNK_SIZE /**< Maximal length of one message, it must fit in one frame*/
+#endif
+
+#if (DPRINT_RING_SIZE & (DPRINT_RING_SIZE - 1))
+    #error "DPRINT_RING_SIZE must be a power of two"
+#endif
+
+#if DPRINT_BINARY_ENABLE && (DPRINT_TX_CHUNK_SIZE > 0xFF)
+    #error "DPRINT_TX_CHUNK_SIZE must fit in the length byte of the binary log frame"
+#endif
+
+/* Private typedefs ----------------------------------------------------------*/
+/** @struct uDebugRingTypeDef
+ *  @brief A debug buffer with one writer and one reader (the sender thread).
+ *  @var uDebugRingTypeDef::buff
+ *  The array of the texts
+ *  @var uDebugRingTypeDef::metaBuff
+ *  The array of the headers
+ *  @var uDebugRingTypeDef::cBuff
+ *  The circular buffer of the texts, the writer changes only its write index, the sender only its read index
+ *  @var uDebugRingTypeDef::meta
+ *  The circular buffer of the headers
+ *  @var uDebugRingTypeDef::owner
+ *  The thread writing this buffer, NULL if it is free
+ *  @var uDebugRingTypeDef::lost
+ *  Number of messages not fitting in the buffer, only the writer changes it
+ *  @var uDebugRingTypeDef::sendingLen
+ *  Number of text bytes on the line, they are released by the Tx complete
+ *  @var uDebugRingTypeDef::sendingMeta
+ *  Number of header bytes belonging to the texts on the line
+ */
+typedef struct {
+    uint8_t             buff[DPRINT_RING_SIZE];
+    uint8_t             metaBuff[DPRINT_META_SIZE];
+    circularBuffer      cBuff;
+    circularBuffer      meta;
+    TaskHandle_t        owner;
+    uint32_t            lost;
+    uint16_t            sendingLen;
+    uint16_t            sendingMeta;
+}uDebugRingTypeDef, *uDebugRingPtr;
+#endif
 
 /* Public global extern variables --------------------------------------------*/
 
 /* Private variables ---------------------------------------------------------*/
 #if DPRINT_ENABLE
-    static uint8_t uDebugPrintBuffer[DPRINT_BUFF_SIZE];
-    static uint8_t uDebugPrintOutPutBuffer[DPRINT_BUFF_SIZE + 2];
-    static circularBuffer uDebugCircBuffer;
-    static char timeStamp[10];
+    static uDebugRingTypeDef uDebugRings[DPRINT_RING_ALL];
+    static volatile uint8_t uDebugSending = 0;     /**< 1 while the prepared segments are on the line.*/
+    #if DPRINT_BINARY_ENABLE
+        static uint8_t uDebugFrameStart[2];         /**< | #MESSAGE_BINARY_LOG | len |*/
+    #else
+        static const uint8_t uDebugFrameStart[1] = {MESSAGE_START_OF_TEXT};
+        static const uint8_t uDebugFrameEnd[1]   = {MESSAGE_END_OF_TEXT};
+    #endif
+#endif
+
+/* Private functions ---------------------------------------------------------*/
+#if DPRINT_ENABLE
+/** Writes one message with its header to the buffer. Only the writer of the buffer may call it.
+ *  @param stampRecord If it is 1 the data is a binary log record, and its timestamp field is filled too.
+ */
+static void uDebugRingWrite(uDebugRingPtr ring, uint32_t timeStamp, const uint8_t *data, uint16_t len, uint8_t stampRecord)
+{
+    uint8_t header[DPRINT_ENTRY_HEADER];
+
+    if(len > DPRINT_ENTRY_MAX_LEN) {
+        len = DPRINT_ENTRY_MAX_LEN;
+    }
+
+    // A message what doesn't fit is only counted, the UART belongs to the sender thread.
+    if(circularBufferFree(&ring->cBuff) < len || circularBufferFree(&ring->meta) < DPRINT_ENTRY_HEADER) {
+        ring->lost++;
+        return;
+    }
+
+    header[0] = len;
+    memcpy(header + 1, &timeStamp, sizeof(timeStamp));
+    circularBufferCopyIn(&ring->cBuff, 0, data, len);
+    if(stampRecord) {
+        circularBufferCopyIn(&ring->cBuff, sizeof(uint32_t), (uint8_t*)&timeStamp, sizeof(timeStamp));
+    }
+    // The sender finds the text by the header, so the text goes first.
+    circularBufferProduce(&ring->cBuff, len);
+    circularBufferWrite(&ring->meta, header, DPRINT_ENTRY_HEADER);
+}
+
+/** Gives back the buffer of the calling thread, at the first call a free buffer is assigned to the thread.
+ *  @return Pointer to the buffer or NULL if there is no free buffer or the scheduler is not running.
+ */
+static uDebugRingPtr uDebugRingOfThread(void)
+{
+    TaskHandle_t    self;
+    uDebugRingPtr   ring = NULL;
+
+    if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) {
+        return NULL;
+    }
+
+    self = xTaskGetCurrentTaskHandle();
+    for(uint8_t idx = 0; idx < DPRINT_RING_NUM; idx++) {
+        if(uDebugRings[idx].owner == self) {
+            return uDebugRings + idx;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    for(uint8_t idx = 0; idx < DPRINT_RING_NUM; idx++) {
+        if(uDebugRings[idx].owner == NULL) {
+            uDebugRings[idx].owner = self;
+            ring = uDebugRings + idx;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    return ring;
+}
+
+/** Puts a message to the buffer of the caller thread or interrupt.
+ */
+static void uDebugPut(const uint8_t *data, uint16_t len, uint8_t stampRecord)
+{
+    uDebugRingPtr   ring;
+    UBaseType_t     isrMask;
+    BaseType_t      higherPriorityTaskWoken = pdFALSE;
+
+    if(__get_IPSR()) {
+        // Interrupts can nest, so the interrupt buffer is written with masked interrupts.
+        isrMask = taskENTER_CRITICAL_FROM_ISR();
+        uDebugRingWrite(uDebugRings + DPRINT_RING_ISR, uTimeGetUsFromISR(), data, len, stampRecord);
+        taskEXIT_CRITICAL_FROM_ISR(isrMask);
+        uMsgTxNotifyFromISR(&higherPriorityTaskWoken);
+        portYIELD_FROM_ISR(higherPriorityTaskWoken);
+        return;
+    }
+
+    ring = uDebugRingOfThread();
+    if(ring != NULL) {
+        uDebugRingWrite(ring, uTimeGetUs(), data, len, stampRecord);
+    } else {
+        taskENTER_CRITICAL();
+        uDebugRingWrite(uDebugRings + DPRINT_RING_SHARED, uTimeGetUs(), data, len, stampRecord);
+        taskEXIT_CRITICAL();
+    }
+
+    // The scheduler may not run yet, then the sender is not registered and it finds the message at its start.
+    uMsgTxNotify();
+}
+
+/** Adds a span to the segments, if it continues the last segment that is made longer.
+ *  @return 0 if it was added, 1 if there is no more free segment.
+ */
+static uint8_t uDebugAddSpan(Urabros_TxSegmentTypeDef *segments, uint8_t *num, uint8_t maxNum, circularBufferSpan *span)
+{
+    Urabros_TxSegmentTypeDef *last = segments + *num - 1;
+
+    if(!span->len) {
+        return 0;
+    }
+    if(last->data + last->len == span->data) {
+        last->len += span->len;
+        return 0;
+    }
+    if(*num >= maxNum) {
+        return 1;
+    }
+    segments[*num].data = span->data;
+    segments[*num].len  = span->len;
+    (*num)++;
+    return 0;
+}
+
+/** Collects the waiting messages of all the buffers in timestamp order to the segments, only whole messages are taken.
+ *  The texts stay in the buffers, the messages of a thread following each other are one segment.
+ *  @param segments The first segment is the frame start, the collected texts are added after it.
+ *  @param num Number of the used segments, it is increased.
+ *  @param maxNum Size of the segments array.
+ *  @return Number of the text bytes collected.
+ */
+static uint16_t uDebugMerge(Urabros_TxSegmentTypeDef *segments, uint8_t *num, uint8_t maxNum)
+{
+    uDebugRingPtr       ring;
+    uDebugRingPtr       oldest;
+    circularBufferSpan  spans[2];
+    uint8_t             header[DPRINT_ENTRY_HEADER];
+    uint8_t             savedNum;
+    uint32_t            timeStamp;
+    uint32_t            oldestTime  = 0;
+    uint16_t            oldestLen   = 0;
+    uint16_t            pos         = 0;
+
+    for(;;) {
+        oldest = NULL;
+        for(uint8_t idx = 0; idx < DPRINT_RING_ALL; idx++) {
+            ring = uDebugRings + idx;
+            if(circularBufferPeek(&ring->meta, ring->sendingMeta, header, DPRINT_ENTRY_HEADER)) {
+                continue;
+            }
+            memcpy(&timeStamp, header + 1, sizeof(timeStamp));
+            if(oldest == NULL || (int32_t)(timeStamp - oldestTime) < 0) {
+                oldest      = ring;
+                oldestTime  = timeStamp;
+                oldestLen   = header[0];
+            }
+        }
+
+        if(oldest == NULL || pos + oldestLen > DPRINT_TX_CHUNK_SIZE) {
+            break;
+        }
+
+        savedNum = *num;
+        circularBufferPeekSpansAt(&oldest->cBuff, oldest->sendingLen, oldestLen, spans);
+        if(uDebugAddSpan(segments, num, maxNum, spans) || uDebugAddSpan(segments, num, maxNum, spans + 1)) {
+            // The message doesn't fit in the segments, it goes in the next frame.
+            *num = savedNum;
+            break;
+        }
+
+        oldest->sendingLen  += oldestLen;
+        oldest->sendingMeta += DPRINT_ENTRY_HEADER;
+        pos                 += oldestLen;
+    }
+
+    return pos;
+}
 #endif
 
 #if DPRINT_ENABLE
     void uDebugPrintInit()
     {
-        circularBufferInit(&uDebugCircBuffer, uDebugPrintBuffer, DPRINT_BUFF_SIZE);
+        for(uint8_t idx = 0; idx < DPRINT_RING_ALL; idx++) {
+            circularBufferInit(&uDebugRings[idx].cBuff, uDebugRings[idx].buff, DPRINT_RING_SIZE);
+            circularBufferInit(&uDebugRings[idx].meta, uDebugRings[idx].metaBuff, DPRINT_META_SIZE);
+            uDebugRings[idx].owner          = NULL;
+            uDebugRings[idx].lost           = 0;
+            uDebugRings[idx].sendingLen     = 0;
+            uDebugRings[idx].sendingMeta    = 0;
+        }
     }
 #else
     void uDebugPrintInit(){};
@@ -35,39 +276,133 @@
 #if DPRINT_ENABLE
     void uDebugPrintWrite(char* dMsg, uint16_t dMsgLen)
     {
-        uint8_t retval = circularBufferWrite(&uDebugCircBuffer, (uint8_t*)dMsg, dMsgLen);
-        if(retval) {
-            char full[20];
-            uint8_t len = sprintf(full, "\nful:%d\n", retval);
-            HAL_UART_Transmit_DMA(MESSAGE_UART_MAIN_PTR, full, len);
+        uDebugPut((uint8_t*)dMsg, dMsgLen, 0);
+    }
+#else
+    void uDebugPrintWrite(char* dMsg, uint16_t dMsgLen){ (void)dMsg; (void)dMsgLen; };
+#endif
+
+#if DPRINT_ENABLE
+    void uDebugPrintWriteTimeStamp(char* dMsg, uint16_t dMsgLen)
+    {
+        char        line[10 + DPRINT_TEMP_BUFF_SIZE];
+        uint16_t    len;
+
+        if(dMsgLen > DPRINT_TEMP_BUFF_SIZE) {
+            dMsgLen = DPRINT_TEMP_BUFF_SIZE;
+        }
+
+        // The timestamp and the message go in one piece, so an other thread can't get between them.
+        len = sprintf(line, "%10lu", (unsigned long)HAL_GetTick());
+        memcpy(line + len, dMsg, dMsgLen);
+        uDebugPut((uint8_t*)line, len + dMsgLen, 0);
+    }
+#else
+    void uDebugPrintWriteTimeStamp(char* dMsg, uint16_t dMsgLen){ (void)dMsg; (void)dMsgLen; };
+#endif
+
+#if DPRINT_ENABLE && DPRINT_BINARY_ENABLE
+    void uDebugLogWrite(const char *fmt, const uint32_t *args, uint8_t nargs)
+    {
+        uint32_t record[2 + DPRINT_BINARY_MAX_ARGS];
+
+        if(nargs > DPRINT_BINARY_MAX_ARGS) {
+            nargs = DPRINT_BINARY_MAX_ARGS;
+        }
+
+        record[0] = ((uint32_t)(uint16_t)(uintptr_t)fmt << 16) | ((uint32_t)nargs << 8) | DLOG_SYNC;
+        record[1] = 0;
+        for(uint8_t idx = 0; idx < nargs; idx++) {
+            record[2 + idx] = args[idx];
+        }
+
+        // The timestamp is filled by the buffer, so the records of a buffer are always in order.
+        uDebugPut((uint8_t*)record, (2 + nargs) * sizeof(uint32_t), 1);
+    }
+#else
+    void uDebugLogWrite(const char *fmt, const uint32_t *args, uint8_t nargs){ (void)fmt; (void)args; (void)nargs; };
+#endif
+
+#if DPRINT_ENABLE
+    uint8_t uDebugPrintPrepare(Urabros_TxSegmentTypeDef *segments, uint8_t maxNum)
+    {
+        uint8_t     num = 1;
+        uint16_t    len;
+
+        // The previous segments are still on the line.
+        if(uDebugSending || maxNum < 3) {
+            return 0;
+        }
+
+        segments[0].data    = uDebugFrameStart;
+        segments[0].len     = sizeof(uDebugFrameStart);
+    #if DPRINT_BINARY_ENABLE
+        len = uDebugMerge(segments, &num, maxNum);
+        uDebugFrameStart[0] = MESSAGE_BINARY_LOG;
+        uDebugFrameStart[1] = len;
+    #else
+        // Keep one segment for the frame end.
+        len = uDebugMerge(segments, &num, maxNum - 1);
+        segments[num].data  = uDebugFrameEnd;
+        segments[num].len   = sizeof(uDebugFrameEnd);
+        num++;
+    #endif
+
+        if(!len) {
+            return 0;
         }
+        uDebugSending = 1;
+        return num;
     }
 #else
-    void uDebugPrintWrite(char* dMsg, uint16_t dMsgLen){};
+    uint8_t uDebugPrintPrepare(Urabros_TxSegmentTypeDef *segments, uint8_t maxNum){ (void)segments; (void)maxNum; return 0; };
 #endif
 
 #if DPRINT_ENABLE
-void uDebugPrintWriteTimeStamp(char* dMsg, uint16_t dMsgLen)
+    void uDebugPrintRelease(void)
     {
-        sprintf(timeStamp, "%10d", HAL_GetTick());
-        circularBufferWrite(&uDebugCircBuffer, (uint8_t*)timeStamp, 10);
-        circularBufferWrite(&uDebugCircBuffer, (uint8_t*)dMsg, dMsgLen);
+        uDebugRingPtr ring;
+
+        for(uint8_t idx = 0; idx < DPRINT_RING_ALL; idx++) {
+            ring = uDebugRings + idx;
+            circularBufferConsume(&ring->cBuff, ring->sendingLen);
+            circularBufferConsume(&ring->meta, ring->sendingMeta);
+            ring->sendingLen    = 0;
+            ring->sendingMeta   = 0;
+        }
+        uDebugSending = 0;
     }
 #else
-    void uDebugPrintWriteTimeStamp(char* dMsg, uint16_t dMsgLen){};
+    void uDebugPrintRelease(void){};
 #endif
 
 #if DPRINT_ENABLE
-    void uDebugPrintRead(void)
+    uint8_t uDebugPrintPending(void)
     {
-        uint16_t dataReadLen = 0;
-        uDebugPrintOutPutBuffer[0] = MESSAGE_START_OF_TEXT; // Set the first byte to charset mode.
-        circularBufferRead(&uDebugCircBuffer, uDebugPrintOutPutBuffer + 1, &dataReadLen);
-        uDebugPrintOutPutBuffer[dataReadLen + 1] = MESSAGE_END_OF_TEXT;
-        if(dataReadLen) {
-            HAL_UART_Transmit_DMA(MESSAGE_UART_MAIN_PTR, uDebugPrintOutPutBuffer, dataReadLen + 2);
+        if(uDebugSending) {
+            return 0;
+        }
+        for(uint8_t idx = 0; idx < DPRINT_RING_ALL; idx++) {
+            if(circularBufferUsed(&uDebugRings[idx].meta)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+#else
+    uint8_t uDebugPrintPending(void){ return 0; };
+#endif
+
+#if DPRINT_ENABLE
+    uint32_t uDebugPrintGetLost(void)
+    {
+        uint32_t lost = 0;
+
+        for(uint8_t idx = 0; idx < DPRINT_RING_ALL; idx++) {
+            lost += uDebugRings[idx].lost;
         }
+        return lost;
     }
 #else
-    void uDebugPrintRead(void){};
+    uint32_t uDebugPrintGetLost(void){ return 0; };
 #endif
@@ -15,54 +15,92 @@
   *           After included correctly you can use: dprint(const char*,...); and dprintln(const char*, ...) functions.
   *           They behave like printf() so you can convert a lot of base type variables to ASCII string.
   *           Theese functions place the ASCII debug messages in to a circural buffer, what will be later processed by the @see urabrosMessageSenderFunction() function.
+  *
+  *           Every thread gets its own buffer at its first message (#DPRINT_RING_NUM of them), only the owner thread writes it
+  *           and only the sender thread reads it, so writing needs no lock. Interrupts write to a separate buffer, and threads
+  *           over #DPRINT_RING_NUM share one buffer protected by a critical section. Every message gets a timestamp, and the
+  *           sender merges the waiting messages of all the buffers in timestamp order.
+  *
+  *           If #DPRINT_BINARY_ENABLE is set, the sprintf() is skipped. The format string is placed in the .dlog_fmt section
+  *           what is not loaded to the device, and only a record is written in the buffer:
+  *           | 0xA5 | nargs | format ID 2 byte | timestamp in us 4 byte | arg 1 4 byte | ... | arg n 4 byte |   (little endian)
+  *           The format ID is the address of the string in the .dlog_fmt section. The dlogExtract.py of the PC tester
+  *           builds the dictionary from the elf file, and the PC renders the text.\n
+  *           Supported conversions in binary mode, every argument is checked at compile time by DLOG_ARG():\n
+  *           %d %i %u %x %X %o %c - integer, char and enum arguments up to 32 bits, they are stored as uint32_t.\n
+  *           %f %e %g - float and double arguments, they are stored as a 32 bit float, so a double loses precision.\n
+  *           Pointers (%s, %p) and 64 bit integers don't compile, a string is not in the dictionary.
   */
 #ifndef MASTER_COMMUNICATION_UDEBUGPRINT_H_
 #define MASTER_COMMUNICATION_UDEBUGPRINT_H_
 
 #include "UrabrosConfig.h"
+#include "UrabrosTypeDef.h"
 #include <stdint.h>
 #include <stdio.h>
 
 #if DPRINT_ENABLE
     #if DPRINT_LOCAL_ENABLE
-        /* Static variables for Dprint*/
-        static char dPrintTempBuff[DPRINT_TEMP_BUFF_SIZE];
-        static uint16_t dMsgLen;
-
         #ifndef UTASK_NAME
             #define PRESTRING ""
         #else
             #define PRESTRING UTASK_NAME": "
         #endif
 
-        #if DPRINT_LOG_TIME_GLOBAL
-            #define dprintln(f_, ...)   {\
-                                        dMsgLen = sprintf(dPrintTempBuff, (" "PRESTRING f_"\n"), ##__VA_ARGS__);\
-                                        uDebugPrintWriteTimeStamp(dPrintTempBuff, dMsgLen);\
-                                        }
-            #define dprint(f_, ...)     {\
-                                        dMsgLen = sprintf(dPrintTempBuff, (f_), ##__VA_ARGS__);\
-                                        uDebugPrintWriteTimeStamp(dPrintTempBuff, dMsgLen);\
-                                        }
-        #elif DPRINT_LOG_TIME_LOCAL
-            #define dprintln(f_, ...)   {\
-                                        dMsgLen = sprintf(dPrintTempBuff, (" "PRESTRING f_"\n"), ##__VA_ARGS__);\
-                                        uDebugPrintWriteTimeStamp(dPrintTempBuff, dMsgLen);\
+        #if DPRINT_BINARY_ENABLE
+            /* Counts the arguments of a binary log, 0 - 8 */
+            #define DLOG_NARGS(...)     DLOG_NARGS_(0, ##__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+            #define DLOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, N, ...) N
+
+            /* Converts one argument to its 32 bit record field, an argument of other type has no association and doesn't compile */
+            #define DLOG_ARG(a_)        _Generic((a_),\
+                                        _Bool: uDebugLogArgInt, char: uDebugLogArgInt, signed char: uDebugLogArgInt, unsigned char: uDebugLogArgInt,\
+                                        short: uDebugLogArgInt, unsigned short: uDebugLogArgInt, int: uDebugLogArgInt, unsigned int: uDebugLogArgInt,\
+                                        long: uDebugLogArgInt, unsigned long: uDebugLogArgInt,\
+                                        float: uDebugLogArgFloat, double: uDebugLogArgFloat)(a_)
+
+            /* Applies DLOG_ARG() to every argument, the list starts with a comma if it is not empty */
+            #define DLOG_CAT(a_, b_)    DLOG_CAT_(a_, b_)
+            #define DLOG_CAT_(a_, b_)   a_##b_
+            #define DLOG_ARGS(...)      DLOG_CAT(DLOG_ARGS_, DLOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+            #define DLOG_ARGS_0(...)
+            #define DLOG_ARGS_1(a_)         , DLOG_ARG(a_)
+            #define DLOG_ARGS_2(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_1(__VA_ARGS__)
+            #define DLOG_ARGS_3(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_2(__VA_ARGS__)
+            #define DLOG_ARGS_4(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_3(__VA_ARGS__)
+            #define DLOG_ARGS_5(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_4(__VA_ARGS__)
+            #define DLOG_ARGS_6(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_5(__VA_ARGS__)
+            #define DLOG_ARGS_7(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_6(__VA_ARGS__)
+            #define DLOG_ARGS_8(a_, ...)    , DLOG_ARG(a_) DLOG_ARGS_7(__VA_ARGS__)
+
+            /* The format string goes to the .dlog_fmt section, only its address and the arguments are stored */
+            #define dlogRecord(f_, ...) {\
+                                        static const char dlogFmt[] __attribute__((section(".dlog_fmt"), used)) = f_;\
+                                        const uint32_t dlogArgs[DLOG_NARGS(__VA_ARGS__) + 1] = {0 DLOG_ARGS(__VA_ARGS__)};\
+                                        uDebugLogWrite(dlogFmt, dlogArgs + 1, DLOG_NARGS(__VA_ARGS__));\
                                         }
-            #define dprint(f_, ...)     {\
-                                        dMsgLen = sprintf(dPrintTempBuff, (f_), ##__VA_ARGS__);\
-                                        uDebugPrintWriteTimeStamp(dPrintTempBuff, dMsgLen);\
-                            }
+            #define dprintln(f_, ...)   dlogRecord(PRESTRING f_"\n", ##__VA_ARGS__)
+            #define dprint(f_, ...)     dlogRecord(f_, ##__VA_ARGS__)
         #else
-            #define dprintln(f_, ...)   {\
-                                        dMsgLen = sprintf(dPrintTempBuff, (PRESTRING f_"\n"), ##__VA_ARGS__);\
-                                        uDebugPrintWrite(dPrintTempBuff, dMsgLen);\
+            /* The message is formatted on the stack of the caller, so the threads don't share any buffer */
+            #define dprintFormat(write_, f_, ...) {\
+                                        char dPrintTempBuff[DPRINT_TEMP_BUFF_SIZE];\
+                                        int dMsgLen = snprintf(dPrintTempBuff, DPRINT_TEMP_BUFF_SIZE, f_, ##__VA_ARGS__);\
+                                        if(dMsgLen >= DPRINT_TEMP_BUFF_SIZE) {\
+                                            dMsgLen = DPRINT_TEMP_BUFF_SIZE - 1;\
+                                        }\
+                                        if(dMsgLen > 0) {\
+                                            write_(dPrintTempBuff, dMsgLen);\
+                                        }\
                                         }
 
-            #define dprint(f_, ...) {\
-                                    dMsgLen = sprintf(dPrintTempBuff, (f_), ##__VA_ARGS__);\
-                                    uDebugPrintWrite(dPrintTempBuff, dMsgLen);\
-                                    }
+            #if DPRINT_LOG_TIME_GLOBAL || DPRINT_LOG_TIME_LOCAL
+                #define dprintln(f_, ...)   dprintFormat(uDebugPrintWriteTimeStamp, (" "PRESTRING f_"\n"), ##__VA_ARGS__)
+                #define dprint(f_, ...)     dprintFormat(uDebugPrintWriteTimeStamp, (f_), ##__VA_ARGS__)
+            #else
+                #define dprintln(f_, ...)   dprintFormat(uDebugPrintWrite, (PRESTRING f_"\n"), ##__VA_ARGS__)
+                #define dprint(f_, ...)     dprintFormat(uDebugPrintWrite, (f_), ##__VA_ARGS__)
+            #endif
         #endif
     #else
         #define dprintln(f_, ...)
@@ -84,26 +122,79 @@ void uDebugPrintInit();
 /**
   * @param  dMsg - Pointer to buffer where the actual message is.
   * @param  dMsgLen - Length of the message
-  * @brief  Adds the message to the uDebugPrintBuffer, if the message cannot fit in the buffer,
-  * than put a '$' character instead of the message to the end of the buffer, and sets the
-  * dDebugPrintOverflow flag to 1.
+  * @brief  Adds the message to the debug buffer of the caller thread or interrupt, with a microsecond timestamp
+  *         for the ordering. If the message doesn't fit in the free space of the buffer it is dropped whole,
+  *         and the lost counter of the buffer is incremented. The messages already in the buffer are not touched.
 */
 void uDebugPrintWrite(char* dMsg, uint16_t dMsgLen);
 
 /**
-  * @brief  Adds the message to the uDebugPrintBuffer, but places a timestamp what is a systic from the beggining of the startup
-  * to the beggingin. If the message cannot fit in the buffer, than put a '$' character instead of the message to the end of the buffer,
-  * and sets the dDebugPrintOverflow flag to 1.
+  * @brief  Same as @see uDebugPrintWrite(), but the text starts with the systick since the startup.
+  *         The timestamp and the message are written in one piece, so they are dropped and counted together.
   * @param   dMsg - Pointer to buffer where the actual message is.
-  * @param   dMsgLen - Length of the message
+  * @param   dMsgLen - Length of the message, at most #DPRINT_TEMP_BUFF_SIZE is used
+*/
+void uDebugPrintWriteTimeStamp(char* dMsg, uint16_t dMsgLen);
+
+/**
+  * @brief  Record field of an integer argument of the binary log, see at DLOG_ARG().
+  * @param  value - The argument, the signed values are stored in two's complement.
+  * @return The value of the field.
+*/
+static inline uint32_t uDebugLogArgInt(uint32_t value)
+{
+    return value;
+}
+
+/**
+  * @brief  Record field of a float or double argument of the binary log, see at DLOG_ARG().
+  * @param  value - The argument, a double is converted to float.
+  * @return The bits of the 32 bit float, the PC renders them with the %f, %e and %g conversions.
+*/
+static inline uint32_t uDebugLogArgFloat(float value)
+{
+    union {
+        float       f;
+        uint32_t    u;
+    }bits = { .f = value };
+
+    return bits.u;
+}
+
+/**
+  * @brief  Writes a binary log record to the uDebugPrintBuffer, it is called by the dprint() macros if #DPRINT_BINARY_ENABLE is set.
+  *         The record is written whole or it is dropped and counted.
+  * @param  fmt - Pointer to the format string in the .dlog_fmt section.
+  * @param  args - The arguments converted to uint32_t.
+  * @param  nargs - Number of arguments, at most #DPRINT_BINARY_MAX_ARGS are stored.
+*/
+void uDebugLogWrite(const char *fmt, const uint32_t *args, uint8_t nargs);
+
+/**
+  * @param  segments - Array of Tx segments, loaded with the frame.
+  * @param  maxNum - Size of the segments array.
+  * @return Number of the used segments, 0 if there was no debug message waiting or the previous segments are still on the line.
+  * @brief  Collects at most #DPRINT_TX_CHUNK_SIZE characters of the waiting debug messages in timestamp order.
+  * The frame is not copied, the segments point in to the debug buffers: a #MESSAGE_START_OF_TEXT byte, the texts
+  * and a #MESSAGE_END_OF_TEXT byte. In binary mode the frame is a #MESSAGE_BINARY_LOG byte and a length byte
+  * followed by the records. The messages stay in the buffers until @see uDebugPrintRelease() is called.
+*/
+uint8_t uDebugPrintPrepare(Urabros_TxSegmentTypeDef *segments, uint8_t maxNum);
+
+/**
+  * @brief  Frees the place of the messages collected by @see uDebugPrintPrepare(), it is called by the Tx complete interrupt
+  * after the last segment was sent out.
+*/
+void uDebugPrintRelease(void);
+
+/**
+  * @return 1 if there is a debug message waiting and the previous segments are not on the line, otherwise 0.
 */
-void uDebugPrintWriteimeStamp(char* dMsg, uint16_t dMsgLen);
+uint8_t uDebugPrintPending(void);
 
 /**
-  * @return void -
-  * @brief  Sends out the uDebugPrintBuffer using the defined peripheral.
-  * Clears the buffer, sets the dDebugPrintOverflow flag to 0.
+  * @return The number of debug messages dropped because the uDebugPrintBuffer was full.
 */
-void uDebugPrintRead(void);
+uint32_t uDebugPrintGetLost(void);
 
 #endif /* MASTER_COMMUNICATION_UDEBUGPRINT_H_ */
@@ -11,10 +11,69 @@
 #include <usart.h>
 #include "crc16.h"
 #include "string.h"
+#include "semphr.h"
+#include "UrabrosStatic.h"
+#include "UrabrosTime.h"
+#include "UrabrosEmergencyStop.h"
+#include "UrabrosProfile.h"
 
 #define DPRINT_LOCAL_ENABLE 1
 #include "uDebugPrint.h"
 
+#if (MESSAGE_IN_ARRAY_LENGTH & (MESSAGE_IN_ARRAY_LENGTH - 1)) != 0
+    #error "MESSAGE_IN_ARRAY_LENGTH must be a power of two"
+#endif
+
+/** Mask for selecting the slot of a free running index.
+ */
+#define MSG_IN_INDEX_MASK   (MESSAGE_IN_ARRAY_LENGTH - 1)
+
+/** States of the incoming byte stream parser.
+ */
+typedef enum {
+    uParserWaitLength   = 0, /**< Waiting for the length byte of the next frame.*/
+    uParserData         = 1, /**< Receiving the data bytes of the frame.*/
+    uParserCrcHigh      = 2, /**< Waiting for the upper byte of the CRC.*/
+    uParserCrcLow       = 3, /**< Waiting for the lower byte of the CRC.*/
+    uParserSkip         = 4, /**< Dropping the bytes after an error until the line is idle.*/
+}Urabros_ParserStateTypeDef;
+
+/** @struct Urabros_ParserTypeDef
+ *  @brief Holds the state of the incoming byte stream parser between two wake ups.
+ *  @var Urabros_ParserTypeDef::state
+ *  Current state of the parser
+ *  @var Urabros_ParserTypeDef::readPos
+ *  Index of the next unprocessed byte in the #dmaRxBuffer
+ *  @var Urabros_ParserTypeDef::consumed
+ *  Number of bytes ever taken from the #dmaRxBuffer, it is compared with #dmaRxTotal
+ *  @var Urabros_ParserTypeDef::overrunCount
+ *  Number of times the DMA overwrote bytes what were not processed yet
+ *  @var Urabros_ParserTypeDef::received
+ *  Number of data bytes of the current frame already received
+ *  @var Urabros_ParserTypeDef::dataLen
+ *  Data length of the current frame
+ *  @var Urabros_ParserTypeDef::crc
+ *  The CRC of the data bytes received so far, it is calculated while the bytes are copied
+ *  @var Urabros_ParserTypeDef::rxCrc
+ *  The received CRC of the current frame
+ *  @var Urabros_ParserTypeDef::firstByte
+ *  The first data byte (command ID) of the current frame, it is kept even if the frame is dropped
+ *  @var Urabros_ParserTypeDef::slotPtr
+ *  Slot of the incoming buffer, where the current frame is assembled, NULL if the frame is dropped
+ */
+typedef struct {
+    Urabros_ParserStateTypeDef  state;
+    uint16_t                    readPos;
+    uint32_t                    consumed;
+    uint32_t                    overrunCount;
+    uint8_t                     received;
+    uint8_t                     dataLen;
+    uint16_t                    crc;
+    uint16_t                    rxCrc;
+    uint8_t                     firstByte;
+    Urabros_MsgPtr              slotPtr;
+}Urabros_ParserTypeDef;
+
 /** Buffer for holding incoming messages.
  */
 static Urabros_MsgInBuffer uIncomingBuffer;
@@ -23,20 +82,78 @@ static Urabros_MsgInBuffer uIncomingBuffer;
 */
 static uint8_t dmaRxBuffer[DMA_RX_BUFFER_SIZE];
 
-/** Put a message in to #uIncomingBuffer
- */ 
-static Urabros_MsgStatus uMsgInPut(Urabros_MsgPtr uMsgPtr);
+/** The position of the DMA in #dmaRxBuffer, published by the interrupt.
+ */
+static volatile uint16_t dmaRxWritePos;
+
+/** Number of bytes ever received by the DMA, counted by the interrupt.
+ */
+static volatile uint32_t dmaRxTotal;
+
+/** 1 if #dmaRxWritePos was published by the IDLE line interrupt, so the line was silent after the last byte.
+ */
+static volatile uint8_t dmaRxIdle;
+
+/** Time of the interrupt what published #dmaRxWritePos in microseconds, it is the receive time of the last byte.
+ */
+static volatile uint32_t dmaRxTimeUs;
+
+/** The state of the byte stream parser, only the parser thread uses it.
+ */
+static Urabros_ParserTypeDef uParser;
+
+/** Semaphore for waking up the parser thread from the interrupt.
+ */
+static SemaphoreHandle_t uParserSemaphore;
+
+/** Gives back the next free slot of the #uIncomingBuffer, the producer fills it in place.
+ *  If there is no free slot it increments the drop counter.
+ *  @return Pointer to the free slot, or NULL if the buffer is full.
+ */
+static Urabros_MsgPtr uMsgInAcquire(void);
+
+/** Publishes the slot what was got by @see uMsgInAcquire() to the consumer.
+ */
+static void uMsgInCommit(void);
+
+/** Puts an uCommand_RECEIVE_ERROR message with the given error to the #uIncomingBuffer.
+ *  @param slotPtr The slot to be used, if it is NULL a new slot is acquired.
+ *  @param error The error code #uMSg_IdleError, #uMsg_DataLenError or #uMsg_CrcError
+ *  @return 1 if the message was put to the buffer, 0 if it was dropped.
+ */
+static uint8_t uMsgInPutError(Urabros_MsgPtr slotPtr, Urabros_MsgStatus error);
+
+/** Publishes the position of the DMA and wakes up the parser thread, it is called from the interrupts.
+ *  @param idleLine 1 if it is called by the IDLE line interrupt, 0 if by the half or full transfer.
+ */
+static void uMsgInPublishFromISR(uint8_t idleLine);
 
 /* PUBLIC FUNCTIONS */
 Urabros_StatusTypeDef uMsgInInit()
 {
 
     // Clear the buffer
-    uIncomingBuffer.numOfMsg = 0;
+    uIncomingBuffer.writeIdx    = 0;
+    uIncomingBuffer.readIdx     = 0;
+    uIncomingBuffer.dropCount   = 0;
+    uIncomingBuffer.highWater   = 0;
     for(uint16_t msgIndex = 0; msgIndex < MESSAGE_IN_ARRAY_LENGTH; msgIndex++) {
         uMsgReset(uIncomingBuffer.msgBuff + msgIndex);
     }
 
+    // Clear the parser
+    uParser.state       = uParserWaitLength;
+    uParser.readPos     = 0;
+    uParser.consumed    = 0;
+    uParser.overrunCount = 0;
+    uParser.received    = 0;
+    uParser.dataLen     = 0;
+    uParser.slotPtr     = NULL;
+    dmaRxWritePos       = 0;
+    dmaRxTotal          = 0;
+    dmaRxIdle           = 0;
+    uParserSemaphore    = uBinarySemaphoreCreate();
+
     //enable IDLE detection
     __HAL_UART_ENABLE_IT(MESSAGE_UART_MAIN_PTR, UART_IT_IDLE);
     //start receiving MESSAGE_RX_BUFFER_SIZE amount of bytes
@@ -45,194 +162,319 @@ Urabros_StatusTypeDef uMsgInInit()
     return uStatusOk;
 }
 
-// Going from the last element pops out
+Urabros_MsgPtr uMsgInPeek(void)
+{
+    uint32_t readIdx = uIncomingBuffer.readIdx;
+
+    if(readIdx == uIncomingBuffer.writeIdx) {
+        return NULL;
+    }
+
+    // The slot content must be read only after the index was seen.
+    __DMB();
+    return uIncomingBuffer.msgBuff + (readIdx & MSG_IN_INDEX_MASK);
+}
+
+uint32_t uMsgInPeekTimestamp(void)
+{
+    return uIncomingBuffer.rxTimeUs[uIncomingBuffer.readIdx & MSG_IN_INDEX_MASK];
+}
+
+void uMsgInRelease(void)
+{
+    if(uIncomingBuffer.readIdx == uIncomingBuffer.writeIdx) {
+        return;
+    }
+
+    // Finish every access of the slot before giving it back to the producer.
+    __DMB();
+    uIncomingBuffer.readIdx++;
+}
+
+// Going from the oldest element pops out
 Urabros_MsgStatus uMsgInPop(Urabros_MsgPtr uMsgPtr)
 {
-    //xSemaphoreTake(uIncomingBuffer.mutex, portMAX_DELAY); //TODO TIMEOUT
-    if(!uIncomingBuffer.numOfMsg) {
-        //xSemaphoreGive(uIncomingBuffer.mutex);
+    Urabros_MsgPtr oldestPtr = uMsgInPeek();
+    if(oldestPtr == NULL) {
         return uMsg_BufferIsEmpty;
     }
 
-    // Copy the last message to the give pointed message struct.
-    uMsgCopy(uMsgPtr, uIncomingBuffer.msgBuff + uIncomingBuffer.numOfMsg - 1);
-    // Reset the message in the buffer
-    uMsgReset(uIncomingBuffer.msgBuff + uIncomingBuffer.numOfMsg - 1);
-    // Decrease the number of messages in buffer by one. So we get the index in array.
-    uIncomingBuffer.numOfMsg--;
+    // Copy the oldest message to the give pointed message struct, than free its slot.
+    uMsgCopy(uMsgPtr, oldestPtr);
+    uMsgInRelease();
 
-    //xSemaphoreGive(uIncomingBuffer.mutex);
     return uMsg_Ok;
 }
 
-Urabros_MsgStatus uMsgInPut(Urabros_MsgPtr uMsgPtr)
+void uMsgInGetStats(uint32_t *dropCount, uint8_t *highWater, uint32_t *overrunCount)
 {
-    if(uIncomingBuffer.numOfMsg == MESSAGE_IN_ARRAY_LENGTH) {
-        return uMsg_BufferIsFull;
+    if(dropCount != NULL) {
+        *dropCount = uIncomingBuffer.dropCount;
+    }
+    if(highWater != NULL) {
+        *highWater = uIncomingBuffer.highWater;
+    }
+    if(overrunCount != NULL) {
+        *overrunCount = uParser.overrunCount;
     }
+}
 
-    uMsgCopy(uIncomingBuffer.msgBuff + uIncomingBuffer.numOfMsg, uMsgPtr);
-    uIncomingBuffer.numOfMsg++;
+static Urabros_MsgPtr uMsgInAcquire(void)
+{
+    uint32_t writeIdx = uIncomingBuffer.writeIdx;
 
-    return uMsg_Ok;
+    if(writeIdx - uIncomingBuffer.readIdx >= MESSAGE_IN_ARRAY_LENGTH) {
+        uIncomingBuffer.dropCount++;
+        return NULL;
+    }
+
+    return uIncomingBuffer.msgBuff + (writeIdx & MSG_IN_INDEX_MASK);
 }
 
+static void uMsgInCommit(void)
+{
+    uint8_t waiting;
+
+    uIncomingBuffer.rxTimeUs[uIncomingBuffer.writeIdx & MSG_IN_INDEX_MASK] = uTimeGetUs();
+
+    // The slot content must be visible before the consumer can see the new index.
+    __DMB();
+    uIncomingBuffer.writeIdx++;
+
+    waiting = (uint8_t)(uIncomingBuffer.writeIdx - uIncomingBuffer.readIdx);
+    if(waiting > uIncomingBuffer.highWater) {
+        uIncomingBuffer.highWater = waiting;
+    }
+}
+
+static uint8_t uMsgInPutError(Urabros_MsgPtr slotPtr, Urabros_MsgStatus error)
+{
+    if(slotPtr == NULL) {
+        slotPtr = uMsgInAcquire();
+        if(slotPtr == NULL) {
+            return 0;
+        }
+    }
+
+    slotPtr->dataLen = 2;
+    slotPtr->crcLen  = 0;
+    slotPtr->data[0] = uCommand_RECEIVE_ERROR;
+    slotPtr->data[1] = error;
+    uMsgInCommit();
+    return 1;
+}
+
+static void uMsgInPublishFromISR(uint8_t idleLine)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    uint16_t writePos;
+    uProfileBegin(uProfile_MSG_PUT_FROM_DMA);
+
+    // Only publish the position, the frames are processed by the parser thread.
+    writePos = DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(MESSAGE_UART_MAIN.hdmarx);
+    if(writePos >= DMA_RX_BUFFER_SIZE) {
+        writePos = 0;
+    }
+    // The half and full transfer interrupts come twice in a round, so the DMA can't move a whole round between two calls.
+    dmaRxTotal   += (uint16_t)(writePos + DMA_RX_BUFFER_SIZE - dmaRxWritePos) % DMA_RX_BUFFER_SIZE;
+    dmaRxWritePos = writePos;
+    dmaRxIdle     = idleLine;
+    dmaRxTimeUs   = uTimeGetUsFromISR();
+    xSemaphoreGiveFromISR(uParserSemaphore, &higherPriorityTaskWoken);
+    uProfileEnd(uProfile_MSG_PUT_FROM_DMA);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+}
 
 Urabros_MsgStatus uMsgPutFromDMA(void)
 {
-    static uint8_t first = 1;
-    if(first) {
-        first = 0;
-        return uMsg_Ok;
-    }
-
-    Urabros_Msg tempMsg = {0};
-    static uint8_t old_pos;
-    static uint8_t tempRxBuffer[MESSAGE_BUFFER_LENGTH + 3];
-    uint16_t pos;
-    uint16_t recDataLen;
-    Urabros_MsgStatus status = uMsg_Ok;
-    /* Calculate current position in buffer */
-    pos = DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER(MESSAGE_UART_MAIN.hdmarx);
-
-
-    if (pos != old_pos) {                       /* Check change in received data */
-        if (pos > old_pos) {                    /* Current position is over previous one */
-            /* We are in "linear" mode */
-            /* Process data directly by subtracting "pointers" */
-
-            // Length of data received
-            recDataLen = pos - old_pos;
-
-            // Minimum received data length size is 4 --> | datalen | commandID | CRC 1 | CRC 2 |
-            if(recDataLen < 4) {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMSg_IdleError;
-                uMsgInPut(&tempMsg);
-                status = uMSg_IdleError;
-                goto end;
-            }
+    uMsgInPublishFromISR(1);
 
-            if(recDataLen - 3 != dmaRxBuffer[old_pos]) {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMsg_DataLenError;
-                uMsgInPut(&tempMsg);
-                status = uMsg_DataLenError;
-                goto end;
-            }
+    return uMsg_Ok;
+}
 
-            // Fill temp message
-            tempMsg.dataLen = dmaRxBuffer[old_pos];
-            for(uint8_t i = 0; i < (recDataLen - 3); i++) {
-                tempMsg.data[i] = dmaRxBuffer[old_pos + 1 + i];
-            }
-            tempMsg.crc16Code += (uint16_t)dmaRxBuffer[pos - 2] << 8;
-            tempMsg.crc16Code += dmaRxBuffer[pos - 1];
+uint8_t uMsgInProcess(void)
+{
+    uint8_t     committed   = 0;
+    uint16_t    writePos;
+    uint32_t    total;
+    uint8_t     idleLine;
+    uint16_t    chunk;
+    uint8_t     byte;
+    TickType_t  timeout     = portMAX_DELAY;
+
+    // If a frame is half received, wait only a limited time for the rest of it.
+    if(uParser.state != uParserWaitLength) {
+        timeout = pdMS_TO_TICKS(MESSAGE_RX_FRAME_TIMEOUT);
+    }
 
-            if(uMsgCheckCrc(&tempMsg) == uMsg_Ok) {
-                status = uMsgInPut(&tempMsg);
-            } else {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMsg_CrcError;
-                uMsgInPut(&tempMsg);
-                status = uMsg_CrcError;
-            }
+    if(xSemaphoreTake(uParserSemaphore, timeout) != pdTRUE) {
+        // The transmission broke while sending a frame, drop the part we have got. After an error the silence ends the skipping.
+        if(uParser.state != uParserSkip) {
+            committed += uMsgInPutError(uParser.slotPtr, uMSg_IdleError);
+        }
+        uParser.slotPtr = NULL;
+        uParser.state   = uParserWaitLength;
+        return committed;
+    }
 
+    taskENTER_CRITICAL();
+    writePos = dmaRxWritePos;
+    total    = dmaRxTotal;
+    idleLine = dmaRxIdle;
+    taskEXIT_CRITICAL();
+
+    if(total - uParser.consumed >= DMA_RX_BUFFER_SIZE) {
+        // The DMA lapped the parser, the frame boundaries are lost. The current frame is dropped without commit.
+        uParser.overrunCount++;
+        uParser.slotPtr = NULL;
+        uParser.state   = uParserSkip;
+    }
+    uParser.consumed = total;
 
-        } else {
-            /* We are in "overflow" mode */
+    while(uParser.readPos != writePos) {
 
-            //easy way:
-            uint16_t recDataLenPart1 = DMA_RX_BUFFER_SIZE - old_pos;
-            uint16_t recDataLenPart2 = pos;
-            recDataLen = recDataLenPart1 + recDataLenPart2;
+        if(uParser.state == uParserSkip) {
+            // Nothing is processed until the line is idle, see after the loop.
+            uParser.readPos = writePos;
+            break;
+        }
 
-            if(recDataLen < 4) {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMSg_IdleError;
-                uMsgInPut(&tempMsg);
-                status = uMSg_IdleError;
-                status = uMSg_IdleError;
-                goto end;
+        if(uParser.state == uParserData) {
+            // Copy as much data as possible in one step directly to the slot.
+            if(writePos > uParser.readPos) {
+                chunk = writePos - uParser.readPos;
+            } else {
+                chunk = DMA_RX_BUFFER_SIZE - uParser.readPos;
             }
-
-            if(recDataLen - 3 != dmaRxBuffer[old_pos]) {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMsg_DataLenError;
-                uMsgInPut(&tempMsg);
-                status = uMsg_DataLenError;
-                goto end;
+            if(chunk > uParser.dataLen - uParser.received) {
+                chunk = uParser.dataLen - uParser.received;
             }
 
-            memcpy(tempRxBuffer, dmaRxBuffer + old_pos, recDataLenPart1);
-            /* Check and continue with beginning of buffer */
-            if (recDataLenPart2 > 0) {
-                memcpy(tempRxBuffer + DMA_RX_BUFFER_SIZE - old_pos, dmaRxBuffer, recDataLenPart2);
+            // The CRC is calculated even for a dropped frame, so an emergency stop is recognized when the queue is full.
+            if(uParser.received == 0) {
+                uParser.firstByte = dmaRxBuffer[uParser.readPos];
             }
-
-            // Fill temp message
-            tempMsg.dataLen = tempRxBuffer[0];
-            for(uint16_t i = 0; i < recDataLen - 3; i++) {
-                tempMsg.data[i] = tempRxBuffer[i + 1];
+            if(uParser.slotPtr != NULL) {
+                memcpy(uParser.slotPtr->data + uParser.received, dmaRxBuffer + uParser.readPos, chunk);
+            }
+            uParser.crc = crc16_update(uParser.crc, dmaRxBuffer + uParser.readPos, chunk);
+            uParser.received += chunk;
+            uParser.readPos  += chunk;
+            if(uParser.readPos == DMA_RX_BUFFER_SIZE) {
+                uParser.readPos = 0;
             }
-            tempMsg.crc16Code += (uint16_t)tempRxBuffer[recDataLen - 2] << 8;
-            tempMsg.crc16Code += tempRxBuffer[recDataLen - 1];
 
-            if(uMsgCheckCrc(&tempMsg) == uMsg_Ok) {
-                status = uMsgInPut(&tempMsg);
-            } else {
-                tempMsg.dataLen = 2;
-                tempMsg.data[0] = uCommand_RECEIVE_ERROR;
-                tempMsg.data[1] = uMsg_CrcError;
-                uMsgInPut(&tempMsg);
-                status = uMsg_CrcError;
+            if(uParser.received == uParser.dataLen) {
+                uParser.state = uParserCrcHigh;
             }
+            continue;
         }
-    }
 
-end:
-    old_pos = pos;                              /* Save current position as old */
+        byte = dmaRxBuffer[uParser.readPos];
+        uParser.readPos++;
+        if(uParser.readPos == DMA_RX_BUFFER_SIZE) {
+            uParser.readPos = 0;
+        }
+
+        switch(uParser.state) {
+            case uParserWaitLength :
+                // Minimum data length is 1 --> | datalen | commandID | CRC 1 | CRC 2 |
+                if(byte == 0 || byte > MESSAGE_BUFFER_LENGTH) {
+                    // Only one error is reported for a run of garbage, the rest is dropped until the line is idle.
+                    committed += uMsgInPutError(NULL, uMsg_DataLenError);
+                    uParser.state = uParserSkip;
+                    break;
+                }
+
+                // The frame is assembled directly in the incoming buffer, if it is full the frame is dropped.
+                uParser.slotPtr     = uMsgInAcquire();
+                uParser.dataLen     = byte;
+                uParser.received    = 0;
+                uParser.crc         = CRC_START_MODBUS;
+                uParser.state       = uParserData;
+                if(uParser.slotPtr != NULL) {
+                    uParser.slotPtr->dataLen = byte;
+                }
+                break;
+
+            case uParserCrcHigh :
+                uParser.rxCrc = (uint16_t)byte << 8;
+                uParser.state = uParserCrcLow;
+                break;
+
+            case uParserCrcLow :
+                uParser.rxCrc += byte;
+                // The emergency stop doesn't wait in the queue, the outputs are stopped here.
+                if(uParser.dataLen == 1 && uParser.firstByte == uCommand_EMERGENCY_STOP && uParser.crc == uParser.rxCrc) {
+                    uEmergencyStopTrigger(dmaRxTimeUs);
+                }
+                if(uParser.slotPtr != NULL) {
+                    // The CRC was calculated while copying, only the compare is left.
+                    uParser.slotPtr->crc16Code  = uParser.rxCrc;
+                    uParser.slotPtr->crcLen     = 0;
+                    if(uParser.crc == uParser.rxCrc) {
+                        uParser.slotPtr->crcLen = uParser.dataLen;
+                        uMsgInCommit();
+                        committed++;
+                    } else {
+                        committed += uMsgInPutError(uParser.slotPtr, uMsg_CrcError);
+                    }
+                }
+                uParser.slotPtr = NULL;
+                uParser.state   = uParserWaitLength;
+                break;
 
-    /* Check and manually update if we reached end of buffer */
-    if (old_pos == DMA_RX_BUFFER_SIZE) {
-        old_pos = 0;
+            default :
+                uParser.state   = uParserWaitLength;
+                break;
+        }
+    }
+
+    // The line was silent after the last byte, so the next byte starts a new frame.
+    if(idleLine && uParser.state == uParserSkip) {
+        uParser.state = uParserWaitLength;
     }
-    return status;
+
+    return committed;
 }
 
 /**
   * @param  UART_HandleTypeDef *huart - pointer to the uart handler
   * @return void -
   * @brief This function is depending on the communication peripheral
+  *        The DMA reached the end of the circular buffer, the parser is woken up,
+  *        so a continuous stream without IDLE line can not overrun the not processed bytes.
   * @note This function is called by HAL.
 */
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
     if(huart == MESSAGE_UART_MAIN_PTR)
     {
-        //TODO: some code here if we want to send signal to a message handler!
-        /*
-        for(uint8_t i = 0; i < 10; i++) {
-            dprint("dma full interrupt\n");
-            if(HAL_UART_Receive_DMA(MESSAGE_UART_MAIN_PTR, dmaRxBuffer, DMA_RX_BUFFER_SIZE) == HAL_OK) {
-                break;
-            }
-        }
-        */
+        uMsgInPublishFromISR(0);
+    }
+}
+
+/**
+  * @param  UART_HandleTypeDef *huart - pointer to the uart handler
+  * @return void -
+  * @brief This function is depending on the communication peripheral
+  *        The DMA reached the half of the circular buffer, the parser is woken up.
+  * @note This function is called by HAL.
+*/
+void HAL_UART_RxHalfCpltCallback(UART_HandleTypeDef *huart)
+{
+    if(huart == MESSAGE_UART_MAIN_PTR)
+    {
+        uMsgInPublishFromISR(0);
     }
 }
 
 
 void uMsgInPrintBuffer()
 {
-    for(uint16_t i = 0; i < uIncomingBuffer.numOfMsg; i++) {
-        dprintln("IN Index: %d", i);
-        uMsgPrint(uIncomingBuffer.msgBuff + i);
+    for(uint32_t i = uIncomingBuffer.readIdx; i != uIncomingBuffer.writeIdx; i++) {
+        dprintln("IN Index: %d", (int)(i & MSG_IN_INDEX_MASK));
+        uMsgPrint(uIncomingBuffer.msgBuff + (i & MSG_IN_INDEX_MASK));
     }
 }
 
@@ -6,10 +6,14 @@
   * @brief  IncomingMessageHandler is responsible for handling the incoming message queue.
   *
   *         Uart currently works on DMA mode, there are a lot of different detection types for ensure secure communication.
-  *         There is IDLE line detection, with this we dont have to count the number of bytes arriving and assembly the message,
-  *         we just wait for the idle interrupt. That on;ly fires when a data transmission ended, after that happens we call the
-  *         @see uMsgPutFromDMA() function, and it handles the rest.
-  *         The Uart must be configured to DMA mode and enable global interrupt for it in CUBE MX
+  *         The DMA writes the incoming bytes to a circular buffer. On IDLE line, half and full DMA transfer the interrupt only
+  *         publishes the position of the DMA and wakes up the parser thread, @see uMsgPutFromDMA().
+  *         The parser thread calls @see uMsgInProcess(), it walks through the new bytes, assembles the frames, checks the CRC
+  *         and puts the messages to the incoming fifo. So a frame can arrive in more parts, and more frames can arrive in one burst.
+  *         After a wrong length byte only one #uMsg_DataLenError is reported, the parser drops the bytes until the line is idle.
+  *         If the DMA laps the parser the not processed bytes are lost, it is counted and the parser waits for the idle line too.
+  *         The Uart must be configured to DMA mode and enable global interrupt for it in CUBE MX, the priority of the
+  *         interrupts must not be higher than configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY.
   *         Here is where and how to call the uMsgPutFromDMA function:
   *         stm32xxxx_it.c
   *         void USARTX_IRQHandler(void)
@@ -32,7 +36,24 @@
 */
 Urabros_StatusTypeDef uMsgInInit();
 
-/** Pops the last message from the #uIncomingBuffer
+/** Gives back the oldest message waiting in the #uIncomingBuffer by reference, without copying it.
+ *  The message stays in the buffer until @see uMsgInRelease() is called, so the pointed slot can be processed in place.
+ *  Only the UrabrosMaster.c is allowed to call it, because the buffer has only one consumer.
+ *  @return Returns a pointer to the oldest message, or NULL if the buffer is empty.
+ */
+Urabros_MsgPtr uMsgInPeek(void);
+
+/** Gives back when the message got by @see uMsgInPeek() was assembled by the parser.
+ *  @return The time in microseconds, see @see uTimeGetUs().
+ */
+uint32_t uMsgInPeekTimestamp(void);
+
+/** Releases the oldest message of the #uIncomingBuffer, what was got by @see uMsgInPeek().
+ *  After this call the slot can be filled again by the receive path, so the pointer must not be used anymore.
+ */
+void uMsgInRelease(void);
+
+/** Pops the oldest message from the #uIncomingBuffer (First in first out)
  *  @param uMsgPtr This is a pointer to an #Urabros_Msg variable.\n
  *                 If the pop sucseeded than it will load the correct values to the pointer variable.\n
  *                 If the queue was empty it will not make any modifications on the pointed variable.
@@ -40,25 +61,42 @@ Urabros_StatusTypeDef uMsgInInit();
  */
 Urabros_MsgStatus uMsgInPop(Urabros_MsgPtr uMsgPtr);
 
+/** Gives back the statistics of the #uIncomingBuffer.
+ *  @param dropCount Loaded with the number of messages dropped because the buffer was full. Can be NULL.
+ *  @param highWater Loaded with the maximum number of messages were waiting at the same time. Can be NULL.
+ *  @param overrunCount Loaded with the number of times the DMA overwrote not processed bytes. Can be NULL.
+ */
+void uMsgInGetStats(uint32_t *dropCount, uint8_t *highWater, uint32_t *overrunCount);
+
 /**
-  * @brief  Puts a message received by Uart to the incoming queue.
-  * 
+  * @brief  Publishes the position of the DMA and wakes up the parser thread.
+  *         It has to be called from the IDLE line interrupt, it does not process the received bytes.
+  * @return #uMsg_Ok
+*/
+Urabros_MsgStatus uMsgPutFromDMA(void);
+
+/**
+  * @brief  Processes the bytes received since the last call and puts the assembled messages to the incoming queue.
+  *
+  *         It blocks until the interrupt signals new bytes. If a frame is half received it waits only #MESSAGE_RX_FRAME_TIMEOUT ms.
   *         It makes different checks on the message, and depending on them it creates and puts a message to the queue:
   *         - If everything is ok than the received message is placed to the buffer
   *         - If Idle Error happend (The sending got interupted, and message broke appart)
   *         ---- data[0]: uCommand_RECEIVE_ERROR
   *         ---- data[1]: uMSg_IdleError
-  *         - If Data len doesnt match:
+  *         - If Data len is not valid (the parser skips the byte and tries to find the next frame):
   *         ---- data[0]: uCommand_RECEIVE_ERROR
   *         ---- data[1]: uMsg_DataLenError
   *         - If CRC is not correct:
   *         ---- data[0]: uCommand_RECEIVE_ERROR
   *         ---- data[1]: uMsg_CrcError
-  * @return Depending on the process it returns, #uMsg_Ok, #uMSg_IdleError, #uMsg_DataLenError, #uMsg_CrcError but theese are not needed to be handled in the interrupt.
+  *         The message is assembled directly in the slot of the incoming fifo, if there is no free slot it is dropped and counted.
+  *         Only the parser thread is allowed to call it, it is the only producer of the incoming fifo.
+  * @return The number of messages put to the incoming queue.
 */
-Urabros_MsgStatus uMsgPutFromDMA(void);
+uint8_t uMsgInProcess(void);
 
-/** A debug function, prints all the element int the outgoing queue on human readeable format to debug line.
+/** A debug function, prints all the element int the incoming queue on human readeable format to debug line.
  */
 void uMsgInPrintBuffer();
 
@@ -0,0 +1,137 @@
+/**
+ * @file     uLinkScheduler.c
+ * @author   Marton.Lorinczi
+ * @date     Oct 17, 2026
+ *
+ * @brief  LinkScheduler shares the UART between the command responses, the task data and the debug messages.
+ *         Further informations in the header file.
+ */
+#include "uLinkScheduler.h"
+#include "uMessageCommon.h"
+#include "uOutgoingMessageHandler.h"
+#include "uDebugPrint.h"
+#include "task.h"
+
+#if (LINK_QUANTUM_RESPONSE <= 0) || (LINK_QUANTUM_TASK_DATA <= 0) || (LINK_QUANTUM_DEBUG <= 0)
+    #error "The quantums of the link scheduler must be bigger than 0"
+#endif
+
+/** Bytes a stream can send in one round, in #Urabros_LinkStreamTypeDef order.
+ */
+static const int32_t uLinkQuantum[uLinkStream_Count] = {
+    LINK_QUANTUM_RESPONSE,
+    LINK_QUANTUM_TASK_DATA,
+    LINK_QUANTUM_DEBUG,
+};
+
+static int32_t uLinkCredit[uLinkStream_Count];              /**< Bytes the streams can still send in this round, only the sender thread uses it.*/
+static Urabros_LinkStatsTypeDef uLinkStats[uLinkStream_Count]; /**< Counters of the streams, the drops are collected at query.*/
+
+/** Collects which streams have something to send.
+ *  @return Bit mask, bit n is set if stream n is waiting.
+ */
+static uint8_t uLinkPendingMask(void)
+{
+    uint8_t mask = 0;
+    uint8_t waiting;
+
+    for(uint8_t lane = 0; lane < uMsgOutPrio_Count; lane++) {
+        uMsgOutGetStats((Urabros_MsgOutPriorityTypeDef)lane, NULL, &waiting, NULL);
+        if(waiting) {
+            mask |= 1 << lane;
+        }
+    }
+    if(uDebugPrintPending()) {
+        mask |= 1 << uLinkStream_Debug;
+    }
+    return mask;
+}
+
+Urabros_StatusTypeDef uLinkSchedInit(void)
+{
+    for(uint8_t stream = 0; stream < uLinkStream_Count; stream++) {
+        uLinkCredit[stream]         = 0;
+        uLinkStats[stream].bytes    = 0;
+        uLinkStats[stream].frames   = 0;
+        uLinkStats[stream].drops    = 0;
+    }
+    return uStatusOk;
+}
+
+Urabros_LinkStreamTypeDef uLinkSchedNext(void)
+{
+    uint8_t                     mask = uLinkPendingMask();
+    Urabros_LinkStreamTypeDef   best;
+
+    if(!mask) {
+        return uLinkStream_Count;
+    }
+
+    for(;;) {
+        best = uLinkStream_Count;
+        for(uint8_t stream = 0; stream < uLinkStream_Count; stream++) {
+            if(!(mask & (1 << stream))) {
+                // An idle stream can't save up credit.
+                uLinkCredit[stream] = 0;
+                continue;
+            }
+            // On equal credit the lower stream wins, so the responses go first.
+            if(uLinkCredit[stream] > 0 && (best == uLinkStream_Count || uLinkCredit[stream] > uLinkCredit[best])) {
+                best = (Urabros_LinkStreamTypeDef)stream;
+            }
+        }
+        if(best != uLinkStream_Count) {
+            return best;
+        }
+
+        // Every waiting stream used up its credit, start a new round.
+        for(uint8_t stream = 0; stream < uLinkStream_Count; stream++) {
+            if(mask & (1 << stream)) {
+                uLinkCredit[stream] += uLinkQuantum[stream];
+            }
+        }
+    }
+}
+
+void uLinkSchedSent(Urabros_LinkStreamTypeDef stream, uint16_t len)
+{
+    if(stream >= uLinkStream_Count) {
+        return;
+    }
+
+    uLinkCredit[stream] -= len;
+    taskENTER_CRITICAL();
+    uLinkStats[stream].bytes += len;
+    uLinkStats[stream].frames++;
+    taskEXIT_CRITICAL();
+}
+
+void uLinkGetStats(Urabros_LinkStreamTypeDef stream, Urabros_LinkStatsPtrTypeDef statsPtr)
+{
+    if(stream >= uLinkStream_Count) {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    *statsPtr = uLinkStats[stream];
+    taskEXIT_CRITICAL();
+
+    if(stream == uLinkStream_Debug) {
+        statsPtr->drops = uDebugPrintGetLost();
+    } else {
+        uMsgOutGetStats((Urabros_MsgOutPriorityTypeDef)stream, &statsPtr->drops, NULL, NULL);
+    }
+}
+
+void uLinkCreateStatsResponse(Urabros_MsgPtr uTxPtr)
+{
+    Urabros_LinkStatsTypeDef stats;
+
+    uMsgAppend(uTxPtr, uLinkStream_Count);
+    for(uint8_t stream = 0; stream < uLinkStream_Count; stream++) {
+        uLinkGetStats((Urabros_LinkStreamTypeDef)stream, &stats);
+        uMsgAppend32(uTxPtr, stats.bytes);
+        uMsgAppend32(uTxPtr, stats.frames);
+        uMsgAppend32(uTxPtr, stats.drops);
+    }
+}
@@ -0,0 +1,58 @@
+/**
+  * @file     uLinkScheduler.h
+  * @author   Marton.Lorinczi
+  * @date     Oct 17, 2026
+  *
+  * @brief  LinkScheduler shares the UART between the streams: command responses, task data and debug messages.
+  *
+  *         Every stream has a quantum in bytes (#LINK_QUANTUM_RESPONSE, #LINK_QUANTUM_TASK_DATA, #LINK_QUANTUM_DEBUG).
+  *         It works as a deficit round robin: in every round the waiting streams get their quantum as credit,
+  *         the stream with the most credit sends the next frame, and the length of the frame is taken from its credit.
+  *         A stream with nothing to send loses its credit, so it can't save up bandwidth for a burst.
+  *         If all the streams are busy they get the line in the ratio of their quantums, if only one is busy it gets the whole line.
+  *
+  *         A response waits at most for the frame on the line, one debug frame is at most #DPRINT_TX_CHUNK_SIZE long,
+  *         one task data frame is at most one super-frame.
+  *
+  *         Usage in the sender thread:
+  *         stream = uLinkSchedNext();              // Which stream sends now
+  *         ... build and start the frame of the stream ...
+  *         uLinkSchedSent(stream, frameLen);       // Charge the stream
+  *
+  *         Only the UrabrosMaster.c is allowed to use this module.
+  */
+
+#ifndef MASTER_COMMUNICATION_ULINKSCHEDULER_H_
+#define MASTER_COMMUNICATION_ULINKSCHEDULER_H_
+
+#include "UrabrosTypeDef.h"
+
+/** Initialize the credits and the counters of the streams.
+ *  @return #uStatusOk
+ */
+Urabros_StatusTypeDef uLinkSchedInit(void);
+
+/** Selects the stream what can send the next frame. Only the sender thread is allowed to call it.
+ *  @return The selected stream, or #uLinkStream_Count if there is nothing to send.
+ */
+Urabros_LinkStreamTypeDef uLinkSchedNext(void);
+
+/** Charges the stream with the frame it sent, and counts the frame.
+ *  @param stream The stream what sent the frame.
+ *  @param len Length of the frame in bytes.
+ */
+void uLinkSchedSent(Urabros_LinkStreamTypeDef stream, uint16_t len);
+
+/** Gives back the counters of a stream.
+ *  @param stream The stream.
+ *  @param statsPtr Loaded with the counters.
+ */
+void uLinkGetStats(Urabros_LinkStreamTypeDef stream, Urabros_LinkStatsPtrTypeDef statsPtr);
+
+/** Builds the answer of the #uCommand_GET_LINK_STATS command, all numbers are big endian:\n
+ *  | 0x09 | stream count | bytes 4 byte | frames 4 byte | drops 4 byte | ... for every stream in #Urabros_LinkStreamTypeDef order.
+ *  @param uTxPtr The answer, the command byte must be already in it.
+ */
+void uLinkCreateStatsResponse(Urabros_MsgPtr uTxPtr);
+
+#endif /* MASTER_COMMUNICATION_ULINKSCHEDULER_H_ */
@@ -22,12 +22,28 @@
  *  without using crc calculation and other stuffs. This method needed multiple functions from multiple files, and avoiding
  *  too much header includes, I just used the extern keyword, if you come up with a better solution dont hesitate to tell it to the owner of the framework :)
  */
-extern Urabros_MsgStatus uMsgOutPut(Urabros_MsgPtr uMsgPtr);
+extern Urabros_MsgStatus uMsgOutPutPriority(Urabros_MsgPtr uMsgPtr, Urabros_MsgOutPriorityTypeDef prio, TickType_t timeout);
+
+/** Updates the running CRC of the message with the bytes appended since the last update.
+ *  If the CRC is not a running one, it starts it from the beginning.
+ *  @param uMsgPtr The pointed message.
+ */
+static void uMsgUpdateCrc(Urabros_MsgPtr uMsgPtr)
+{
+    if(!uMsgPtr->crcLen || uMsgPtr->crcLen > uMsgPtr->dataLen) {
+        uMsgPtr->crc16Code  = CRC_START_MODBUS;
+        uMsgPtr->crcLen     = 0;
+    }
+
+    uMsgPtr->crc16Code  = crc16_update(uMsgPtr->crc16Code, uMsgPtr->data + uMsgPtr->crcLen, uMsgPtr->dataLen - uMsgPtr->crcLen);
+    uMsgPtr->crcLen     = uMsgPtr->dataLen;
+}
 
 void uMsgReset(Urabros_MsgPtr uMsgTarget)
 {
     uMsgTarget->dataLen    = 0;
     uMsgTarget->crc16Code  = 0;
+    uMsgTarget->crcLen     = 0;
     memset(uMsgTarget->data, 0x00, MESSAGE_BUFFER_LENGTH);
 }
 
@@ -35,7 +51,9 @@ void uMsgCopy(Urabros_MsgPtr uMsgTarget, Urabros_MsgPtr uMsgBase)
 {
    uMsgTarget->dataLen      = uMsgBase->dataLen;
    uMsgTarget->crc16Code    = uMsgBase->crc16Code;
-   memcpy(uMsgTarget->data, uMsgBase->data, MESSAGE_BUFFER_LENGTH);
+   uMsgTarget->crcLen       = uMsgBase->crcLen;
+   // Only the valid part of the data is copied, the rest of the target buffer is not touched.
+   memcpy(uMsgTarget->data, uMsgBase->data, uMsgBase->dataLen);
 }
 
 Urabros_MsgStatus uMsgCheckCrc(Urabros_MsgPtr uMsgPtr)
@@ -54,7 +72,8 @@ void uMsgSetCrc(Urabros_MsgPtr uMsgPtr)
     if(!uMsgPtr->dataLen)
         return;
 
-    uMsgPtr->crc16Code = crc_modbus(uMsgPtr->data, uMsgPtr->dataLen);
+    // The appends already calculated their bytes, only the directly written ones are left.
+    uMsgUpdateCrc(uMsgPtr);
 }
 
 Urabros_MsgStatus uMsgAppend(Urabros_MsgPtr uMsgPtr, uint8_t data)
@@ -65,7 +84,21 @@ Urabros_MsgStatus uMsgAppend(Urabros_MsgPtr uMsgPtr, uint8_t data)
 
     uMsgPtr->data[uMsgPtr->dataLen] = data;
     uMsgPtr->dataLen++;
+    uMsgUpdateCrc(uMsgPtr);
+
+    return uMsg_Ok;
+}
+
+Urabros_MsgStatus uMsgAppend32(Urabros_MsgPtr uMsgPtr, uint32_t value)
+{
+    if(uMsgPtr->dataLen + 4 > MESSAGE_BUFFER_LENGTH) {
+        return uMsg_BufferIsFull;
+    }
 
+    uMsgAppend(uMsgPtr, value >> 24);
+    uMsgAppend(uMsgPtr, value >> 16);
+    uMsgAppend(uMsgPtr, value >> 8);
+    uMsgAppend(uMsgPtr, value);
     return uMsg_Ok;
 }
 
@@ -80,6 +113,7 @@ Urabros_MsgStatus uMsgAppendBuffer(Urabros_MsgPtr uMsgPtr, uint8_t *buff, uint8_
 
     // Increment the datalen index with bufflen
     uMsgPtr->dataLen += buffLen;
+    uMsgUpdateCrc(uMsgPtr);
 
     return uMsg_Ok;
 }
@@ -110,6 +144,7 @@ Urabros_MsgStatus uMsgAppendBufferFromTask(Urabros_TaskPtrTypeDef uTaskPtr, Urab
 
     // Increment the datalen index with bufflen
     uMsgPtr->dataLen += buffLen;
+    uMsgUpdateCrc(uMsgPtr);
 
     return uMsg_Ok;
 }
@@ -138,8 +173,8 @@ Urabros_MsgStatus uMsgSendMessageFromTask(Urabros_TaskPtrTypeDef uTaskPtr, uint8
     // Set the CRC code
     tempMessage.crc16Code = crc_modbus(tempMessage.data, tempMessage.dataLen);
 
-    //Put it to the outgoing queue
-    return uMsgOutPut(&tempMessage);
+    //Put it to the outgoing queue, if it is full wait for the sender.
+    return uMsgOutPutPriority(&tempMessage, uMsgOutPrio_Bulk, pdMS_TO_TICKS(MESSAGE_OUT_TASK_TIMEOUT));
 }
 
 void uMsgPrint(Urabros_MsgPtr uMsgPtr)
@@ -22,6 +22,7 @@ void uMsgReset(Urabros_MsgPtr uMsgPtr);
 
 /**
   * @brief  Copies the Base Urabros_Msg to the Target
+  *         Only the first dataLen bytes of the data buffer are copied.
   * @param  uMsgTarget - Target of the copy function
   * @param  uMsgBase - Base of the copy function
 */
@@ -29,6 +30,9 @@ void uMsgCopy(Urabros_MsgPtr uMsgTarget, Urabros_MsgPtr uMsgBase);
 
 /**
   * @brief  Calculates and sets the Crc filed of the gien #Urabros_Msg
+  *
+  *         The uMsgAppend functions calculate the CRC while appending, so this only finishes the not calculated part.
+  *         If the data was modified directly, not by the uMsgAppend functions, set the crcLen field to 0 before calling it.
   * @param  uMsgPtr - The pointed message.
 */
 void uMsgSetCrc(Urabros_MsgPtr uMsgPtr);
@@ -51,6 +55,15 @@ Urabros_MsgStatus uMsgCheckCrc(Urabros_MsgPtr uMsgPtr);
 */
 Urabros_MsgStatus uMsgAppend(Urabros_MsgPtr uMsgPtr, uint8_t data);
 
+/**
+  * @brief  Appends the pointed #Urabros_Msg with a 32 bit number in big endian.
+  * @param  uMsgPtr - The pointed message.
+  * @param  value - The number to be added to the message's buffer.
+  * @return returns #uMsg_Ok if the number was added.\n
+  *         returns #uMsg_BufferIsFull if there is no space for the 4 bytes, than nothing is added.
+*/
+Urabros_MsgStatus uMsgAppend32(Urabros_MsgPtr uMsgPtr, uint32_t value);
+
 /**
   * @brief  Appends the pointed #Urabros_Msg with the given datas. Maximum datas to be added is #MESSAGE_BUFFER_LENGTH
   * @param  uMsgPtr - The pointed message.
@@ -96,8 +109,10 @@ Urabros_MsgStatus uMsgAppendBufferFromTask(Urabros_TaskPtrTypeDef uTaskPtr, Urab
   * @param  uTaskPtr - Pointer of the caller uTask, alwazs use: &Task here.
   * @param  buff - Pointer to the databuffer where the desired datas are waiting to be added to the message.
   * @param  buffLen - How many datas to be copied from the buffer to the message's buffer.
+  *         If the outgoing queue is full, it waits #MESSAGE_OUT_TASK_TIMEOUT ms for the sender.
   * @return returns #uMsg_Ok if the data was added.\n
-  *         returns #uMsg_CopyBufferTooBig if there is no enough space in the message's buffer.
+  *         returns #uMsg_CopyBufferTooBig if there is no enough space in the message's buffer.\n
+  *         returns #uMsg_Timeout if the outgoing queue was full for #MESSAGE_OUT_TASK_TIMEOUT ms.
 */
 Urabros_MsgStatus uMsgSendMessageFromTask(Urabros_TaskPtrTypeDef uTaskPtr, uint8_t *buff, uint8_t buffLen);
 
@@ -5,7 +5,7 @@
   *
   * @brief  OutgoingMessageHandler is responsible for handling the outgoing message queue.
   * 
-  *         Only the UrabrosMaster.c is allowed to use the @see uMsgOutPop() and @see uMsgSend() functions.\n
+  *         Only the UrabrosMaster.c is allowed to use the @see uMsgOutPop(), @see uMsgOutPeek() and @see uMsgSend() functions.\n
   *         The @see uMsgOutPut() can be used from uTasks. But for easier use there are some gigher level functions for\n
   *         putting a message to the outgoing buffer.
   *         The outgoing buffer is a static variable of this source file, so it's a private variable.
@@ -14,50 +14,170 @@
 
 #include "uOutgoingMessageHandler.h"
 #include "uMessageCommon.h"
+#include "crc16.h"
+#include "UrabrosStatic.h"
 #include <usart.h>
 #include <string.h>
+#include "task.h"
 
 #define DPRINT_LOCAL_ENABLE 1
 #include "uDebugPrint.h"
 
-/** Tx buffer for outgoing messages, its size 4 byte bigger than the #MESSAGE_BUFFER_LENGTH.
- * Pos0: Message Type, #MESSAGE_URABROS or #MESSAGE_START_OF_TEXT\n
+/** Size of one Tx buffer, it has to hold an Urabros message. The debug messages are sent from their own buffers.
+ */
+#define MESSAGE_TX_SINGLE_SIZE      (MESSAGE_BUFFER_LENGTH + 4)
+
+#if MESSAGE_BATCH_ENABLE && (MESSAGE_BATCH_SIZE > MESSAGE_TX_SINGLE_SIZE)
+    #define MESSAGE_TX_BUFFER_SIZE  MESSAGE_BATCH_SIZE
+#else
+    #define MESSAGE_TX_BUFFER_SIZE  MESSAGE_TX_SINGLE_SIZE
+#endif
+
+/** The longest time in miliseconds a full Tx buffer can be on the line, with 10 bits per byte and some reserve.
+ */
+#define MESSAGE_TX_TIMEOUT          (((MESSAGE_TX_BUFFER_SIZE * 10000UL) / MESSAGE_BAUD_RATE) + 10)
+
+/** Two Tx buffers for outgoing frames, while one is sent out by the DMA the next frame is assembled in the other one.
+ * Pos0: Message Type, #MESSAGE_URABROS or #MESSAGE_URABROS_BATCH\n
  * Pos1: Datalen max value is #MESSAGE_BUFFER_LENGTH - 4\n
  * n-1: CRC16 Top 8\n
  * n: CRC16 bot 8
  */
-static uint8_t tempTxBuffer[MESSAGE_BUFFER_LENGTH + 4];
+static uint8_t txBuffer[2][MESSAGE_TX_BUFFER_SIZE];
+static uint8_t txFreeIdx = 0;                               /**< Index of the Tx buffer not used by the DMA.*/
+static volatile uint8_t txBusy = 0;                         /**< 1 while the DMA is sending out a Tx buffer.*/
+static TaskHandle_t txSenderThread = NULL;                  /**< This thread is notified on Tx complete and on new data.*/
+static Urabros_TxSegmentTypeDef txSegments[MESSAGE_TX_SEGMENT_NUM]; /**< Segments of the transfer started by @see uMsgTxStartSegments().*/
+static volatile uint8_t txSegmentNum = 0;                   /**< Number of the segments, 0 if a Tx buffer is on the line.*/
+static volatile uint8_t txSegmentIdx = 0;                   /**< Index of the segment on the line.*/
+static void (*volatile txDoneCallback)(void) = NULL;        /**< Called when the segments are sent out.*/
 static Urabros_MsgOutBuffer uOutgoinggBuffer;               /**< The outgoing buffer.*/
-static SemaphoreHandle_t mutex;                             /**< */
+static SemaphoreHandle_t mutex;                             /**< Protects the indexes of the lanes, the producers can be more tasks.*/
+#if URABROS_STATIC_ALLOCATION
+static StaticSemaphore_t uMsgOutFreeSlotsBuffer[uMsgOutPrio_Count]; /**< Storage of the free slot semaphores of the lanes.*/
+#endif
+static Urabros_MsgOutLanePtr uPeekedLanePtr = NULL;         /**< The lane of the message got by @see uMsgOutPeek(), only the consumer uses it.*/
 uint8_t *uMsgOutWaitingNumPtr = &uOutgoinggBuffer.numOfMsg; /**< Pointer to the outgoing buffers numOfMsg field, because the outgoing buffer is a private variable, with this pointer it's field can be accessed.*/
 
+/** Gives back the lane with the highest priority which has a waiting message.
+ *  It must be called with taken mutex.
+ *  @return Pointer to the lane or NULL if all the lanes are empty.
+ */
+static Urabros_MsgOutLanePtr uMsgOutFirstLane(void);
+
+/** Steps the read index of the lane, and gives back the slot to the producers.
+ *  It must be called with taken mutex.
+ *  @param lanePtr The lane to be released.
+ */
+static void uMsgOutReleaseLane(Urabros_MsgOutLanePtr lanePtr);
+
+/** Gives back the oldest message of the lane by reference, like @see uMsgOutPeek().
+ *  @param lanePtr The lane to be peeked.
+ *  @return Returns a pointer to the message, or NULL if the lane is empty.
+ */
+static Urabros_MsgPtr uMsgOutPeekLane(Urabros_MsgOutLanePtr lanePtr);
+
 Urabros_StatusTypeDef uMsgOutInit()
 {
+    Urabros_MsgOutLanePtr lanePtr;
+
     uOutgoinggBuffer.numOfMsg = 0;
-    mutex = xSemaphoreCreateMutex();
-    for(uint16_t msgIndex = 0; msgIndex < MESSAGE_OUT_ARRAY_LENGTH; msgIndex++) {
-        uMsgReset(uOutgoinggBuffer.msgBuff + msgIndex);
+    mutex = uMutexCreate();
+    for(uint8_t prio = 0; prio < uMsgOutPrio_Count; prio++) {
+        lanePtr = uOutgoinggBuffer.lane + prio;
+        lanePtr->readIdx    = 0;
+        lanePtr->writeIdx   = 0;
+        lanePtr->numOfMsg   = 0;
+        lanePtr->dropCount  = 0;
+        lanePtr->highWater  = 0;
+        lanePtr->freeSlots  = uCountingSemaphoreCreateAt(MESSAGE_OUT_ARRAY_LENGTH, MESSAGE_OUT_ARRAY_LENGTH, &uMsgOutFreeSlotsBuffer[prio]);
+        for(uint16_t msgIndex = 0; msgIndex < MESSAGE_OUT_ARRAY_LENGTH; msgIndex++) {
+            uMsgReset(lanePtr->msgBuff + msgIndex);
+        }
     }
     return uStatusOk;
 }
 
-// Take out the last message in queue ( First in last out)
+static Urabros_MsgOutLanePtr uMsgOutFirstLane(void)
+{
+    for(uint8_t prio = 0; prio < uMsgOutPrio_Count; prio++) {
+        if(uOutgoinggBuffer.lane[prio].numOfMsg) {
+            return uOutgoinggBuffer.lane + prio;
+        }
+    }
+    return NULL;
+}
+
+static void uMsgOutReleaseLane(Urabros_MsgOutLanePtr lanePtr)
+{
+    lanePtr->readIdx++;
+    if(lanePtr->readIdx == MESSAGE_OUT_ARRAY_LENGTH) {
+        lanePtr->readIdx = 0;
+    }
+    lanePtr->numOfMsg--;
+    uOutgoinggBuffer.numOfMsg--;
+    xSemaphoreGive(lanePtr->freeSlots);
+}
+
+Urabros_MsgPtr uMsgOutPeek(void)
+{
+    Urabros_MsgOutLanePtr lanePtr;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    lanePtr = uMsgOutFirstLane();
+    uPeekedLanePtr = lanePtr;
+    xSemaphoreGive(mutex);
+
+    if(lanePtr == NULL) {
+        return NULL;
+    }
+    // The producers never write the oldest slot, so it can be used without the mutex.
+    return lanePtr->msgBuff + lanePtr->readIdx;
+}
+
+static Urabros_MsgPtr uMsgOutPeekLane(Urabros_MsgOutLanePtr lanePtr)
+{
+    uint8_t numOfMsg;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    numOfMsg = lanePtr->numOfMsg;
+    uPeekedLanePtr = (numOfMsg ? lanePtr : NULL);
+    xSemaphoreGive(mutex);
+
+    if(!numOfMsg) {
+        return NULL;
+    }
+    return lanePtr->msgBuff + lanePtr->readIdx;
+}
+
+void uMsgOutRelease(void)
+{
+    if(uPeekedLanePtr == NULL) {
+        return;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    uMsgOutReleaseLane(uPeekedLanePtr);
+    uPeekedLanePtr = NULL;
+    xSemaphoreGive(mutex);
+}
+
+// Take out the oldest message with the highest priority (First in first out)
 Urabros_MsgStatus uMsgOutPop(Urabros_MsgPtr uMsgPtr)
 {
+    Urabros_MsgOutLanePtr lanePtr;
+
     xSemaphoreTake(mutex, portMAX_DELAY);
 
-    //xSemaphoreTake(uIncomingBuffer.mutex, portMAX_DELAY); //TODO TIMEOUT
-    if(!uOutgoinggBuffer.numOfMsg) {
+    lanePtr = uMsgOutFirstLane();
+    if(lanePtr == NULL) {
         xSemaphoreGive(mutex);
         return uMsg_BufferIsEmpty;
     }
 
-    // Copy the last message to the give pointed message struct.
-    uMsgCopy(uMsgPtr, uOutgoinggBuffer.msgBuff + uOutgoinggBuffer.numOfMsg - 1);
-    // Reset the message in the buffer
-    uMsgReset(uOutgoinggBuffer.msgBuff + uOutgoinggBuffer.numOfMsg - 1);
-    // Decrease the number of messages in buffer by one. So we get the index in array.
-    uOutgoinggBuffer.numOfMsg--;
+    // Copy the oldest message to the give pointed message struct.
+    uMsgCopy(uMsgPtr, lanePtr->msgBuff + lanePtr->readIdx);
+    uMsgOutReleaseLane(lanePtr);
 
     xSemaphoreGive(mutex);
     return uMsg_Ok;
@@ -66,43 +186,248 @@ Urabros_MsgStatus uMsgOutPop(Urabros_MsgPtr uMsgPtr)
 // Put a message in to the buffer
 Urabros_MsgStatus uMsgOutPut(Urabros_MsgPtr uMsgPtr)
 {
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    Urabros_MsgOutPriorityTypeDef prio = uMsgOutPrio_Response;
+
+    // Data from the tasks can wait, the responses go first.
+    if(uMsgPtr->dataLen && uMsgPtr->data[0] == uCommand_DATA_FROM_TASK) {
+        prio = uMsgOutPrio_Bulk;
+    }
+    return uMsgOutPutPriority(uMsgPtr, prio, 0);
+}
+
+Urabros_MsgStatus uMsgOutPutPriority(Urabros_MsgPtr uMsgPtr, Urabros_MsgOutPriorityTypeDef prio, TickType_t timeout)
+{
+    Urabros_MsgOutLanePtr lanePtr;
 
-    if(uOutgoinggBuffer.numOfMsg == MESSAGE_OUT_ARRAY_LENGTH) {
+    if(prio >= uMsgOutPrio_Count) {
+        return uMsg_Error;
+    }
+    lanePtr = uOutgoinggBuffer.lane + prio;
+
+    // Reserve a slot, if the lane is full wait for the sender thread at most timeout ticks.
+    if(xSemaphoreTake(lanePtr->freeSlots, timeout) != pdTRUE) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        lanePtr->dropCount++;
         xSemaphoreGive(mutex);
-        return uMsg_BufferIsFull;
+        return (timeout ? uMsg_Timeout : uMsg_BufferIsFull);
     }
 
-    uMsgCopy(uOutgoinggBuffer.msgBuff + uOutgoinggBuffer.numOfMsg, uMsgPtr);
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    uMsgCopy(lanePtr->msgBuff + lanePtr->writeIdx, uMsgPtr);
+    lanePtr->writeIdx++;
+    if(lanePtr->writeIdx == MESSAGE_OUT_ARRAY_LENGTH) {
+        lanePtr->writeIdx = 0;
+    }
+    lanePtr->numOfMsg++;
+    if(lanePtr->numOfMsg > lanePtr->highWater) {
+        lanePtr->highWater = lanePtr->numOfMsg;
+    }
     uOutgoinggBuffer.numOfMsg++;
 
     xSemaphoreGive(mutex);
+
+    uMsgTxNotify();
     return uMsg_Ok;
 }
 
+void uMsgOutGetStats(Urabros_MsgOutPriorityTypeDef prio, uint32_t *dropCount, uint8_t *waiting, uint8_t *highWater)
+{
+    if(prio >= uMsgOutPrio_Count) {
+        return;
+    }
 
-Urabros_MsgStatus uMsgSend(Urabros_MsgPtr uMsgPtr)
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    if(dropCount != NULL) {
+        *dropCount = uOutgoinggBuffer.lane[prio].dropCount;
+    }
+    if(waiting != NULL) {
+        *waiting = uOutgoinggBuffer.lane[prio].numOfMsg;
+    }
+    if(highWater != NULL) {
+        *highWater = uOutgoinggBuffer.lane[prio].highWater;
+    }
+    xSemaphoreGive(mutex);
+}
+
+
+void uMsgOutSetSenderThread(TaskHandle_t threadHandle)
 {
-    Urabros_StatusTypeDef sendStatus = uStatusOk;
-    memset(tempTxBuffer, 0x00, MESSAGE_BUFFER_LENGTH + 4);
+    txSenderThread = threadHandle;
+}
+
+void uMsgTxNotify(void)
+{
+    if(txSenderThread != NULL) {
+        xTaskNotify(txSenderThread, MESSAGE_TX_NOTIFY_DATA, eSetBits);
+    }
+}
+
+void uMsgTxNotifyFromISR(BaseType_t *higherPriorityTaskWoken)
+{
+    if(txSenderThread != NULL) {
+        xTaskNotifyFromISR(txSenderThread, MESSAGE_TX_NOTIFY_DATA, eSetBits, higherPriorityTaskWoken);
+    }
+}
+
+uint8_t* uMsgTxGetBuffer(void)
+{
+    return txBuffer[txFreeIdx];
+}
 
+uint16_t uMsgTxGetBufferSize(void)
+{
+    return MESSAGE_TX_BUFFER_SIZE;
+}
+
+uint16_t uMsgEncode(Urabros_MsgPtr uMsgPtr, uint8_t *target)
+{
     // Send the length of data
-    tempTxBuffer[0] = MESSAGE_URABROS;
-    tempTxBuffer[1] = uMsgPtr->dataLen;
+    target[0] = MESSAGE_URABROS;
+    target[1] = uMsgPtr->dataLen;
     // Copy data
-    memcpy(tempTxBuffer + 2, uMsgPtr->data, uMsgPtr->dataLen);
+    memcpy(target + 2, uMsgPtr->data, uMsgPtr->dataLen);
 
     // copy Crc code
-    tempTxBuffer[uMsgPtr->dataLen + 2] = uMsgPtr->crc16Code >> 8;
-    tempTxBuffer[uMsgPtr->dataLen + 3] = uMsgPtr->crc16Code;
+    target[uMsgPtr->dataLen + 2] = uMsgPtr->crc16Code >> 8;
+    target[uMsgPtr->dataLen + 3] = uMsgPtr->crc16Code;
+
+    return uMsgPtr->dataLen + 4;
+}
+
+uint16_t uMsgOutEncodeNext(uint8_t *target, uint16_t maxLen)
+{
+    Urabros_MsgOutLanePtr lanePtr;
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+    lanePtr = uMsgOutFirstLane();
+    xSemaphoreGive(mutex);
 
-    for(uint8_t i = 0; i < 5; i++) {
-        sendStatus = (Urabros_StatusTypeDef)HAL_UART_Transmit_DMA(MESSAGE_UART_MAIN_PTR, tempTxBuffer, uMsgPtr->dataLen + 4);
-        if(sendStatus == uStatusOk) {
-            break;
+    if(lanePtr == NULL) {
+        return 0;
+    }
+    return uMsgOutEncodeLane((Urabros_MsgOutPriorityTypeDef)(lanePtr - uOutgoinggBuffer.lane), target, maxLen);
+}
+
+uint16_t uMsgOutEncodeLane(Urabros_MsgOutPriorityTypeDef prio, uint8_t *target, uint16_t maxLen)
+{
+    Urabros_MsgOutLanePtr   lanePtr;
+    Urabros_MsgPtr          uMsgPtr;
+    uint16_t                frameLen;
+
+    if(prio >= uMsgOutPrio_Count) {
+        return 0;
+    }
+    lanePtr = uOutgoinggBuffer.lane + prio;
+    uMsgPtr = uMsgOutPeekLane(lanePtr);
+
+    if(uMsgPtr == NULL) {
+        return 0;
+    }
+
+#if MESSAGE_BATCH_ENABLE
+    uint16_t        pos         = 2;
+    uint8_t         count       = 0;
+    uint16_t        firstCrc    = uMsgPtr->crc16Code;
+    uint16_t        crc;
+
+    // Only worth packing if there is more than one message waiting.
+    if(lanePtr->numOfMsg > 1) {
+        // | MESSAGE_URABROS_BATCH | count | len 1 | data 1... | len n | data n... | CRC 1 | CRC 2 |
+        while(uMsgPtr != NULL && count < 255 && (pos + 1 + uMsgPtr->dataLen + 2) <= maxLen) {
+            target[pos] = uMsgPtr->dataLen;
+            memcpy(target + pos + 1, uMsgPtr->data, uMsgPtr->dataLen);
+            pos += uMsgPtr->dataLen + 1;
+            count++;
+            uMsgOutRelease();
+            uMsgPtr = uMsgOutPeekLane(lanePtr);
         }
+
+        if(count > 1) {
+            target[0] = MESSAGE_URABROS_BATCH;
+            target[1] = count;
+            crc = crc_modbus(target + 1, pos - 1);
+            target[pos]     = crc >> 8;
+            target[pos + 1] = crc;
+            return pos + 2;
+        }
+
+        if(count == 1) {
+            // The second one didn't fit, turn it back to a simple frame.
+            frameLen    = target[2];
+            target[0]   = MESSAGE_URABROS;
+            target[1]   = frameLen;
+            memmove(target + 2, target + 3, frameLen);
+            target[frameLen + 2] = firstCrc >> 8;
+            target[frameLen + 3] = firstCrc;
+            return frameLen + 4;
+        }
+    }
+#endif
+
+    frameLen = uMsgEncode(uMsgPtr, target);
+    // The message was copied to the Tx buffer, the slot can be reused.
+    uMsgOutRelease();
+    return frameLen;
+}
+
+Urabros_MsgStatus uMsgTxWait(TickType_t timeout)
+{
+    TickType_t startTick = xTaskGetTickCount();
+    TickType_t elapsed;
+
+    // Only the registered thread gets the Tx complete notification.
+    if(txSenderThread != xTaskGetCurrentTaskHandle()) {
+        return (txBusy ? uMsg_Busy : uMsg_Ok);
+    }
+
+    while(txBusy) {
+        elapsed = xTaskGetTickCount() - startTick;
+        if(elapsed >= timeout) {
+            return uMsg_Timeout;
+        }
+
+        // Every bit is cleared, the sender looks at the lanes again after the transfer anyway.
+        xTaskNotifyWait(0, MESSAGE_TX_NOTIFY_ALL, NULL, timeout - elapsed);
+    }
+    return uMsg_Ok;
+}
+
+void uMsgTxWaitLine(void)
+{
+    void (*doneCallback)(void);
+
+    if(uMsgTxWait(pdMS_TO_TICKS(MESSAGE_TX_TIMEOUT)) != uMsg_Ok) {
+        // The Tx complete was lost, abort the transfer so the line can be used again.
+        HAL_UART_AbortTransmit(MESSAGE_UART_MAIN_PTR);
+        doneCallback    = txDoneCallback;
+        txDoneCallback  = NULL;
+        txSegmentNum    = 0;
+        txBusy          = 0;
+        if(doneCallback != NULL) {
+            doneCallback();
+        }
+    }
+}
+
+/** Starts the DMA, if the HAL is still busy after the Tx complete its transfer is aborted and it is started again once.
+ */
+static Urabros_StatusTypeDef uMsgTxStartDMA(const uint8_t *data, uint16_t len)
+{
+    HAL_StatusTypeDef halStatus;
+
+    halStatus = HAL_UART_Transmit_DMA(MESSAGE_UART_MAIN_PTR, (uint8_t*)data, len);
+    if(halStatus == HAL_BUSY) {
+        HAL_UART_AbortTransmit(MESSAGE_UART_MAIN_PTR);
+        halStatus = HAL_UART_Transmit_DMA(MESSAGE_UART_MAIN_PTR, (uint8_t*)data, len);
     }
+    return (Urabros_StatusTypeDef)halStatus;
+}
 
+/** Converts the HAL status to #Urabros_MsgStatus.
+ */
+static Urabros_MsgStatus uMsgTxStatus(Urabros_StatusTypeDef sendStatus)
+{
     switch (sendStatus) {
     case uStatusOk :
         return uMsg_Ok;
@@ -113,16 +438,117 @@ Urabros_MsgStatus uMsgSend(Urabros_MsgPtr uMsgPtr)
     default:
         return uMsg_Error;
     }
+}
+
+Urabros_MsgStatus uMsgTxStartSegments(const Urabros_TxSegmentTypeDef *segments, uint8_t num, void (*doneCallback)(void))
+{
+    Urabros_StatusTypeDef sendStatus = uStatusOk;
+
+    if(!num || num > MESSAGE_TX_SEGMENT_NUM) {
+        return uMsg_Error;
+    }
+
+    uMsgTxWaitLine();
 
+    memcpy(txSegments, segments, num * sizeof(Urabros_TxSegmentTypeDef));
+    txSegmentIdx    = 0;
+    txSegmentNum    = num;
+    txDoneCallback  = doneCallback;
+    txBusy          = 1;
+    sendStatus = uMsgTxStartDMA(txSegments[0].data, txSegments[0].len);
+    if(sendStatus != uStatusOk) {
+        // The segments are dropped, the callback frees their memory.
+        txDoneCallback  = NULL;
+        txSegmentNum    = 0;
+        txBusy          = 0;
+        if(doneCallback != NULL) {
+            doneCallback();
+        }
+    }
+
+    return uMsgTxStatus(sendStatus);
+}
+
+Urabros_MsgStatus uMsgTxStart(uint16_t len)
+{
+    Urabros_StatusTypeDef sendStatus = uStatusOk;
+
+    // The previous frame has to leave the line first.
+    uMsgTxWaitLine();
+
+    txBusy = 1;
+    sendStatus = uMsgTxStartDMA(txBuffer[txFreeIdx], len);
+    if(sendStatus != uStatusOk) {
+        txBusy = 0;
+    } else {
+        // The other buffer can be filled while this one is on the line.
+        txFreeIdx ^= 1;
+    }
+
+    return uMsgTxStatus(sendStatus);
+}
+
+Urabros_MsgStatus uMsgSend(Urabros_MsgPtr uMsgPtr)
+{
+    return uMsgTxStart(uMsgEncode(uMsgPtr, uMsgTxGetBuffer()));
+}
+
+/**
+  * @param  UART_HandleTypeDef *huart - pointer to the uart handler
+  * @return void -
+  * @brief This function is depending on the communication peripheral
+  *        The DMA finished sending out a Tx buffer, the sender thread can start the next one.
+  * @note This function is called by HAL.
+*/
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    void (*doneCallback)(void);
+
+    if(huart == MESSAGE_UART_MAIN_PTR)
+    {
+        // Chain the next segment, the line stays busy.
+        if(txSegmentNum) {
+            txSegmentIdx++;
+            if(txSegmentIdx < txSegmentNum &&
+               HAL_UART_Transmit_DMA(huart, (uint8_t*)txSegments[txSegmentIdx].data, txSegments[txSegmentIdx].len) == HAL_OK) {
+                return;
+            }
+            txSegmentNum    = 0;
+            doneCallback    = txDoneCallback;
+            txDoneCallback  = NULL;
+            if(doneCallback != NULL) {
+                doneCallback();
+            }
+        }
+
+        txBusy = 0;
+        if(txSenderThread != NULL) {
+            xTaskNotifyFromISR(txSenderThread, MESSAGE_TX_NOTIFY_DONE, eSetBits, &higherPriorityTaskWoken);
+            portYIELD_FROM_ISR(higherPriorityTaskWoken);
+        }
+    }
 }
 
 void uMsgInPrintOuttBuffer()
 {
+    Urabros_MsgOutLanePtr lanePtr;
+    uint8_t idx;
+
     xSemaphoreTake(mutex, portMAX_DELAY);
     dprintln("Outgoing Buffer size: %d", uOutgoinggBuffer.numOfMsg);
-    for(uint16_t i = 0; i < uOutgoinggBuffer.numOfMsg; i++) {
-        dprintln("Index: %d", i);
-        uMsgPrint(uOutgoinggBuffer.msgBuff + i);
+    for(uint8_t prio = 0; prio < uMsgOutPrio_Count; prio++) {
+        lanePtr = uOutgoinggBuffer.lane + prio;
+        dprintln("Lane: %d size: %d dropped: %d", prio, lanePtr->numOfMsg, lanePtr->dropCount);
+        idx = lanePtr->readIdx;
+        for(uint8_t i = 0; i < lanePtr->numOfMsg; i++) {
+            dprintln("Index: %d", idx);
+            uMsgPrint(lanePtr->msgBuff + idx);
+            idx++;
+            if(idx == MESSAGE_OUT_ARRAY_LENGTH) {
+                idx = 0;
+            }
+        }
     }
     xSemaphoreGive(mutex);
-}
\ No newline at end of file
+}
@@ -5,26 +5,38 @@
   *
   * @brief  OutgoingMessageHandler is responsible for handling the outgoing message queue.
   * 
-  *         Only the UrabrosMaster.c is allowed to use the @see uMsgOutPop() and @see uMsgSend() functions.\n
+  *         Only the UrabrosMaster.c is allowed to use the @see uMsgOutPop(), @see uMsgOutPeek() and @see uMsgSend() functions.\n
   *         The @see uMsgOutPut() can be used from uTasks. But for easier use there are some gigher level functions for\n
   *         putting a message to the outgoing buffer.
+  *         The outgoing buffer has a fifo lane for every priority class (#Urabros_MsgOutPriorityTypeDef).
+  *         The command responses and statuses are always sent before the data from the tasks, inside a lane the order is kept.
   */
 
 #ifndef MASTER_COMMUNICATION_UOUTGOINGMESSAGEHANDLER_H_
 #define MASTER_COMMUNICATION_UOUTGOINGMESSAGEHANDLER_H_
 
 #include "UrabrosTypeDef.h"
+#include "task.h"
+
+/** Maximal number of segments of one transfer started by @see uMsgTxStartSegments().
+ */
+#define MESSAGE_TX_SEGMENT_NUM      16
+
+/* Notification bits of the sender thread, it sleeps until one of them is set */
+#define MESSAGE_TX_NOTIFY_DATA      (1UL << 0)      /**< A message was put to a lane or a debug message was written*/
+#define MESSAGE_TX_NOTIFY_DONE      (1UL << 1)      /**< The Tx complete freed the line*/
+#define MESSAGE_TX_NOTIFY_ALL       0xFFFFFFFFUL    /**< Mask for clearing all the notification bits*/
 
 extern uint8_t* uMsgOutWaitingNumPtr; /**< Extern variable for showing that there is at least one message waiting in the outgoing queue*/
 
-/** Initilaize the outgoing message queue, and creates the mutex.\n
- *  The Queue works as a FILO (First in Last out).
+/** Initilaize the outgoing message queue, creates the mutex and the free slot semaphores of the lanes.\n
+ *  Every lane works as a FIFO (First in First out).
  *  @return Returns #uStatusOk  
  */
 Urabros_StatusTypeDef uMsgOutInit();
 
-// Take out the last message in queue ( First in last out)
-/** Pops the last message from the #uOutgoinggBuffer
+// Take out the oldest message with the highest priority ( First in first out)
+/** Pops the oldest message of the highest priority lane from the #uOutgoinggBuffer
  *  @param uMsgPtr This is a pointer to an #Urabros_Msg variable.\n
  *                 If the pop sucseeded than it will load the correct values to the pointer variable.\n
  *                 If the queue was empty it will not make any modifications on the pointed variable.
@@ -32,16 +44,133 @@ Urabros_StatusTypeDef uMsgOutInit();
  */
 Urabros_MsgStatus uMsgOutPop(Urabros_MsgPtr uMsgPtr);
 
+/** Gives back the message what would be popped next by reference, without copying it.
+ *  The message stays in the buffer until @see uMsgOutRelease() is called. The buffer has only one consumer the sender thread.
+ *  @return Returns a pointer to the message, or NULL if the queue is empty.
+ */
+Urabros_MsgPtr uMsgOutPeek(void);
+
+/** Releases the message what was got by @see uMsgOutPeek(), after this the pointer must not be used anymore.
+ */
+void uMsgOutRelease(void);
+
 // Put a message in to the buffer
-/** Puts an #Urabros_Msg tot the outgoing queue.
+/** Puts an #Urabros_Msg to the outgoing queue, it never blocks.
+ *  The messages with #uCommand_DATA_FROM_TASK type go to the #uMsgOutPrio_Bulk lane, all the others to the #uMsgOutPrio_Response lane.
  *  @param uMsgPtr The pointer to the message we want to put into the queue.
- *  @returnReturns #uMsg_Ok if it went well, returns #uMsg_BufferIsFull if the queue was full. If this happens oftenly than the processing time is not fast enough.
+ *  @return Returns #uMsg_Ok if it went well, returns #uMsg_BufferIsFull if the lane was full. If this happens oftenly than the processing time is not fast enough.
  */
 Urabros_MsgStatus uMsgOutPut(Urabros_MsgPtr uMsgPtr);
 
+/** Puts an #Urabros_Msg to the given lane of the outgoing queue.
+ *  If the lane is full it waits for a free slot at most timeout ticks, so the producer can be slowed down to the speed of the line.
+ *  @param uMsgPtr The pointer to the message we want to put into the queue.
+ *  @param prio The priority class of the message.
+ *  @param timeout How many ticks to wait for a free slot, 0 means it doesn't block, portMAX_DELAY means it waits forever.
+ *  @return Returns #uMsg_Ok if it went well\n
+ *          #uMsg_BufferIsFull if the lane was full and timeout was 0\n
+ *          #uMsg_Timeout if there was no free slot in timeout ticks\n
+ *          #uMsg_Error if the priority is not valid.
+ */
+Urabros_MsgStatus uMsgOutPutPriority(Urabros_MsgPtr uMsgPtr, Urabros_MsgOutPriorityTypeDef prio, TickType_t timeout);
+
+/** Gives back the statistics of one lane of the outgoing queue.
+ *  @param prio The priority class of the lane.
+ *  @param dropCount Loaded with the number of messages refused because the lane was full. Can be NULL.
+ *  @param waiting Loaded with the number of messages currently waiting in the lane. Can be NULL.
+ *  @param highWater Loaded with the maximum number of messages waited in the lane at the same time. Can be NULL.
+ */
+void uMsgOutGetStats(Urabros_MsgOutPriorityTypeDef prio, uint32_t *dropCount, uint8_t *waiting, uint8_t *highWater);
+
+/** Registers the thread what sends out the frames, it is notified from HAL_UART_TxCpltCallback() and by the producers.
+ *  @param threadHandle Handle of the sender thread.
+ */
+void uMsgOutSetSenderThread(TaskHandle_t threadHandle);
+
+/** Wakes up the sender thread with #MESSAGE_TX_NOTIFY_DATA, it is called after a message or a debug message was written.
+ *  It can't be called from an interrupt, see @see uMsgTxNotifyFromISR().
+ */
+void uMsgTxNotify(void);
+
+/** Interrupt version of @see uMsgTxNotify().
+ *  @param higherPriorityTaskWoken Set to pdTRUE if the sender thread has to run, like at the FromISR functions of FreeRTOS.
+ */
+void uMsgTxNotifyFromISR(BaseType_t *higherPriorityTaskWoken);
+
+/** Gives back the Tx buffer not used by the DMA, the next frame can be assembled in it while the other one is on the line.
+ *  Only the sender thread is allowed to use it.
+ *  @return Pointer to the free Tx buffer, its size is @see uMsgTxGetBufferSize().
+ */
+uint8_t* uMsgTxGetBuffer(void);
+
+/** @return The size of one Tx buffer in bytes.
+ */
+uint16_t uMsgTxGetBufferSize(void);
+
+/** Assembles the frame of an #Urabros_Msg: | #MESSAGE_URABROS | datalen | data... | CRC 1 | CRC 2 |
+ *  @param uMsgPtr pointer to the message we want to send out
+ *  @param target pointer to the Tx buffer, usually got by @see uMsgTxGetBuffer()
+ *  @return The length of the frame.
+ */
+uint16_t uMsgEncode(Urabros_MsgPtr uMsgPtr, uint8_t *target);
+
+/** Moves the next waiting messages of the highest priority lane from the outgoing queue to the target Tx buffer.
+ *  If #MESSAGE_BATCH_ENABLE is set and more messages are waiting, it packs as many of them as fit in maxLen to one super-frame:\n
+ *  | #MESSAGE_URABROS_BATCH | count | len 1 | data 1... | len n | data n... | CRC 1 | CRC 2 |\n
+ *  The CRC16 Modbus is calculated from the count byte to the end of the last data.
+ *  Otherwise the next message is assembled as a simple frame with @see uMsgEncode().
+ *  Only the sender thread is allowed to call it.
+ *  @param target pointer to the Tx buffer, usually got by @see uMsgTxGetBuffer()
+ *  @param maxLen size of the Tx buffer
+ *  @return The length of the frame, 0 if the queue was empty.
+ */
+uint16_t uMsgOutEncodeNext(uint8_t *target, uint16_t maxLen);
+
+/** Same as @see uMsgOutEncodeNext() but it takes messages only from the given lane, so a super-frame never mixes the lanes.
+ *  The link scheduler uses it to share the line between the lanes, see at uLinkScheduler.h.
+ *  Only the sender thread is allowed to call it.
+ *  @param prio The priority class of the lane.
+ *  @param target pointer to the Tx buffer, usually got by @see uMsgTxGetBuffer()
+ *  @param maxLen size of the Tx buffer
+ *  @return The length of the frame, 0 if the lane was empty or the priority is not valid.
+ */
+uint16_t uMsgOutEncodeLane(Urabros_MsgOutPriorityTypeDef prio, uint8_t *target, uint16_t maxLen);
+
+/** Waits until the DMA finishes sending out the previous Tx buffer, the thread sleeps until the Tx complete notification.
+ *  Only the thread registered by @see uMsgOutSetSenderThread() gets the notification, the other threads don't wait.
+ *  @param timeout How many ticks to wait at most.
+ *  @return #uMsg_Ok if the line is free, #uMsg_Timeout if the DMA is still busy,
+ *          #uMsg_Busy if the line is busy and the caller is not the sender thread.
+ */
+Urabros_MsgStatus uMsgTxWait(TickType_t timeout);
+
+/** Waits until the line is free with @see uMsgTxWait(), if the Tx complete was lost the transfer is aborted.
+ *  @see uMsgTxStart() calls it too, the sender thread calls it before to keep the wait out of its probe.
+ */
+void uMsgTxWaitLine(void);
+
+/** Sends out the free Tx buffer got by @see uMsgTxGetBuffer() using the HAL_UART_Transmit_DMA() function.
+ *  If the previous frame is still on the line it waits for its Tx complete first, then it swaps the buffers.
+ *  If the HAL is still busy the transfer is aborted and started again once, the frame is not kept for retrying.
+ *  @param len The length of the frame in the Tx buffer.
+ *  @return #uMsg_Ok - if it went well\n
+ *          #uMsg_Error - If hardware error happened with HAL_UART_Transmit_DMA.\n
+ *          #uMsg_Busy - If the DMA peripheral is busy sending out the previously data.
+ */
+Urabros_MsgStatus uMsgTxStart(uint16_t len);
+
 // Send the message via DMA
-/** Sends out the given #Urabros_Msg using the HAL_UART_Transmit_DMA() function.
- *  IT tries to send out the data 5 times.
+/** Sends out more pieces of memory after each other without copying them to a Tx buffer.
+ *  The next segment is started by the Tx complete interrupt, the doneCallback is called from the interrupt
+ *  after the last one, or when the transfer is aborted or it can't be started. The segments must stay valid until then.
+ *  @param segments Array of the segments, it is copied.
+ *  @param num Number of the segments, maximum #MESSAGE_TX_SEGMENT_NUM.
+ *  @param doneCallback Called when the memory of the segments can be reused, it can be NULL.
+ *  @return #uMsg_Ok if the first segment was started.
+ */
+Urabros_MsgStatus uMsgTxStartSegments(const Urabros_TxSegmentTypeDef *segments, uint8_t num, void (*doneCallback)(void));
+
+/** Assembles the given #Urabros_Msg in the free Tx buffer and sends it out with @see uMsgTxStart().
  *  @param uMsgPtr pointer to the message we want to send out
  *  @return #uMsg_Ok - if it went well\n
  *          #uMsg_Error - If hardware error happened with HAL_UART_Transmit_DMA.\n
@@ -4,16 +4,15 @@
   * @date     Aug 10, 2020
   *
   * @brief  Main logic part of the framework.
-  *         There are four important parts of this source file.
+  *         There are three important parts of this source file.
   *         @see UrabrosInit() \n
   *             Creates the uTasks array where all of the tasks pointers are stored.
   *             Calls all the necessary inits for communication handlings.
-  *             Creates the three main threads.
+  *             Creates the main threads.
   *         @see urabrosCommunicationFunction() \n
   *             Thread responsible for handling the incoming messages.
   *             It can adds commands to thecommand list, starts the tasks, delete command form the list, and stop the tasks.
-  *         @see urabrosLogicControlFunction() \n
-  *             This thread updates the statuses of the active commands, based on the statuses of the running tasks.
+  *             The statuses of the active commands are read directly from the status words of the tasks.
   *         @see urabrosMessageSenderFunction() \n
   *             This function is responsible for sending any kind of messages to the controller PC.
   */
@@ -25,6 +24,14 @@
 #include "uOutgoingMessageHandler.h"
 #include "uCommandHandler.h"
 #include "uMessageCommon.h"
+#include "crc16.h"
+#include "uBulkTransfer.h"
+#include "uLinkScheduler.h"
+#include "UrabrosEmergencyStop.h"
+#include "UrabrosDiagnostics.h"
+#include "UrabrosProfile.h"
+#include "UrabrosStatic.h"
+#include "string.h"
 
 // Debug Print
 #if DPRINT_ENABLE
@@ -36,6 +43,7 @@
 // Timeout
 #define TIMEOUT_INSTANCES 2
 #include "UrabrosTimeout.h"
+#include "UrabrosTime.h"
 
 #include "UrabrosTaskIncluder.h"
 
@@ -48,20 +56,67 @@
  */
 static Urabros_TaskPtrTypeDef getTaskById(Urabros_CommandIdTypedef respId);
 
-/** Static function for sending uint8_t datas to the given uTask.
+/** Static function for checking if there is an enabled uTask with the given ID.
+ *  @param  respId the task ID you want to check.
+ *  @return 1 if the task exists, 0 if it is #TASK_ID_NONE or it is not in the #uTasks array.
+ */
+static uint8_t isTaskIDValid(Urabros_CommandIdTypedef respId);
+
+/** Static function for building the #uTaskById table from the #uTasks array.\n
+ *  It has to be called after the init functions of the uTasks, because they set the IDs.
+ *  @param
+ *  @return
+ */
+static void urabrosBuildTaskIndex(void);
+
+/** Static function for sending a payload to the data channel of the given uTask, it is copied into the next free slot.
  *  @param  taskPtr pointer to the task
  *  @param dataPtr pointer to the data buffer.
- *  @param dataLen length of the data to be sent to the task
- *  @return returns #uStatusOk if it is done, returns  #uStatusError if the queue is full.
+ *  @param dataLen length of the data to be sent to the task, it can't be more than the slot size of the task.
+ *  @return returns #uStatusOk if it is done, returns  #uStatusError if all the slots are waiting.
  */
 static Urabros_StatusTypeDef uSendDataToTask(Urabros_TaskPtrTypeDef taskPtr, uint8_t *dataPtr, uint8_t dataLen);
 
+/** Static function for sending a signal to the given uTask, it sets the notification bit of the signal on the first thread of the task.
+ *  @param  taskPtr pointer to the task
+ *  @param signal the signal, see at #Urabros_SignalMasterTypeDef
+ *  @return returns #uStatusOk if it is done, returns  #uStatusError if the task has no thread.
+ */
+static Urabros_StatusTypeDef uSendSignalToTask(Urabros_TaskPtrTypeDef taskPtr, uint32_t signal);
+
+/** Static function for pausing an uTask, it sends the #uSignalStop signal.
+ *  The task parks itself at its next safe point and its status goes to #uTaskStatusStopped, see at @see uTaskPausePoint().
+ *  @param  taskPtr pointer to the task
+ *  @return #uCommandOk if it is paused or it was already paused, #uCommandError if the task has no thread.
+ */
+static Urabros_CommandReturnStatus urabrosPauseTask(Urabros_TaskPtrTypeDef taskPtr);
+
+/** Static function for resuming an uTask paused by @see urabrosPauseTask(), it sends the #uSignalResume signal.
+ *  The task sets back its status itself.
+ *  @param  taskPtr pointer to the task
+ *  @return #uCommandOk if it is resumed or it was not paused, #uCommandError if the task has no thread.
+ */
+static Urabros_CommandReturnStatus urabrosResumeTask(Urabros_TaskPtrTypeDef taskPtr);
+
+/** Static function, wakes up the communication thread to send a #uCommand_STATUS_NOTIFY message if the PC subscribed to them.
+ *  @param
+ *  @return
+ */
+static void urabrosStatusChanged(void);
+
 /** Static function, creates a statusresponse message from the current status and errorCodes of the uTasks.
  *  @param  uTxPtr pointer to the outgoing message
  *  @return
  */
 static void urabrosCreateStatusResponse(Urabros_MsgPtr uTxPtr);
 
+/** Static function, sends #uCommand_STATUS_NOTIFY messages with the tasks whose status changed since the last call.
+ *  More messages are sent if the changes don't fit in one.
+ *  @param  sendAll if it is 1 all the tasks are sent, it is used at subscription.
+ *  @return
+ */
+static void urabrosSendStatusNotify(uint8_t sendAll);
+
 /** Static function for adding all the uTasks set to #uTaskMode_Continious mode to the command list.\n
  *  This function is called once at the init phase, do not call it again.
  *  @param
@@ -71,22 +126,23 @@ static void urabrosAddContiniousTasksToCommandList(void);
 
 /* LOCAL VARIABLES */
 Urabros_TaskPtrTypeDef uTasks[TASK_COUNT];   /**< This variable holds all of the #Urabros_TaskPtrTypeDef pointers, whom are pointing to all the uTasks*/
-const uint8_t signalStart   = uSignalStart;         /**< Signal variable for starting an uTask*/
-const uint8_t signalACK     = uSignalACK;           /**< Signal variable for sending ACK to uTask*/
-const uint8_t signalData    = uSignalSendData;      /**< Signal variable for determine sending, this is not used at the moment.*/
-const uint8_t signalStop    = uSignalStop;          /**< Signal variable for sending Stop to uTask, this is not implmented jet.*/
-const uint8_t signalResume  = uSignalResume;        /**< Signal variable for sending Resume to uTask, this is not implmented jet.*/
-const uint8_t* const start  = &signalStart;         /**< Pointer to start signal*/
-const uint8_t* const end    = &signalACK;           /**< Pointer to ack signal*/
-const uint8_t* const data   = &signalData;          /**< Pointer to send datasignal*/
-const uint8_t* const stop   = &signalStop;          /**< Pointer to stop signal*/
-const uint8_t* const resume = &signalResume;        /**< Pointer to resumesignal*/
+static Urabros_TaskPtrTypeDef uTaskById[256];       /**< The uTask pointers by their ID, NULL if there is no task with that ID. Built once at init*/
+static volatile uint8_t urabrosStatusSubscribed = 0; /**< 1 if the PC asked for #uCommand_STATUS_NOTIFY messages*/
+static uint32_t urabrosStatusSeq[TASK_COUNT];       /**< Sequence number of the last notified status of the tasks in #uTasks order, only the communication thread uses it*/
+
+
+/* URABROS DIAGNOSTICS */
+static Urabros_ProcessTimeDiagTypeDef urabrosProcessTime = {0};  /**< Command processing time counters, only the communication thread writes it*/
 
+/* URABROS NOTIFICATION BITS */
+#define URABROS_NOTIFY_MSG_IN   (1UL << 0)  /**< The parser put new messages to the incoming queue*/
+#define URABROS_NOTIFY_STATUS   (1UL << 1)  /**< A task published a new status, see at @see UrabrosPublishTaskStatus()*/
+#define URABROS_NOTIFY_ALL      0xFFFFFFFFUL /**< Mask for clearing all the notification bits*/
 
 /* URABROS THREADS */
 osThreadId urabrosCommunicationId;  /**< Thread def for FreeRTOS*/
-osThreadId urabrosLogicControlId;   /**< Thread def for FreeRTOS*/
 osThreadId urabrosMessageSenderId;  /**< Thread def for FreeRTOS*/
+osThreadId urabrosMessageParserId;  /**< Thread def for FreeRTOS*/
 
 /** Thread function prototype for handling incoming commands from driving PC or MC.
  *  @param  argunents arguments to the thread we pass NULL theese cases.
@@ -94,17 +150,17 @@ osThreadId urabrosMessageSenderId;  /**< Thread def for FreeRTOS*/
  */
 void urabrosCommunicationFunction(void const *argument);
 
-/** Thread function prototype for updating the command statuses, depending on the uTasks statuses
+/** Thread function prototype for sending out the uMessages and DebugMessages.
  *  @param  argunents arguments to the thread we pass NULL theese cases.
  *  @return
  */
-void urabrosLogicControlFunction(void const *argument);
+void urabrosMessageSenderFunction(void const *argument);
 
-/** Thread function prototype for sending out the uMessages and DebugMessages.
+/** Thread function prototype for assembling the incoming messages from the received bytes.
  *  @param  argunents arguments to the thread we pass NULL theese cases.
  *  @return
  */
-void urabrosMessageSenderFunction(void const *argument);
+void urabrosMessageParserFunction(void const *argument);
 
 // Thread definitions
 /** Mcaro define for register the thread for FreeRTOS.
@@ -114,7 +170,7 @@ void urabrosMessageSenderFunction(void const *argument);
  *  @param instances instances of the thread, usually we use 1
  *  @param stacksz srack size, if you goes to a problem when the software stops running usually the stack size is too small.
  */
-osThreadDef(urabrosCommunication,   urabrosCommunicationFunction,   osPriorityAboveNormal,  1, configMINIMAL_STACK_SIZE * 2);
+uThreadDef(urabrosCommunication,   urabrosCommunicationFunction,   osPriorityAboveNormal,  1, configMINIMAL_STACK_SIZE * 2);
 
 /** Mcaro define for register the thread for FreeRTOS.
  *  @param name name of the thread it has to be individual for all the threads. 
@@ -123,7 +179,7 @@ osThreadDef(urabrosCommunication,   urabrosCommunicationFunction,   osPriorityAb
  *  @param instances instances of the thread, usually we use 1
  *  @param stacksz srack size, if you goes to a problem when the software stops running usually the stack size is too small.
  */
-osThreadDef(urabrosLogicControl,    urabrosLogicControlFunction,    osPriorityNormal,  1, configMINIMAL_STACK_SIZE * 2);
+uThreadDef(urabrosMessageSender,   urabrosMessageSenderFunction,   osPriorityAboveNormal,  1, configMINIMAL_STACK_SIZE * 2);
 
 /** Mcaro define for register the thread for FreeRTOS.
  *  @param name name of the thread it has to be individual for all the threads. 
@@ -132,7 +188,7 @@ osThreadDef(urabrosLogicControl,    urabrosLogicControlFunction,    osPriorityNo
  *  @param instances instances of the thread, usually we use 1
  *  @param stacksz srack size, if you goes to a problem when the software stops running usually the stack size is too small.
  */
-osThreadDef(urabrosMessageSender,   urabrosMessageSenderFunction,   osPriorityAboveNormal,  1, configMINIMAL_STACK_SIZE * 2);
+uThreadDef(urabrosMessageParser,   urabrosMessageParserFunction,   osPriorityHigh,         1, configMINIMAL_STACK_SIZE * 2);
 
 /** Initialize all the uTasks and important threads Urabros needs.
  */
@@ -140,50 +196,89 @@ void UrabrosInit(void)
 {
     // DONT CHANGE THE ORDER OF THEESE !
 
+    // The probes can be hit from the first init
+    uProfileInit();
+
     // Message relevant inits
+    crc16_init();
     uMsgInInit();
     uMsgOutInit();
     uDebugPrintInit();
+    uBulkInit();
+    uLinkSchedInit();
 
     // Task relevant inits
     urabrosFillTasksArray();
     urabrosInitTasks();
+    urabrosBuildTaskIndex();
 
     // Command handler init
     uCommandHandlerInit();
     urabrosAddContiniousTasksToCommandList();
 
-    urabrosCommunicationId  = osThreadCreate(osThread(urabrosCommunication), NULL);
-    urabrosLogicControlId   = osThreadCreate(osThread(urabrosLogicControl), NULL);
-    urabrosMessageSenderId  = osThreadCreate(osThread(urabrosMessageSender), NULL);
+    urabrosCommunicationId  = uThreadCreate(urabrosCommunication, NULL);
+    urabrosMessageSenderId  = uThreadCreate(urabrosMessageSender, NULL);
+    urabrosMessageParserId  = uThreadCreate(urabrosMessageParser, NULL);
 
 #if DPRINT_ENABLE
+#if URABROS_STATIC_ALLOCATION
+    dprintln("Static RAM reserved: %d bytes", (int)uStaticGetReserved());
+#else
+    dprintln("Heap used: %d bytes", (int)(configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize()));
+#endif
 #endif
 
 }
 
 void urabrosCommunicationFunction(void const *argument)
 {
-    Urabros_Msg                 uMsgRx      = {0};
-    Urabros_MsgPtr              uMegRxPtr   = &uMsgRx;
+    Urabros_MsgPtr              uMegRxPtr   = NULL;
     Urabros_Msg                 uMsgTx      = {0};
     Urabros_MsgPtr              uMegTxPtr   = &uMsgTx;
-    Urabros_MsgStatus           uMsgStatus  = uMsg_Ok;
     Urabros_CommandTypedef      uCommand    = {0};
     Urabros_CommandPtrTypedef   uComandmPtr = &uCommand;
     Urabros_TaskPtrTypeDef      uTask       = NULL;
 
+    Urabros_TaskStatusTypeDef   taskStatus  = uTaskStatusSetup;
+    uint32_t                    notifyBits  = 0;
+    uint32_t                    processUs   = 0;
+    Urabros_EmergencyStopDiagTypeDef eStopDiag;
+    uint8_t                     sendAllStatus   = 0;
+    uint8_t                     statusPending   = 0;
+    TickType_t                  statusStartTick = 0;
+    TickType_t                  waitTicks       = portMAX_DELAY;
+    TickType_t                  elapsedTicks;
+
+#if CRC_BENCHMARK_ENABLE
+    crc16_benchmark_t           crcBench;
+
+    crc16_benchmark(&crcBench);
+    dprintln("CRC benchmark %d bytes", crcBench.bytes);
+    dprintln("Bytewise: %d us crc: %04X", crcBench.us_bytewise, crcBench.crc_bytewise);
+    dprintln("Slice-by-4: %d us crc: %04X", crcBench.us_slice4, crcBench.crc_slice4);
+    dprintln("Hardware: %d us crc: %04X", crcBench.us_hardware, crcBench.crc_hardware);
+#endif
+
     for(;;)
     {
-        // If an msg arrived pops it from the queue
-        uMsgStatus = uMsgInPop(uMegRxPtr);
-        if(uMsgStatus == uMsg_Ok) {
+        // Sleep until the parser signals new messages, a task changes its status or the status window ends.
+        notifyBits = 0;
+        xTaskNotifyWait(0, URABROS_NOTIFY_ALL, &notifyBits, waitTicks);
+
+        // The first status change opens the window, the later ones in the window go in the same notification.
+        if((notifyBits & URABROS_NOTIFY_STATUS) && !statusPending) {
+            statusPending   = 1;
+            statusStartTick = xTaskGetTickCount();
+        }
+
+        // Process every waiting msg in place in the incoming queue
+        while((uMegRxPtr = uMsgInPeek()) != NULL) {
 
             // Append type if command we receive
-            uMsgAppend(uMegTxPtr, uMsgRx.data[0]);
+            uMsgAppend(uMegTxPtr, uMegRxPtr->data[0]);
 
             // Swithc the command type
-            switch(uMsgRx.data[0]) {
+            switch(uMegRxPtr->data[0]) {
 
                 // Creating the status response 
                 case  uCommand_GET_STATUS :
@@ -192,8 +287,8 @@ void urabrosCommunicationFunction(void const *argument)
                     break;
 
                 case uCommand_START :
-                    uCommand.id = uMsgRx.data[1];
-                    uMsgAppend(uMegTxPtr, uMsgRx.data[1]); // Append Tx with Task ID
+                    uCommand.id = uMegRxPtr->data[1];
+                    uMsgAppend(uMegTxPtr, uMegRxPtr->data[1]); // Append Tx with Task ID
 
                     // Check if the given ID is pointing to a disabled task.
                     if(!isTaskIDValid(uCommand.id)) {
@@ -202,11 +297,12 @@ void urabrosCommunicationFunction(void const *argument)
                         break;
                     }
 
+                    uTask           = getTaskById(uCommand.id);
+                    uCommand.task   = uTask;
                     switch(uCommandAppend(uComandmPtr)) {
                         case uCommandAdded:
-                            uTask = getTaskById(uCommand.id);
-                            if(uTask->status == uTaskStatusWaitingForStartSignal) {
-                                if(uSendDataToTask(uTask, start, 1) == uStatusOk) {
+                            if(URABROS_STATUS_MAIN(uTask->statusWord) == uTaskStatusWaitingForStartSignal) {
+                                if(uSendSignalToTask(uTask, uSignalStart) == uStatusOk) {
                                     uMsgAppend(uMegTxPtr, uCommandAdded);
                                     dprintln("Command added");
                                 } else {
@@ -242,11 +338,11 @@ void urabrosCommunicationFunction(void const *argument)
                     break;
 
                 case uCommand_DELETE :
-                    uMsgAppend(uMegTxPtr, uMsgRx.data[1]); // Append Tx with Task ID
-                    switch(uCommandRemoveById((Urabros_CommandIdTypedef)uMsgRx.data[1])) {
+                    uMsgAppend(uMegTxPtr, uMegRxPtr->data[1]); // Append Tx with Task ID
+                    switch(uCommandRemoveById((Urabros_CommandIdTypedef)uMegRxPtr->data[1])) {
                         case uCommandDeleted :
                             uMsgAppend(uMegTxPtr, uCommandDeleted);
-                            uSendDataToTask(getTaskById(uMsgRx.data[1]), end, 1);
+                            uSendSignalToTask(getTaskById(uMegRxPtr->data[1]), uSignalACK);
                             dprintln("Command deleted");
                             break;
                         case uCommandNotFound :
@@ -269,8 +365,8 @@ void urabrosCommunicationFunction(void const *argument)
                     break;
 
                 case uCommand_SEND_DATA :
-                    uMsgAppend(uMegTxPtr, uMsgRx.data[1]); // Append Tx with Task ID
-                    uTask = getTaskById(uMsgRx.data[1]);
+                    uMsgAppend(uMegTxPtr, uMegRxPtr->data[1]); // Append Tx with Task ID
+                    uTask = getTaskById(uMegRxPtr->data[1]);
                     if(uTask == NULL){
                         uMsgAppend(uMegTxPtr, uCommandIdOutOfRange);
                         dprintln("Command out of range");
@@ -278,23 +374,31 @@ void urabrosCommunicationFunction(void const *argument)
                     }
 
                     // If the task is in Waiting for Start or ACK than Cant send data to it.
-                    if(uTask->status == uTaskStatusWaitingForACKSignal || uTask->status == uTaskStatusWaitingForStartSignal) {
+                    taskStatus = URABROS_STATUS_MAIN(uTask->statusWord);
+                    if(taskStatus == uTaskStatusWaitingForACKSignal || taskStatus == uTaskStatusWaitingForStartSignal) {
                         uMsgAppend(uMegTxPtr, uCommandCantReceiveData);
                         dprintln("Task cant receive data");
                         break;
                     }
 
-                    if(uSendDataToTask(uTask, uMsgRx.data + 2, uMsgRx.dataLen - 2) == uStatusOk) {
+                    // The payload must fit in one slot of the task.
+                    if(uTask->dataChannel.buffer == NULL || uMegRxPtr->dataLen <= 2 || uMegRxPtr->dataLen - 2 > uTask->dataChannel.slotSize) {
+                        uMsgAppend(uMegTxPtr, uCommandCantReceiveData);
+                        dprintln("Task cant receive this data");
+                        break;
+                    }
+
+                    if(uSendDataToTask(uTask, uMegRxPtr->data + 2, uMegRxPtr->dataLen - 2) == uStatusOk) {
                         uMsgAppend(uMegTxPtr, uStatusOk);
                         dprintln("Sent data to task")
                     } else {
                         uMsgAppend(uMegTxPtr, uCommandOwerFlow);
-                        dprintln("Queue is full")
+                        dprintln("Task data slots are full")
                     }
                     break;
 
                case uCommand_RECEIVE_ERROR :
-                   switch(uMsgRx.data[1]) {
+                   switch(uMegRxPtr->data[1]) {
                        case uMSg_IdleError :
                            uMsgAppend(uMegTxPtr, uMSg_IdleError);
                            break;
@@ -313,8 +417,67 @@ void urabrosCommunicationFunction(void const *argument)
 
                    break;
 
+                case uCommand_BULK :
+                    // The bulk protocol answers only when the sender needs it.
+                    if(!uBulkProcess(uMegRxPtr, uMegTxPtr)) {
+                        uMsgReset(uMegTxPtr);
+                    }
+                    break;
+
+                case uCommand_GET_LINK_STATS :
+                    uLinkCreateStatsResponse(uMegTxPtr);
+                    break;
+
+                case uCommand_GET_DIAGNOSTICS :
+                    uDiagCreateResponse(uMegRxPtr, uMegTxPtr);
+                    break;
+
+                case uCommand_GET_PROFILE :
+                    uProfileCreateResponse(uMegRxPtr, uMegTxPtr);
+                    break;
+
+                case uCommand_SUBSCRIBE :
+                    urabrosStatusSubscribed = (uMegRxPtr->dataLen > 1 && uMegRxPtr->data[1]);
+                    uMsgAppend(uMegTxPtr, urabrosStatusSubscribed);
+                    // The PC gets all the statuses first, after that only the changes.
+                    sendAllStatus = urabrosStatusSubscribed;
+                    dprintln("Status notification: %d", urabrosStatusSubscribed);
+                    break;
+
+                case uCommand_PAUSE :
+                case uCommand_RESUME :
+                    // The answer keeps its | command | task ID | status | layout, the missing ID is sent as 0.
+                    if(uMegRxPtr->dataLen < 2) {
+                        uMsgAppend(uMegTxPtr, 0);
+                        uMsgAppend(uMegTxPtr, uCommandError);
+                        dprintln("Task ID is missing");
+                        break;
+                    }
+
+                    uMsgAppend(uMegTxPtr, uMegRxPtr->data[1]); // Append Tx with Task ID
+                    uTask = getTaskById(uMegRxPtr->data[1]);
+                    if(uTask == NULL) {
+                        uMsgAppend(uMegTxPtr, uCommandIdOutOfRange);
+                        dprintln("Command out of range");
+                        break;
+                    }
+
+                    if(uMegRxPtr->data[0] == uCommand_PAUSE) {
+                        uMsgAppend(uMegTxPtr, urabrosPauseTask(uTask));
+                        dprintln("Task paused");
+                    } else {
+                        uMsgAppend(uMegTxPtr, urabrosResumeTask(uTask));
+                        dprintln("Task resumed");
+                    }
+                    break;
+
                 case uCommand_EMERGENCY_STOP :
-                    //TODO call emergency stop function
+                    // The parser already stopped everything, only the answer is left: | 0xFF | count 4 byte | last us 4 byte | max us 4 byte |
+                    uEmergencyStopGetDiag(&eStopDiag);
+                    uMsgAppend32(uMegTxPtr, eStopDiag.count);
+                    uMsgAppend32(uMegTxPtr, eStopDiag.lastUs);
+                    uMsgAppend32(uMegTxPtr, eStopDiag.maxUs);
+                    dprintln("Emergency stop: %d us", (int)eStopDiag.lastUs);
                     break;
 
                 default :
@@ -323,80 +486,111 @@ void urabrosCommunicationFunction(void const *argument)
 
             }
 
-            uMsgSetCrc(uMegTxPtr);
-            uMsgOutPut(uMegTxPtr);
+            if(uMegTxPtr->dataLen) {
+                uMsgSetCrc(uMegTxPtr);
+                uMsgOutPut(uMegTxPtr);
+            }
+
+            // Processing time of the command, until its response is queued
+            processUs = uTimeGetUs() - uMsgInPeekTimestamp();
+            taskENTER_CRITICAL();
+            urabrosProcessTime.lastUs   = processUs;
+            urabrosProcessTime.totalUs += processUs;
+            urabrosProcessTime.count++;
+            if(processUs > urabrosProcessTime.maxUs) {
+                urabrosProcessTime.maxUs = processUs;
+            }
+            taskEXIT_CRITICAL();
 
-            // Reset RX message and temp command
-            uMsgReset(uMegRxPtr);
+            // Release the RX message and reset the temp messages
+            uMsgInRelease();
             uMsgReset(uMegTxPtr);
             uCommandClear(uComandmPtr);
         }
-        osDelay(COMMUNICATION_DELAY);
-    }
-}
 
-void urabrosLogicControlFunction(void const *argument)
-{
-
-    static Urabros_CommandPtrTypedef cmdPtr;
-    static Urabros_TaskPtrTypeDef   taskPtr;
-
-    for(;;)
-    {
-
-        if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
-            for(uint8_t cmdIdx = 0; cmdIdx < uCommandNumber; cmdIdx++) {
-                cmdPtr = uCommandList + cmdIdx;
-                taskPtr = getTaskById(cmdPtr->id);
+        if(sendAllStatus) {
+            urabrosSendStatusNotify(1);
+            sendAllStatus = 0;
+            statusPending = 0;
+        }
 
-                if(taskPtr != NULL) {
-                    cmdPtr->status.main  = taskPtr->status;
-                    cmdPtr->status.minor = taskPtr->errorCode;
+        waitTicks = portMAX_DELAY;
+        if(statusPending) {
+            elapsedTicks = xTaskGetTickCount() - statusStartTick;
+            if(elapsedTicks >= pdMS_TO_TICKS(STATUS_NOTIFY_WINDOW)) {
+                if(urabrosStatusSubscribed) {
+                    urabrosSendStatusNotify(0);
                 }
-
+                statusPending = 0;
+            } else {
+                waitTicks = pdMS_TO_TICKS(STATUS_NOTIFY_WINDOW) - elapsedTicks;
             }
-            xSemaphoreGive(uCommandListMutex);
-        } else {
-            dprintln("Cant take mutex");
         }
-
-        osDelay(LOGIC_CONTROL_DELAY);
     }
 }
 
 void urabrosMessageSenderFunction(void const *argument)
 {
-    Urabros_Msg                 uMsgTx      = {0};
-    Urabros_MsgPtr              uMegTxPtr   = &uMsgTx;
+    uint8_t                     *txBuffPtr  = NULL;
+    uint16_t                    txLen       = 0;
+    Urabros_LinkStreamTypeDef   stream;
+#if DPRINT_ENABLE
+    Urabros_TxSegmentTypeDef    txSegments[MESSAGE_TX_SEGMENT_NUM];
+    uint8_t                     txSegmentNum = 0;
+#endif
+
+    // The producers and the Tx complete interrupt wake up this thread, see at MESSAGE_TX_NOTIFY_DATA.
+    uMsgOutSetSenderThread(xTaskGetCurrentTaskHandle());
 
     for(;;)
     {
-        while(1) {
-            // if there is an Urabros message to be sent send it.
-            if(uMsgOutPop(uMegTxPtr) == uMsg_Ok) {
-                while(1) {
-                    if(uMsgSend(uMegTxPtr) == uMsg_Ok) {
-                        break;
-                    }
-                    else {
-                        osDelay(1);
+        // The link scheduler decides which stream gets the line, see at uLinkScheduler.h
+        stream = uLinkSchedNext();
+        switch(stream) {
+
+            case uLinkStream_Response :
+            case uLinkStream_TaskData :
+            {
+                // Assemble the next frame while the previous one is still on the line,
+                // then sleep until its Tx complete and start this one at once.
+                uProfileBegin(uProfile_MSG_SEND);
+                txBuffPtr   = uMsgTxGetBuffer();
+                txLen       = uMsgOutEncodeLane((Urabros_MsgOutPriorityTypeDef)stream, txBuffPtr, uMsgTxGetBufferSize());
+                if(txLen) {
+                    // The time on the line belongs to the previous frame.
+                    uProfilePause(uProfile_MSG_SEND);
+                    uMsgTxWaitLine();
+                    uProfileResume(uProfile_MSG_SEND);
+                    if(uMsgTxStart(txLen) == uMsg_Ok) {
+                        uLinkSchedSent(stream, txLen);
                     }
+                    uProfileEnd(uProfile_MSG_SEND);
                 }
-            } else {
                 break;
             }
-            osDelay(MESSAGE_SENDING_TIME); //TODO decide is this needed or not, and think about using HAL_UART_TxCpltCallback() to determine we can send the next message or not.
-        }
 
         #if DPRINT_ENABLE
-            osDelay(1);
-            // Only enable if no Urabros message is waiting to be sent.
-            if(!(*uMsgOutWaitingNumPtr)) {
-                uDebugPrintRead();
-            }
+            case uLinkStream_Debug :
+                // The debug messages go out directly from the debug buffers, the Tx complete releases them.
+                txSegmentNum = uDebugPrintPrepare(txSegments, MESSAGE_TX_SEGMENT_NUM);
+                if(txSegmentNum) {
+                    txLen = 0;
+                    for(uint8_t segIdx = 0; segIdx < txSegmentNum; segIdx++) {
+                        txLen += txSegments[segIdx].len;
+                    }
+                    // If it can't be started the segments are released and dropped.
+                    if(uMsgTxStartSegments(txSegments, txSegmentNum, uDebugPrintRelease) == uMsg_Ok) {
+                        uLinkSchedSent(stream, txLen);
+                    }
+                }
+                break;
         #endif
 
-        osDelay(1);
+            default :
+                // Nothing to send, sleep until a producer or the Tx complete sets a notification bit.
+                xTaskNotifyWait(0, MESSAGE_TX_NOTIFY_ALL, NULL, portMAX_DELAY);
+                break;
+        }
     }
 }
 
@@ -408,55 +602,165 @@ void urabrosAddContiniousTasksToCommandList(void)
     for(uint16_t taskIndex = 0; taskIndex < TASK_COUNT; taskIndex++) {
         taskPtr = uTasks[taskIndex];
         if(taskPtr->mode == uTaskMode_Continious) {
-            tempCommand.id = taskPtr->responsibleTaskId;
+            tempCommand.id      = taskPtr->responsibleTaskId;
+            tempCommand.task    = taskPtr;
             uCommandAppend(&tempCommand);
         }
     }
 }
 
-static Urabros_TaskPtrTypeDef getTaskById(Urabros_CommandIdTypedef respId)
+static void urabrosBuildTaskIndex(void)
 {
     Urabros_TaskPtrTypeDef taskPtr = NULL;
-    for(uint8_t taskIdx = 0; taskIdx < TASK_COUNT; taskIdx++) {
+
+    memset(uTaskById, 0, sizeof(uTaskById));
+    for(uint16_t taskIdx = 0; taskIdx < TASK_COUNT; taskIdx++) {
         taskPtr = uTasks[taskIdx];
-        if(taskPtr->responsibleTaskId == respId) {
-            return taskPtr;
+        if(taskPtr != NULL && taskPtr->responsibleTaskId != TASK_ID_NONE) {
+            uTaskById[taskPtr->responsibleTaskId] = taskPtr;
         }
     }
-    return NULL;
+}
+
+static Urabros_TaskPtrTypeDef getTaskById(Urabros_CommandIdTypedef respId)
+{
+    return uTaskById[respId];
+}
+
+static uint8_t isTaskIDValid(Urabros_CommandIdTypedef respId)
+{
+    return (uTaskById[respId] != NULL);
 }
 
 Urabros_StatusTypeDef uSendDataToTask(Urabros_TaskPtrTypeDef taskPtr, uint8_t *dataPtr, uint8_t dataLen)
 {
-    xSemaphoreTake(taskPtr->mutex, portMAX_DELAY);
-    for(uint8_t dataIdx = 0; dataIdx < dataLen; dataIdx++) {
-        if(xQueueSend(taskPtr->queueMaster, dataPtr + dataIdx, portMAX_DELAY) != pdTRUE) { //TODO maybe add timeout
-            xSemaphoreGive(taskPtr->mutex);
-            return uStatusError; // Queue is full
-        }
+    Urabros_TaskDataChannelTypeDef  *chPtr = &taskPtr->dataChannel;
+    uint8_t                         *slotPtr;
+
+    // Only this thread writes the channel, the task only moves the read index forward, so no lock is needed.
+    if((uint8_t)(chPtr->writeIdx - chPtr->readIdx) >= chPtr->slotCount) {
+        return uStatusError; // All the slots are waiting
     }
 
-    xSemaphoreGive(taskPtr->mutex);
+    slotPtr = chPtr->buffer + (chPtr->writeIdx & (chPtr->slotCount - 1)) * (chPtr->slotSize + 1);
+    slotPtr[0] = dataLen;
+    memcpy(slotPtr + 1, dataPtr, dataLen);
+    chPtr->writeIdx++;
+    xSemaphoreGive(chPtr->filled);
+
     return uStatusOk;
 }
 
+Urabros_StatusTypeDef uSendSignalToTask(Urabros_TaskPtrTypeDef taskPtr, uint32_t signal)
+{
+    if(!taskPtr->threadIdArrayLen) {
+        return uStatusError;
+    }
+    xTaskNotify(taskPtr->threadIdArray[0], signal, eSetBits);
+    return uStatusOk;
+}
+
+Urabros_CommandReturnStatus urabrosPauseTask(Urabros_TaskPtrTypeDef taskPtr)
+{
+    if(!taskPtr->threadIdArrayLen) {
+        return uCommandError;
+    }
+    if(taskPtr->paused) {
+        return uCommandOk;
+    }
+
+    // The thread is not suspended from here, it could hold a mutex of the framework, it parks itself at a safe point.
+    taskPtr->paused = 1;
+    uSendSignalToTask(taskPtr, uSignalStop);
+    return uCommandOk;
+}
+
+Urabros_CommandReturnStatus urabrosResumeTask(Urabros_TaskPtrTypeDef taskPtr)
+{
+    if(!taskPtr->threadIdArrayLen) {
+        return uCommandError;
+    }
+    if(!taskPtr->paused) {
+        return uCommandOk;
+    }
+
+    // The flag is cleared first, so a task woken up by the signal doesn't park again.
+    taskPtr->paused = 0;
+    uSendSignalToTask(taskPtr, uSignalResume);
+    return uCommandOk;
+}
+
 void urabrosCreateStatusResponse(Urabros_MsgPtr uTxPtr)
 {
-    static Urabros_CommandPtrTypedef cmdPtr;
-    uint8_t cmdStatus = 0;
-
-    if (xSemaphoreTake(uCommandListMutex, COMMAND_TIMEOUT) == pdTRUE) {
-        for(uint8_t cmdIdx = 0; cmdIdx < uCommandNumber; cmdIdx++) {
-            cmdPtr      = uCommandList + cmdIdx;
-            cmdStatus   = 0;
-            cmdStatus   = cmdPtr->status.main << 5;
-            cmdStatus   |= cmdPtr->status.minor;
-            uMsgAppend(uTxPtr, cmdPtr->id);
-            uMsgAppend(uTxPtr, cmdStatus);
+    Urabros_CommandPtrTypedef cmdPtr;
+
+    // The command list is changed only by this thread, and every status word is read with one load,
+    // so the response is built without locking and it always has the latest statuses.
+    for(uint8_t cmdIdx = 0; cmdIdx < uCommandNumber; cmdIdx++) {
+        cmdPtr = uCommandList + cmdIdx;
+        uMsgAppend(uTxPtr, cmdPtr->id);
+        uMsgAppend(uTxPtr, (cmdPtr->task != NULL) ? URABROS_STATUS_BYTE(cmdPtr->task->statusWord) : 0);
+    }
+}
+
+void urabrosSendStatusNotify(uint8_t sendAll)
+{
+    Urabros_Msg             uMsg;
+    Urabros_TaskPtrTypeDef  taskPtr;
+    uint32_t                statusWord;
+
+    uMsgReset(&uMsg);
+    uMsgAppend(&uMsg, uCommand_STATUS_NOTIFY);
+    for(uint16_t taskIdx = 0; taskIdx < TASK_COUNT; taskIdx++) {
+        taskPtr     = uTasks[taskIdx];
+        statusWord  = taskPtr->statusWord;
+        if(!sendAll && URABROS_STATUS_SEQ(statusWord) == urabrosStatusSeq[taskIdx]) {
+            continue;
+        }
+        urabrosStatusSeq[taskIdx] = URABROS_STATUS_SEQ(statusWord);
+
+        // | 0x0B | id | status | ... if the next pair doesn't fit, the message goes out and a new one starts.
+        if(uMsg.dataLen + 2 > MESSAGE_BUFFER_LENGTH) {
+            uMsgSetCrc(&uMsg);
+            uMsgOutPut(&uMsg);
+            uMsgReset(&uMsg);
+            uMsgAppend(&uMsg, uCommand_STATUS_NOTIFY);
         }
-        xSemaphoreGive(uCommandListMutex);
-    } else {
-        dprintln("Cant take mutex");
+        uMsgAppend(&uMsg, taskPtr->responsibleTaskId);
+        uMsgAppend(&uMsg, URABROS_STATUS_BYTE(statusWord));
+    }
+
+    if(uMsg.dataLen > 1) {
+        uMsgSetCrc(&uMsg);
+        uMsgOutPut(&uMsg);
+    }
+}
+
+void UrabrosPublishTaskStatus(Urabros_TaskPtrTypeDef taskPtr, uint8_t mask, uint8_t value)
+{
+    uint32_t word;
+
+    taskENTER_CRITICAL();
+    word = taskPtr->statusWord;
+    word = (word & ~(uint32_t)mask) | (value & mask);
+    taskPtr->statusWord = word + URABROS_STATUS_SEQ_STEP;
+    taskEXIT_CRITICAL();
+
+    // The PC gets the change without polling if it subscribed.
+    urabrosStatusChanged();
+}
+
+void UrabrosSetAllTasksError(uint8_t errCode)
+{
+    for(uint16_t taskIdx = 0; taskIdx < TASK_COUNT; taskIdx++) {
+        UrabrosPublishTaskStatus(uTasks[taskIdx], URABROS_STATUS_BYTE_MASK, URABROS_STATUS_WORD(uTaskStatusError, errCode));
+    }
+}
+
+void urabrosStatusChanged(void)
+{
+    if(urabrosStatusSubscribed && urabrosCommunicationId != NULL) {
+        xTaskNotify(urabrosCommunicationId, URABROS_NOTIFY_STATUS, eSetBits);
     }
 }
 
@@ -470,3 +774,21 @@ void vApplicationGetIdleTaskMemory( StaticTask_t **ppxIdleTaskTCBBuffer, StackTy
   *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
   /* place for user code */
 }
+
+void urabrosMessageParserFunction(void const *argument)
+{
+    for(;;)
+    {
+        // Blocks until the UART interrupt signals new bytes, then wakes up the communication thread.
+        if(uMsgInProcess()) {
+            xTaskNotify(urabrosCommunicationId, URABROS_NOTIFY_MSG_IN, eSetBits);
+        }
+    }
+}
+
+void UrabrosGetProcessTime(Urabros_ProcessTimeDiagTypeDef *diag)
+{
+    taskENTER_CRITICAL();
+    *diag = urabrosProcessTime;
+    taskEXIT_CRITICAL();
+}
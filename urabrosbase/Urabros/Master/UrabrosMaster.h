@@ -10,10 +10,56 @@
 #ifndef MASTER_URABROSMASTER_H_
 #define MASTER_URABROSMASTER_H_
 
+#include <stdint.h>
+#include "UrabrosTypeDef.h"
+
+/** @struct Urabros_ProcessTimeDiagTypeDef
+ *  @brief Diagnostic counters of the command processing time.
+ *         It is measured from the moment the parser assembled an incoming message,
+ *         until the response was put to the outgoing queue. It is not the latency of the command:
+ *         the wait in the outgoing queue and the time on the line are not included.
+ *  @var Urabros_ProcessTimeDiagTypeDef::lastUs
+ *  Processing time of the last command in microseconds
+ *  @var Urabros_ProcessTimeDiagTypeDef::maxUs
+ *  The longest processing time in microseconds since the start
+ *  @var Urabros_ProcessTimeDiagTypeDef::totalUs
+ *  Sum of all the processing times in microseconds, divided by count gives the mean
+ *  @var Urabros_ProcessTimeDiagTypeDef::count
+ *  Number of processed commands
+ */
+typedef struct {
+    uint32_t lastUs;
+    uint32_t maxUs;
+    uint64_t totalUs;
+    uint32_t count;
+}Urabros_ProcessTimeDiagTypeDef;
+
 /** Initialize all the uTasks and important threads Urabros needs.
  *  @param
  *  @return
  */
 void UrabrosInit(void);
 
+/** Gives back a copy of the command processing time counters.
+ *  @param diag Pointer to the variable to be loaded.
+ */
+void UrabrosGetProcessTime(Urabros_ProcessTimeDiagTypeDef *diag);
+
+/** Publishes a new status byte of an uTask with an increased sequence number.
+ *  The readers get the status word with one load, so they never see a half updated status and they don't need a mutex.
+ *  The critical section only protects the read-modify-write, it is a few instructions long.\n
+ *  If the PC subscribed, the communication thread sends a #uCommand_STATUS_NOTIFY message, the changes in
+ *  #STATUS_NOTIFY_WINDOW miliseconds are sent in one message. It must not be called from an interrupt.
+ *  The uTasks call it through their status setter functions (@see uTaskSetStatus()).
+ *  @param taskPtr the uTask
+ *  @param mask the bits of the status byte to be changed
+ *  @param value the new value of the changed bits
+ */
+void UrabrosPublishTaskStatus(Urabros_TaskPtrTypeDef taskPtr, uint8_t mask, uint8_t value);
+
+/** Sets all the uTasks to #uTaskStatusError, it is called by the emergency stop.
+ *  @param errCode the minor status of the uTasks, 0 - 31
+ */
+void UrabrosSetAllTasksError(uint8_t errCode);
+
 #endif // MASTER_URABROSMASTER_H_
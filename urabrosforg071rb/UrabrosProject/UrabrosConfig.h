@@ -14,9 +14,9 @@
 
 /* URABROS COMMON DEFINES */
 #define TIMEOUT_ENABLED             1                   /**< Enable = 1 / Disable = 0 timeout function globally.*/
-#define LOGIC_CONTROL_DELAY         1000                /**< The delay in miliseconds of the refreshing loop @see urabrosLogicControlFunction() function*/
-#define COMMUNICATION_DELAY         100                 /**< The delay in miliseconds of the message handler loop @see urabrosCommunicationFunction()*/
 #define COMMAND_TIMEOUT             (TickType_t) 100    /**< The time limit in miliseconds to trying to take the #uCommandListMutex*/
+#define STATUS_NOTIFY_WINDOW        10                  /**< The task status changes are collected for this many miliseconds, than they are sent in one #uCommand_STATUS_NOTIFY message*/
+#define URABROS_STATIC_ALLOCATION   1                   /**< 1: every kernel object of the framework and the uTasks is created with static storage, see at UrabrosStatic.h. It needs configSUPPORT_STATIC_ALLOCATION 1*/
 
 /* URABROS TASK DEFINES */
 #define MAX_SUBTHREADS              2   /**< This define sets the maximum numer of subthreads per Tasks*/
@@ -47,21 +47,63 @@ typedef uint8_t Urabros_CommandIdTypedef;
 #define MESSAGE_UART_MAIN_PTR       &huart2                                                     /**< UART handler, this has to be equal what was set in the CubeMX*/
 #define MESSAGE_UART_MAIN           huart2
 #define MESSAGE_BUFFER_LENGTH       64                                                          /**< Maximal length of an incoming and outgoing #Urabros_Msg data field, this dosn't count the message length and Crc code and data type, so the actual buffer will be 4 byte longer. Maximal value is 251*/
-#define MESSAGE_IN_ARRAY_LENGTH     4                                                           /**< Size of the incoming message queue see at #Urabros_MsgInBuffer*/
-#define MESSAGE_OUT_ARRAY_LENGTH    4                                                           /**< Size of the outgoing message queue see at #Urabros_MsgOutBuffer*/
+#define MESSAGE_IN_ARRAY_LENGTH     4                                                           /**< Size of the incoming message queue see at #Urabros_MsgInBuffer, it must be a power of two*/
+#define MESSAGE_OUT_ARRAY_LENGTH    4                                                           /**< Size of one priority lane of the outgoing message queue see at #Urabros_MsgOutLane*/
+#define MESSAGE_OUT_TASK_TIMEOUT    50                                                          /**< The time in miliseconds @see uMsgSendMessageFromTask() waits for a free slot in the outgoing queue*/
 #define DMA_RX_BUFFER_MULTIPLIER    2                                                           /**< This is a security multiplier for DMA buffer size, 2 is enough, if it still overflows than the process time is too slow*/
 #define DMA_RX_BUFFER_SIZE          (MESSAGE_BUFFER_LENGTH + 4) * DMA_RX_BUFFER_MULTIPLIER      /**< Calculated define, leave it as it is. It's value: (BufferLen +Message ID + datalen + 2Crc) * security multiplie*/
+#define MESSAGE_RX_FRAME_TIMEOUT    20                                                          /**< The time in miliseconds the parser waits for the rest of a half received frame, after that it is dropped as #uMSg_IdleError*/
 #define MESSAGE_START_OF_TEXT       2                                                           /**< Define for determine debug ASCII message starting byte*/
 #define MESSAGE_END_OF_TEXT         3                                                           /**< Define for determine debug ASCII message end byte*/
+#define MESSAGE_BINARY_LOG          1                                                           /**< Define for determine binary debug log message starting byte, it is followed by a length byte*/
 #define MESSAGE_URABROS             0xFF                                                        /**< Define for determine UrabrosMessage type byte*/
-#define MESSAGE_SENDING_TIME        ((MESSAGE_BUFFER_LENGTH / (MESSAGE_BAUD_RATE / 8000)) + 10) /**< Calculated define, leave it as it is.*/
+#define MESSAGE_BATCH_ENABLE        1                                                           /**< Enable = 1 / Disable = 0 packing more waiting Urabros messages to one super-frame see at @see uMsgOutEncodeNext()*/
+#define MESSAGE_URABROS_BATCH       0xFE                                                        /**< Define for determine Urabros super-frame type byte*/
+#define MESSAGE_BATCH_SIZE          128                                                         /**< Maximal length of a super-frame in bytes, it sets the size of the Tx buffers if it is enabled. On the G071 the two Tx buffers and the debug buffers with their meta rings take about 1.7 KB, below the 2 KB of the old 1024 byte debug and 1026 byte output buffers*/
+
+/* URABROS CRC */
+#define CRC_BACKEND_SOFTWARE        0                   /**< CRC16 is calculated by the slice-by-4 table kernel*/
+#define CRC_BACKEND_HARDWARE        1                   /**< CRC16 is calculated by the CRC peripheral of the STM32*/
+#define CRC_BACKEND                 CRC_BACKEND_SOFTWARE /**< Select the CRC16 backend: #CRC_BACKEND_SOFTWARE or #CRC_BACKEND_HARDWARE*/
+#define CRC_HARDWARE_MIN_SIZE       16                  /**< Parts shorter than this are calculated by the table kernel even with #CRC_BACKEND_HARDWARE, they don't pay back the setup of the peripheral*/
+#define CRC_BENCHMARK_ENABLE        0                   /**< Enable = 1 / Disable = 0 the throughput benchmark of the CRC backends, it runs once at startup and prints the results*/
+#define CRC_BENCHMARK_SIZE          256                 /**< Size of the buffer used by the CRC benchmark*/
+#define CRC_BENCHMARK_ROUNDS        64                  /**< How many times the buffer is calculated by each backend in the CRC benchmark*/
+
+/* URABROS BULK TRANSFER */
+#define BULK_SESSION_NUM            2                   /**< How many bulk transfers can run at the same time*/
+#define BULK_WINDOW_SIZE            3                   /**< Maximal not acknowledged fragments on the line, it must be smaller than #MESSAGE_IN_ARRAY_LENGTH*/
+#define BULK_ACK_EVERY              2                   /**< The receiver acknowledges after every Nth fragment*/
+#define BULK_RETRY_TIMEOUT          100                 /**< Time in ms to wait for an ACK before the sender goes back to the first not acknowledged fragment*/
+#define BULK_MAX_RETRIES            5                   /**< The bulk transfer is aborted after this many retries without progress*/
+
+/* URABROS LINK SCHEDULER */
+#define LINK_QUANTUM_RESPONSE       128                 /**< Bytes of command responses sent in one scheduling round, the busy streams share the UART in the ratio of their quantums*/
+#define LINK_QUANTUM_TASK_DATA      96                  /**< Bytes of task data (#uCommand_DATA_FROM_TASK and bulk transfers) sent in one scheduling round*/
+#define LINK_QUANTUM_DEBUG          32                  /**< Bytes of debug messages sent in one scheduling round, one debug frame is at most #DPRINT_TX_CHUNK_SIZE long*/
+
+/* URABROS DIAGNOSTICS */
+#define DIAG_THREAD_MAX             10                  /**< Maximal number of threads in the #uCommand_GET_DIAGNOSTICS snapshot, if there are more threads the snapshot is empty. See at UrabrosDiagnostics.h*/
+
+/* URABROS PROFILING */
+#define PROFILE_ENABLE              1                   /**< Enable = 1 / Disable = 0 the execution time probes, disabled they compile to nothing. See at UrabrosProfile.h*/
+#define PROFILE_PROBE_NUM           8                   /**< Number of the probes, the first ones are used by the framework see at #Urabros_ProfileProbeTypeDef*/
+#define PROFILE_HIST_BINS           16                  /**< Number of the log2 histogram bins of one probe, the last bin counts every longer time*/
+
+/* URABROS EMERGENCY STOP */
+#define EMERGENCY_STOP_MAX_HOOKS    4                   /**< Maximal number of stop hooks, see at UrabrosEmergencyStop.h*/
 
 /* URABROS DEBUG PRINT */
 #define DPRINT_ENABLE               1       /**< Enable Debug print globally*/
 #if DPRINT_ENABLE
     #define DPRINT_LOG_TIME_GLOBAL  0       /**< Enable timestamp (Systic from the start) globally on debug messages*/
-    #define DPRINT_BUFF_SIZE        1024    /**< Size of the debug ASCII message buffer*/
+    #define DPRINT_RING_NUM         4       /**< Number of per thread debug buffers, the threads over this share one buffer protected by a critical section*/
+    #define DPRINT_RING_SIZE        128     /**< Size of one debug buffer, it must be a power of two. There are two more for the interrupts and the shared one*/
+    #define DPRINT_BUFF_SIZE        (DPRINT_RING_SIZE * (DPRINT_RING_NUM + 2)) /**< Calculated define, the size of all the debug buffers*/
     #define DPRINT_TEMP_BUFF_SIZE   60      /**< Size of one debug ASCII message*/
+    #define DPRINT_TX_CHUNK_SIZE    128     /**< Maximal number of debug characters sent out in one frame, they are sent directly from the debug buffers. It bounds the time a response waits behind the debug messages*/
+    #define DPRINT_BINARY_ENABLE    0       /**< Enable = 1 the binary debug log: dprint() stores only a format string ID, a timestamp and the raw arguments, the PC renders the text. Only integer, char and float arguments are allowed*/
+    #define DPRINT_BINARY_MAX_ARGS  6       /**< Maximal number of arguments of one binary debug log*/
     #define DPRINT_SENDING_TIME     ((DPRINT_BUFF_SIZE / (MESSAGE_BAUD_RATE / 8000)) + 10) /**< Calculated define for debug message sending timeout, leave it as it is.*/
 
     //ENABLE DEBUG TASK BY TASKS
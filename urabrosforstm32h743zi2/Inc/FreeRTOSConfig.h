@@ -134,6 +134,15 @@ standard names. */
 
 /* USER CODE BEGIN Defines */
 /* Section where parameter definitions can be added (for instance, to override default ones in FreeRTOS.h) */
+/* Thread statistics of the uCommand_GET_DIAGNOSTICS command, the run-time counter is the microsecond time of UrabrosTime.h */
+#define configUSE_TRACE_FACILITY                 1
+#define configGENERATE_RUN_TIME_STATS            1
+#define INCLUDE_uxTaskGetStackHighWaterMark      1
+#if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
+  extern uint32_t uDiagGetRunTimeCounter(void);
+#endif
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()         uDiagGetRunTimeCounter()
 /* USER CODE END Defines */
 
 #endif /* FREERTOS_CONFIG_H */
@@ -16,20 +16,18 @@ Urabros_TaskPtrTypeDef testerTaskPtr = &Task;
 #include "uDebugPrint.h"
 
 static void tester_thread_function(void const *argument);
-osThreadDef(testerThread, tester_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
+uThreadDef(testerThread, tester_thread_function, osPriorityNormal, 1, configMINIMAL_STACK_SIZE * 1);
 
 void initTesterTask(Urabros_CommandIdTypedef responsibleID)
 {
     // Init Task
     Task.mode               = uTaskMode_OneTime;
-    Task.queueMaster        = xQueueCreate(4, sizeof(uint8_t));
-    Task.queueTask          = xQueueCreate(4, sizeof(uint8_t));
+    Task.queueTask          = uQueueCreate(4, sizeof(uint8_t));
     Task.responsibleTaskId  = responsibleID;
-    Task.status             = uTaskStatusSetup;
-    Task.errorCode          = 0x00;
-    Task.mutex              = xSemaphoreCreateMutex();
+    Task.statusWord         = URABROS_STATUS_WORD(uTaskStatusSetup, 0x00);
+    Task.mutex              = uMutexCreate();
     Task.threadIdArrayLen   = 1;
-    Task.threadIdArray[0]   = osThreadCreate(osThread(testerThread), NULL);
+    Task.threadIdArray[0]   = uThreadCreate(testerThread, NULL);
 
     dprint("ID: %d - "UTASK_NAME" - Init done\n", Task.responsibleTaskId);
 }
@@ -45,6 +43,8 @@ static void tester_thread_function(void const *argument)
         }
 
         for(uint8_t i = 10; i <= 20; i++) {
+            // #uCommand_PAUSE stops the work here
+            uTaskPausePoint();
             dprintln("Test Msg: %02d", i);
             osDelay(100);
         }
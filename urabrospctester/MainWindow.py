@@ -130,6 +130,20 @@ class Ui_Form(object):
         self.SbIdSendData.setMaximum(254)
         self.SbIdSendData.setObjectName("SbIdSendData")
         self.gridLayout.addWidget(self.SbIdSendData, 3, 1, 1, 1)
+        self.PbPauseTask = QtWidgets.QPushButton(self.page)
+        self.PbPauseTask.setGeometry(QtCore.QRect(10, 185, 171, 23))
+        self.PbPauseTask.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.PbPauseTask.setObjectName("PbPauseTask")
+        self.SbIdPause = QtWidgets.QSpinBox(self.page)
+        self.SbIdPause.setGeometry(QtCore.QRect(190, 185, 171, 23))
+        self.SbIdPause.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.SbIdPause.setMinimum(1)
+        self.SbIdPause.setMaximum(254)
+        self.SbIdPause.setObjectName("SbIdPause")
+        self.PbResumeTask = QtWidgets.QPushButton(self.page)
+        self.PbResumeTask.setGeometry(QtCore.QRect(370, 185, 171, 23))
+        self.PbResumeTask.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.PbResumeTask.setObjectName("PbResumeTask")
         self.gridLayoutWidget_3 = QtWidgets.QWidget(self.page)
         self.gridLayoutWidget_3.setGeometry(QtCore.QRect(10, 219, 531, 87))
         self.gridLayoutWidget_3.setObjectName("gridLayoutWidget_3")
@@ -190,6 +204,18 @@ class Ui_Form(object):
         self.PbGetStatus.setGeometry(QtCore.QRect(930, 740, 121, 23))
         self.PbGetStatus.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
         self.PbGetStatus.setObjectName("PbGetStatus")
+        self.PbGetLinkStats = QtWidgets.QPushButton(Form)
+        self.PbGetLinkStats.setGeometry(QtCore.QRect(930, 770, 121, 23))
+        self.PbGetLinkStats.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.PbGetLinkStats.setObjectName("PbGetLinkStats")
+        self.PbDiagnostics = QtWidgets.QPushButton(Form)
+        self.PbDiagnostics.setGeometry(QtCore.QRect(490, 740, 141, 23))
+        self.PbDiagnostics.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.PbDiagnostics.setObjectName("PbDiagnostics")
+        self.CbSubscribeStatus = QtWidgets.QCheckBox(Form)
+        self.CbSubscribeStatus.setGeometry(QtCore.QRect(930, 800, 121, 20))
+        self.CbSubscribeStatus.setStyleSheet("font: 75 12pt \"MS Shell Dlg 2\";")
+        self.CbSubscribeStatus.setObjectName("CbSubscribeStatus")
         self.horizontalLayoutWidget_2 = QtWidgets.QWidget(Form)
         self.horizontalLayoutWidget_2.setGeometry(QtCore.QRect(1080, 50, 511, 31))
         self.horizontalLayoutWidget_2.setObjectName("horizontalLayoutWidget_2")
@@ -348,6 +374,8 @@ class Ui_Form(object):
         self.PbSendTest.setText(_translate("Form", "SEND TEST MESSAGE"))
         self.PbAddCommand.setText(_translate("Form", "ADD COMMAND"))
         self.PbDeleteCommand.setText(_translate("Form", "REMOVE COMMAND"))
+        self.PbPauseTask.setText(_translate("Form", "PAUSE TASK"))
+        self.PbResumeTask.setText(_translate("Form", "RESUME TASK"))
         self.PbSendDataToTask.setText(_translate("Form", "SEND DATA TO TASK"))
         self.CbMotorMode.setItemText(0, _translate("Form", "FREERUN BLOCKING"))
         self.CbMotorMode.setItemText(1, _translate("Form", "FREERUN NON BLOCKING"))
@@ -361,6 +389,9 @@ class Ui_Form(object):
         self.label_11.setText(_translate("Form", "Steps"))
         self.PbSendMotorCommand.setText(_translate("Form", "SEND MOTOR COMMAND"))
         self.PbGetStatus.setText(_translate("Form", "GET STATUS"))
+        self.PbGetLinkStats.setText(_translate("Form", "LINK STATS"))
+        self.PbDiagnostics.setText(_translate("Form", "DIAGNOSTICS"))
+        self.CbSubscribeStatus.setText(_translate("Form", "Notify status"))
         self.CbBaudMaster.setItemText(0, _translate("Form", "9600"))
         self.CbBaudMaster.setItemText(1, _translate("Form", "115200"))
         self.PbConnectMaster.setText(_translate("Form", "CONNECT"))
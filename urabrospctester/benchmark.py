@@ -0,0 +1,393 @@
+import sys
+import math
+import time
+import json
+import argparse
+import platform
+
+from urabrosLink import UrabrosLink, FRAME_URABROS, FRAME_TEXT, FRAME_BINARY_LOG
+from urabrosCapture import CaptureWriter
+
+# End-to-end benchmark of the Urabros protocol, it runs against a board or the host build (urabrosbase/Host).
+# Usage:
+#   python benchmark.py /dev/ttyACM0 --json rev_a.json
+#   python benchmark.py /tmp/urabros --scenario status --count 2000
+#   python benchmark.py /dev/ttyACM0 --json rev_b.json --compare rev_a.json
+#   python benchmark.py /dev/ttyACM0 --scenario send_data --data-task-id 1
+# Every scenario reports the latency percentiles (ms) and the frames and bytes per second,
+# --compare exits with 1 if a result is worse than the baseline by more than --tolerance.
+
+COMMAND_GET_STATUS      = 0x01
+COMMAND_START           = 0x02
+COMMAND_DELETE          = 0x03
+COMMAND_SEND_DATA       = 0x04
+COMMAND_DATA_FROM_TASK  = 0x07
+COMMAND_GET_LINK_STATS  = 0x09
+COMMAND_SUBSCRIBE       = 0x0A
+COMMAND_STATUS_NOTIFY   = 0x0B
+
+Command_Added           = 0x01
+Command_NotFinished     = 0x02
+Command_Deleted         = 0x04
+Command_CantReceiveData = 0x09
+
+TaskStatus_Running          = 0x01
+TaskStatus_WaitingForACK    = 0x03
+
+TASK_ID_TEST            = 0xFF
+MESSAGE_MAX_DATA_LEN    = 61    # MESSAGE_BUFFER_LENGTH - 3
+ANSWER_TIMEOUT          = 1.0   # Seconds to wait for an answer
+
+SCENARIOS = ["status", "start_delete", "send_data", "stream", "mixed"]
+
+def percentile(values, pct):
+    # Nearest rank percentile
+    ordered = sorted(values)
+    rank = max(0, min(len(ordered) - 1, math.ceil(pct / 100.0 * len(ordered)) - 1))
+    return ordered[rank]
+
+def latencyStats(seconds):
+    if not seconds :
+        return {"n": 0}
+    ms = [value * 1000.0 for value in seconds]
+    return {
+        "n"     : len(ms),
+        "p50"   : round(percentile(ms, 50), 3),
+        "p99"   : round(percentile(ms, 99), 3),
+        "max"   : round(max(ms), 3),
+        "mean"  : round(sum(ms) / len(ms), 3),
+    }
+
+def waitFor(link, match, timeout, seen=None):
+    # Drops the frames until match(kind, payload) is true, gives back (time, payload) or None.
+    # seen(time, kind, payload) gets the dropped frames.
+    deadline = time.perf_counter() + timeout
+    while True :
+        left = deadline - time.perf_counter()
+        if left <= 0 :
+            return None
+        frame = link.receive(left)
+        if frame is None :
+            return None
+        rxTime, kind, payload = frame
+        if match(kind, payload) :
+            return rxTime, payload
+        if seen is not None :
+            seen(rxTime, kind, payload)
+
+def isAnswer(command, taskId=None):
+    def match(kind, payload):
+        if kind != FRAME_URABROS or not payload or payload[0] != command :
+            return False
+        return taskId is None or (len(payload) > 1 and payload[1] == taskId)
+    return match
+
+def isStatusNotify(taskId, mainStatus):
+    def match(kind, payload):
+        if kind != FRAME_URABROS or not payload or payload[0] != COMMAND_STATUS_NOTIFY :
+            return False
+        for pos in range(1, len(payload) - 1, 2) :
+            if payload[pos] == taskId and payload[pos + 1] >> 5 == mainStatus :
+                return True
+        return False
+    return match
+
+def drain(link, quiet=0.2):
+    while link.receive(quiet) is not None :
+        pass
+
+def deleteTask(link, taskId, timeout):
+    # Sends DELETE until the task is deleted or not found, gives back the latency of the last answer
+    deadline = time.perf_counter() + timeout
+    while time.perf_counter() < deadline :
+        txTime = link.send([COMMAND_DELETE, taskId])
+        answer = waitFor(link, isAnswer(COMMAND_DELETE, taskId), ANSWER_TIMEOUT)
+        if answer is None :
+            continue
+        if answer[1][2] != Command_NotFinished :
+            return answer[0] - txTime
+        time.sleep(0.05)
+    return None
+
+def scenarioStatus(link, args):
+    # GET_STATUS round trips, one at a time
+    latencies = []
+    lost = 0
+    start = time.perf_counter()
+    for idx in range(args.count) :
+        txTime = link.send([COMMAND_GET_STATUS])
+        answer = waitFor(link, isAnswer(COMMAND_GET_STATUS), ANSWER_TIMEOUT)
+        if answer is None :
+            lost += 1
+            continue
+        latencies.append(answer[0] - txTime)
+    elapsed = time.perf_counter() - start
+    return {
+        "latency_ms"        : latencyStats(latencies),
+        "lost"              : lost,
+        "frames_per_s"      : round(len(latencies) / elapsed, 1),
+    }
+
+def scenarioStartDelete(link, args):
+    # START -> answer -> status change to running -> task finishes -> DELETE, the status changes come from SUBSCRIBE
+    startLatencies = []
+    runningLatencies = []
+    deleteLatencies = []
+    failed = 0
+
+    link.send([COMMAND_SUBSCRIBE, 1])
+    waitFor(link, isAnswer(COMMAND_SUBSCRIBE), ANSWER_TIMEOUT)
+
+    start = time.perf_counter()
+    for cycle in range(args.cycles) :
+        txTime = link.send([COMMAND_START, args.task_id])
+        answer = waitFor(link, isAnswer(COMMAND_START, args.task_id), ANSWER_TIMEOUT)
+        if answer is None or answer[1][2] != Command_Added :
+            failed += 1
+            deleteTask(link, args.task_id, args.task_timeout)
+            continue
+        startLatencies.append(answer[0] - txTime)
+
+        running = waitFor(link, isStatusNotify(args.task_id, TaskStatus_Running), ANSWER_TIMEOUT)
+        if running is not None :
+            runningLatencies.append(running[0] - txTime)
+
+        waitFor(link, isStatusNotify(args.task_id, TaskStatus_WaitingForACK), args.task_timeout)
+        deleteLatency = deleteTask(link, args.task_id, args.task_timeout)
+        if deleteLatency is None :
+            failed += 1
+        else :
+            deleteLatencies.append(deleteLatency)
+    elapsed = time.perf_counter() - start
+
+    link.send([COMMAND_SUBSCRIBE, 0])
+    drain(link)
+    return {
+        "start_latency_ms"      : latencyStats(startLatencies),
+        "start_to_running_ms"   : latencyStats(runningLatencies),
+        "delete_latency_ms"     : latencyStats(deleteLatencies),
+        "failed"                : failed,
+        "cycles_per_s"          : round(len(deleteLatencies) / elapsed, 3),
+    }
+
+def scenarioSendData(link, args):
+    # SEND_DATA flood with --window messages on the line, the answers come in order
+    payload = bytes([idx & 0xFF for idx in range(min(args.payload, MESSAGE_MAX_DATA_LEN - 1))])
+    message = [COMMAND_SEND_DATA, args.data_task_id] + list(payload)
+    inFlight = []
+    latencies = []
+    results = {}
+    lost = 0
+    sent = 0
+
+    start = time.perf_counter()
+    while sent < args.count or inFlight :
+        while sent < args.count and len(inFlight) < args.window :
+            inFlight.append(link.send(message))
+            sent += 1
+        answer = waitFor(link, isAnswer(COMMAND_SEND_DATA, args.data_task_id), ANSWER_TIMEOUT)
+        if answer is None :
+            # The rest of the window is lost
+            lost += len(inFlight)
+            inFlight = []
+            continue
+        latencies.append(answer[0] - inFlight.pop(0))
+        result = answer[1][2] if len(answer[1]) > 2 else -1
+        if result == Command_CantReceiveData and not results :
+            sys.exit("Task 0x%02X can't receive the payload: it has no data channel (uTaskDataInit), "
+                     "it is not running or the payload is bigger than its slot" % args.data_task_id)
+        results[str(result)] = results.get(str(result), 0) + 1
+    elapsed = time.perf_counter() - start
+
+    return {
+        "latency_ms"        : latencyStats(latencies),
+        "lost"              : lost,
+        "answers"           : results,
+        "frames_per_s"      : round(len(latencies) / elapsed, 1),
+        "bytes_per_s"       : round(len(latencies) * (len(message) + 3) / elapsed, 1),
+    }
+
+def scenarioStream(link, args):
+    # Collects the DATA_FROM_TASK frames of the task, optionally the task is started first
+    arrivals = []
+    dataBytes = 0
+
+    if args.start :
+        link.send([COMMAND_START, args.task_id])
+        waitFor(link, isAnswer(COMMAND_START, args.task_id), ANSWER_TIMEOUT)
+
+    start = time.perf_counter()
+    while time.perf_counter() - start < args.duration :
+        frame = waitFor(link, isAnswer(COMMAND_DATA_FROM_TASK, args.task_id), args.duration - (time.perf_counter() - start))
+        if frame is None :
+            break
+        arrivals.append(frame[0])
+        dataBytes += len(frame[1]) - 2
+    elapsed = time.perf_counter() - start
+
+    if args.start :
+        deleteTask(link, args.task_id, args.task_timeout)
+    gaps = [second - first for first, second in zip(arrivals, arrivals[1:])]
+    return {
+        "gap_ms"            : latencyStats(gaps),
+        "frames_per_s"      : round(len(arrivals) / elapsed, 1),
+        "bytes_per_s"       : round(dataBytes / elapsed, 1),
+    }
+
+def scenarioMixed(link, args):
+    # GET_STATUS round trips while the started task fills the line with debug messages
+    latencies = []
+    debug = {"frames": 0, "bytes": 0}
+    lost = 0
+
+    def seen(rxTime, kind, payload):
+        if kind == FRAME_TEXT or kind == FRAME_BINARY_LOG :
+            debug["frames"] += 1
+            debug["bytes"] += len(payload) + 2
+
+    link.send([COMMAND_START, args.task_id])
+    waitFor(link, isAnswer(COMMAND_START, args.task_id), ANSWER_TIMEOUT, seen)
+
+    start = time.perf_counter()
+    while time.perf_counter() - start < args.duration :
+        txTime = link.send([COMMAND_GET_STATUS])
+        answer = waitFor(link, isAnswer(COMMAND_GET_STATUS), ANSWER_TIMEOUT, seen)
+        if answer is None :
+            lost += 1
+            continue
+        latencies.append(answer[0] - txTime)
+    elapsed = time.perf_counter() - start
+
+    deleteTask(link, args.task_id, args.task_timeout)
+    drain(link)
+    return {
+        "latency_ms"        : latencyStats(latencies),
+        "lost"              : lost,
+        "frames_per_s"      : round(len(latencies) / elapsed, 1),
+        "debug_frames_per_s": round(debug["frames"] / elapsed, 1),
+        "debug_bytes_per_s" : round(debug["bytes"] / elapsed, 1),
+    }
+
+def linkStats(link):
+    # | 0x09 | stream count | bytes 4 | frames 4 | drops 4 | ... from the firmware
+    link.send([COMMAND_GET_LINK_STATS])
+    answer = waitFor(link, isAnswer(COMMAND_GET_LINK_STATS), ANSWER_TIMEOUT)
+    if answer is None :
+        return None
+    payload = answer[1]
+    streams = []
+    for stream in range(payload[1]) :
+        pos = 2 + stream * 12
+        if pos + 12 > len(payload) :
+            break
+        streams.append([int.from_bytes(payload[pos + field * 4 : pos + field * 4 + 4], "big") for field in range(3)])
+    return streams
+
+# Direction of the metrics for the comparison: 1 higher is better, -1 lower is better
+def metricDirection(name):
+    if name.endswith("_per_s") :
+        return 1
+    if name in ("p50", "p99", "max", "mean", "lost", "failed") :
+        return -1
+    return 0
+
+def flatten(results, prefix=""):
+    flat = {}
+    for key, value in results.items() :
+        if isinstance(value, dict) :
+            flat.update(flatten(value, prefix + key + "."))
+        elif isinstance(value, (int, float)) :
+            flat[prefix + key] = value
+    return flat
+
+def compare(current, baseline, tolerance):
+    # Prints the changes, gives back the number of regressions
+    regressions = 0
+    for scenario, results in current["scenarios"].items() :
+        if scenario not in baseline.get("scenarios", {}) :
+            continue
+        old = flatten(baseline["scenarios"][scenario])
+        for name, value in flatten(results).items() :
+            direction = metricDirection(name.split(".")[-1])
+            if not direction or name not in old :
+                continue
+            base = old[name]
+            change = (value - base) / base * 100.0 if base else 0.0
+            worse = (direction > 0 and value < base * (1 - tolerance / 100.0)) or \
+                    (direction < 0 and value > base * (1 + tolerance / 100.0) and value - base > 0.05)
+            regressions += worse
+            print("%-14s %-32s %12.3f -> %12.3f  %+7.1f%%%s" % (scenario, name, base, value, change, "  REGRESSION" if worse else ""))
+    return regressions
+
+def main():
+    parser = argparse.ArgumentParser(description="Urabros protocol benchmark")
+    parser.add_argument("port", help="Serial port, the link of the host build or a pyserial URL")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--scenario", choices=SCENARIOS + ["all"], default="all")
+    parser.add_argument("--task-id", type=lambda text: int(text, 0), default=TASK_ID_TEST, help="uTask used by the scenarios")
+    parser.add_argument("--count", type=int, default=500, help="Messages of the status and send_data scenarios")
+    parser.add_argument("--cycles", type=int, default=5, help="START / DELETE cycles")
+    parser.add_argument("--task-timeout", type=float, default=5.0, help="Seconds a started task has to finish")
+    parser.add_argument("--data-task-id", type=lambda text: int(text, 0), help="uTask with a data channel for the send_data scenario, the tester task has none")
+    parser.add_argument("--payload", type=int, default=16, help="SEND_DATA payload length")
+    parser.add_argument("--window", type=int, default=2, help="SEND_DATA messages on the line, at most MESSAGE_IN_ARRAY_LENGTH")
+    parser.add_argument("--duration", type=float, default=5.0, help="Seconds of the stream and mixed scenarios")
+    parser.add_argument("--start", action="store_true", help="Start the task before the stream scenario")
+    parser.add_argument("--label", default="", help="Firmware revision stored in the results")
+    parser.add_argument("--json", help="Write the results to this file")
+    parser.add_argument("--compare", help="Results of a previous run to compare with")
+    parser.add_argument("--tolerance", type=float, default=10.0, help="Allowed change in percent before a regression is reported")
+    parser.add_argument("--capture", help="Record the raw bytes of the run, see replay.py")
+    args = parser.parse_args()
+
+    scenarioFunctions = {
+        "status"        : scenarioStatus,
+        "start_delete"  : scenarioStartDelete,
+        "send_data"     : scenarioSendData,
+        "stream"        : scenarioStream,
+        "mixed"         : scenarioMixed,
+    }
+    selected = SCENARIOS if args.scenario == "all" else [args.scenario]
+    if args.data_task_id is None and "send_data" in selected :
+        # No framework task has a data channel, so there is no sensible default
+        if args.scenario == "send_data" :
+            parser.error("the send_data scenario needs --data-task-id, an uTask set up with uTaskDataInit()")
+        print("Skipping send_data, it needs --data-task-id")
+        selected = [name for name in selected if name != "send_data"]
+
+    capture = CaptureWriter(args.capture) if args.capture else None
+    link = UrabrosLink(args.port, args.baud, capture)
+    drain(link)
+    results = {
+        "meta": {
+            "label"     : args.label,
+            "port"      : args.port,
+            "baud"      : args.baud,
+            "date"      : time.strftime("%Y-%m-%dT%H:%M:%S"),
+            "host"      : platform.node(),
+            "args"      : vars(args),
+        },
+        "scenarios": {},
+    }
+    for name in selected :
+        print("Running " + name + "...")
+        results["scenarios"][name] = scenarioFunctions[name](link, args)
+        print(json.dumps(results["scenarios"][name], indent=2))
+    results["link_stats"] = linkStats(link)
+    results["pc_counters"] = {kind: {"frames": frames, "bytes": wireBytes} for kind, (frames, wireBytes) in link.counters.items()}
+    link.close()
+    if capture is not None :
+        capture.close()
+
+    if args.json :
+        with open(args.json, "w") as out :
+            json.dump(results, out, indent=2)
+
+    if args.compare :
+        with open(args.compare) as baselineFile :
+            baseline = json.load(baselineFile)
+        if compare(results, baseline, args.tolerance) :
+            sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,206 @@
+import threading
+
+# Bulk transfer: moves data bigger than one message between the PC and a task.
+# | 0x08 | op | taskId | ... | see uBulkTransfer.h for the layouts, all numbers are big endian.
+COMMAND_HEX_BULK        = 0x08
+
+BULK_OP_OPEN            = 0x01
+BULK_OP_DATA            = 0x02
+BULK_OP_ACK             = 0x03
+BULK_OP_ABORT           = 0x04
+
+BULK_OK                 = 0x00
+BULK_NO_RECEIVER        = 0x01
+BULK_TOO_BIG            = 0x02
+BULK_BUSY               = 0x03
+BULK_ABORTED            = 0x04
+BULK_TIMEOUT            = 0x05
+BULK_BAD_FRAGMENT       = 0x06
+
+BULK_ACK_EVERY          = 2
+BULK_RETRY_TIMEOUT      = 0.2
+BULK_MAX_RETRIES        = 5
+
+bulkStatusNames = {
+    BULK_OK             : "Ok",
+    BULK_NO_RECEIVER    : "No receiver",
+    BULK_TOO_BIG        : "Too big",
+    BULK_BUSY           : "Busy",
+    BULK_ABORTED        : "Aborted",
+    BULK_TIMEOUT        : "Timeout",
+    BULK_BAD_FRAGMENT   : "Bad fragment",
+}
+
+# Function sending the bytes of a message, set by the controller
+sendFunction    = None
+uploads         = {}
+downloads       = {}
+bulkLock        = threading.Lock()
+
+def setSendFunction(func):
+    global sendFunction
+    sendFunction = func
+
+def bulkFrame(op, taskId, payload=b""):
+    return bytes([COMMAND_HEX_BULK, op, taskId]) + bytes(payload)
+
+def statusName(status):
+    return bulkStatusNames.get(status, "Unknown " + str(status))
+
+class BulkUpload():
+    # Sends data to a task with a sliding window, the MCU acknowledges cumulatively (Go-Back-N).
+    def __init__(self, taskId, data):
+        self.taskId     = taskId
+        self.data       = bytes(data)
+        self.cond       = threading.Condition()
+        self.opened     = False
+        self.status     = None
+        self.window     = 1
+        self.fragSize   = 1
+        self.acked      = 0
+        self.aborted    = False
+
+    def fragCount(self):
+        return (len(self.data) + self.fragSize - 1) // self.fragSize
+
+    def sendFragment(self, seq):
+        offset = seq * self.fragSize
+        sendFunction(bulkFrame(BULK_OP_DATA, self.taskId, seq.to_bytes(2, "big") + self.data[offset : offset + self.fragSize]))
+
+    def onMessage(self, buffer):
+        with self.cond :
+            if buffer[1] == BULK_OP_OPEN and len(buffer) >= 6 :
+                self.status     = buffer[3]
+                self.window     = buffer[4]
+                self.fragSize   = buffer[5]
+                self.opened     = True
+            elif buffer[1] == BULK_OP_ACK and len(buffer) >= 5 :
+                seq = (buffer[3] << 8) + buffer[4]
+                if seq > self.acked :
+                    self.acked = seq
+            elif buffer[1] == BULK_OP_ABORT :
+                self.aborted    = True
+                self.status     = buffer[3] if len(buffer) > 3 else BULK_ABORTED
+            self.cond.notify_all()
+
+    def run(self):
+        sendFunction(bulkFrame(BULK_OP_OPEN, self.taskId, len(self.data).to_bytes(4, "big")))
+        with self.cond :
+            if not self.cond.wait_for(lambda: self.opened or self.aborted, BULK_RETRY_TIMEOUT * BULK_MAX_RETRIES) :
+                return BULK_TIMEOUT
+            if self.aborted or self.status != BULK_OK :
+                return self.status
+
+        nextSeq     = 0
+        retries     = 0
+        lastBase    = 0
+        while True :
+            with self.cond :
+                base = self.acked
+                if self.aborted :
+                    return self.status
+                if base >= self.fragCount() :
+                    return BULK_OK
+            if base != lastBase :
+                lastBase    = base
+                retries     = 0
+            nextSeq = max(nextSeq, base)
+            while nextSeq < self.fragCount() and nextSeq < base + self.window :
+                self.sendFragment(nextSeq)
+                nextSeq += 1
+            with self.cond :
+                progressed = self.cond.wait_for(lambda: self.acked > base or self.aborted, BULK_RETRY_TIMEOUT)
+            if not progressed :
+                retries += 1
+                if retries > BULK_MAX_RETRIES :
+                    sendFunction(bulkFrame(BULK_OP_ABORT, self.taskId, bytes([BULK_TIMEOUT])))
+                    return BULK_TIMEOUT
+                nextSeq = base
+
+class BulkDownload():
+    # Reassembles the data sent by a task, takes only the next expected fragment.
+    def __init__(self, taskId, total, fragSize):
+        self.taskId     = taskId
+        self.total      = total
+        self.fragSize   = fragSize
+        self.data       = bytearray()
+        self.nextSeq    = 0
+        self.reported   = False
+
+    def fragCount(self):
+        return (self.total + self.fragSize - 1) // self.fragSize
+
+    def isDone(self):
+        return self.nextSeq >= self.fragCount()
+
+    def onData(self, seq, payload):
+        # Returns True if an ACK has to be sent
+        if seq != self.nextSeq or self.isDone() :
+            return True
+        expectedLen = min(self.fragSize, self.total - seq * self.fragSize)
+        if len(payload) != expectedLen :
+            return True
+        self.data += payload
+        self.nextSeq += 1
+        return self.isDone() or (self.nextSeq % BULK_ACK_EVERY) == 0
+
+def startUpload(taskId, data, doneCallback):
+    # Runs the upload in its own thread, the serial thread feeds the answers to it.
+    upload = BulkUpload(taskId, data)
+    with bulkLock :
+        if taskId in uploads :
+            return False
+        uploads[taskId] = upload
+
+    def worker():
+        status = upload.run()
+        with bulkLock :
+            uploads.pop(taskId, None)
+        doneCallback(taskId, status)
+
+    threading.Thread(target=worker, daemon=True).start()
+    return True
+
+def processBulk(buffer):
+    # Called with every 0x08 message of the MCU, returns the text to be printed.
+    if len(buffer) < 3 :
+        return "Bulk: short message"
+    op      = buffer[1]
+    taskId  = buffer[2]
+
+    with bulkLock :
+        upload = uploads.get(taskId)
+    if upload is not None and (op == BULK_OP_ACK or (op == BULK_OP_OPEN and len(buffer) == 6) or op == BULK_OP_ABORT) :
+        upload.onMessage(buffer)
+        if op == BULK_OP_OPEN :
+            return "Bulk upload to Task ID: " + str(taskId) + " - " + statusName(buffer[3])
+        if op == BULK_OP_ABORT :
+            return "Bulk upload to Task ID: " + str(taskId) + " aborted - " + statusName(buffer[3] if len(buffer) > 3 else BULK_ABORTED)
+        return ""
+
+    if op == BULK_OP_OPEN and len(buffer) >= 9 :
+        total       = int.from_bytes(buffer[3:7], "big")
+        downloads[taskId] = BulkDownload(taskId, total, buffer[8])
+        return "Bulk download from Task ID: " + str(taskId) + " - " + str(total) + " bytes"
+
+    if op == BULK_OP_DATA and len(buffer) >= 5 :
+        download = downloads.get(taskId)
+        if download is None :
+            sendFunction(bulkFrame(BULK_OP_ABORT, taskId, bytes([BULK_NO_RECEIVER])))
+            return "Bulk data without download from Task ID: " + str(taskId)
+        if download.onData((buffer[3] << 8) + buffer[4], bytes(buffer[5:])) :
+            sendFunction(bulkFrame(BULK_OP_ACK, taskId, download.nextSeq.to_bytes(2, "big")))
+        if download.isDone() and not download.reported :
+            # Kept until the next OPEN, so a repeated last window is still acknowledged
+            download.reported = True
+            retStr = "Bulk data from Task ID: " + str(taskId) + " : "
+            for data in download.data :
+                retStr += hex(data).upper() + "|"
+            return retStr
+        return ""
+
+    if op == BULK_OP_ABORT :
+        downloads.pop(taskId, None)
+        return "Bulk transfer of Task ID: " + str(taskId) + " aborted - " + statusName(buffer[3] if len(buffer) > 3 else BULK_ABORTED)
+
+    return "Bulk: unexpected message"
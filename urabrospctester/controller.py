@@ -1,4 +1,5 @@
 from view import View
+from view import DiagnosticsView
 from PyQt5 import QtWidgets
 from PyQt5 import QtCore
 from PyQt5.QtCore import Qt, QThread, pyqtSignal
@@ -12,15 +13,21 @@ import serial.tools.list_ports
 
 from messageHandler import processMessage
 from messageHandler import parseMessage
+from messageHandler import unpackBatch
 import messageHandler
+import bulkTransfer
+import diagnostics
+from urabrosCapture import CapturedSerial
+from dlogRender import DlogDecoder
 from msg_t import msgType
 
 #Global variables
-serMaster               = serial.Serial()
+serMaster               = CapturedSerial()
 serDebug                = serial.Serial()
 textBrowserMaster       = QtWidgets.QTextBrowser
 textBrowserDebug        = QtWidgets.QTextBrowser
 msgRx                   = msgType()
+dlogDecoder             = DlogDecoder()
 
 #Constants
 red     = "#ff0000"
@@ -36,12 +43,21 @@ COMMAND_DELETE          = "03"
 COMMAND_SEND_DATA       = "04"
 COMMAND_PAUSE           = "05"
 COMMAND_RESUME          = "06"
+COMMAND_GET_LINK_STATS  = "09"
+COMMAND_SUBSCRIBE       = "0A"
 COMMAND_EMERGENCY_STOP  = "FF"
 
 MESSAGE_URABROS         = 255
+MESSAGE_URABROS_BATCH   = 254
+MESSAGE_BINARY_LOG      = 1
 MESSAGE_START_OF_TEXT   = 2
 MESSAGE_END_OF_TEXT     = 3
 MESSAGE_TEXT_MAX_LEN    = 1024
+DLOG_DICTIONARY_FILE    = "dlog_dict.json"  # Made by dlogExtract.py from the elf file
+HOST_PORT_ENV           = "URABROS_HOST_PORT"  # Link of the pseudo-terminal of the host build, see urabrosbase/Host
+CAPTURE_ENV             = "URABROS_CAPTURE"    # Raw capture of the master port, see replay.py
+MESSAGE_MAX_DATA_LEN    = 61    # MESSAGE_BUFFER_LENGTH - 3, bigger data goes with bulk transfer
+DIAG_REFRESH_MS         = 1000  # Refresh period of the diagnostics window
 
 class Controller():
     def __init__(self):
@@ -61,6 +77,14 @@ class Controller():
         textBrowserDebug  = self.Ui.DebugMessages
 
         messageHandler.msgInitGlobals()
+        if os.path.isfile(DLOG_DICTIONARY_FILE) :
+            dlogDecoder.loadDictionary(DLOG_DICTIONARY_FILE)
+        bulkTransfer.setSendFunction(lambda data: self.sendHexData(data.hex()))
+        diagnostics.setSendFunction(lambda data: self.sendHexData(data.hex()))
+        diagnostics.setUpdateFunction(self.serialThread.sendDiagnostics.emit)
+        self.diagView = DiagnosticsView()
+        self.diagTimer = QtCore.QTimer()
+        self.diagTimer.setInterval(DIAG_REFRESH_MS)
         
         self.Ui.PbSendTest.setDisabled(True)
         self.connectSignalsSlots()
@@ -72,6 +96,10 @@ class Controller():
         portNames = []
         for p in ports:
             portNames.append(str(p.device))
+        # The pseudo-terminal of the host build is not a serial device, it is added by its link name
+        hostPort = os.environ.get(HOST_PORT_ENV)
+        if hostPort and os.path.exists(hostPort):
+            portNames.append(hostPort)
         portNames.sort()
         self.Ui.CbComMaster.clear()
         for portName in portNames:
@@ -95,6 +123,10 @@ class Controller():
                 return
                 
         if serMaster.isOpen():
+            if os.environ.get(CAPTURE_ENV) :
+                capturePath = time.strftime(os.environ[CAPTURE_ENV])
+                serMaster.startCapture(capturePath)
+                PrintMaster(green, "Capturing to " + capturePath)
             self.serialThread.start()
             PrintMaster(green, "Connected to com: " + port + " baud: " + baud)
                 
@@ -108,6 +140,7 @@ class Controller():
             self.serialThread.terminate()
             serMaster.flush()
             serMaster.close()
+            serMaster.stopCapture()
             if not serMaster.isOpen():
                 msgRx.clear()
                 print("SerialMaster closed")
@@ -160,17 +193,61 @@ class Controller():
         Tx =  COMMAND_DELETE + format(self.Ui.SbIdRemove.value(), '02x')
         self.sendHexData(Tx)
     
+    def slot_SendPauseCommand(self):
+        Tx =  COMMAND_PAUSE + format(self.Ui.SbIdPause.value(), '02x')
+        self.sendHexData(Tx)
+
+    def slot_SendResumeCommand(self):
+        Tx =  COMMAND_RESUME + format(self.Ui.SbIdPause.value(), '02x')
+        self.sendHexData(Tx)
+
     def slot_SendGetStatus(self):
         self.sendHexData(COMMAND_GET_STATUS)
+
+    def slot_SendGetLinkStats(self):
+        self.sendHexData(COMMAND_GET_LINK_STATS)
     
+    def slot_ShowDiagnostics(self):
+        self.diagView.show()
+        self.diagView.raise_()
+        self.diagTimer.start()
+        self.slot_RequestDiagnostics()
+
+    def slot_RequestDiagnostics(self):
+        # Stops polling when the window is closed
+        if not self.diagView.isVisible() :
+            self.diagTimer.stop()
+            return
+        if serMaster.isOpen() :
+            diagnostics.request()
+
+    def slot_UpdateDiagnostics(self):
+        rows = []
+        for thread in diagnostics.threads :
+            cpu = diagnostics.cpuToStr(thread["cpu"])
+            rows.append([thread["name"], thread["number"], diagnostics.stateToStr(thread["state"]), thread["priority"],
+                         float(cpu) if cpu != "-" else cpu, thread["stackFree"]])
+        self.diagView.showSnapshot(diagnostics.systemToStr(), rows)
+
     def slot_SendTestMessage(self):
         Tx = format(self.Ui.LeDataTest.text())
         self.sendHexData(Tx)
     
     def slot_SendDataToTask(self):
-        Tx = COMMAND_SEND_DATA + format(self.Ui.SbIdSendData.value(), '02x') + format(self.Ui.LeDataToTask.text())
+        dataHex = format(self.Ui.LeDataToTask.text())
+        if len(bytearray.fromhex(dataHex)) > MESSAGE_MAX_DATA_LEN :
+            self.sendBulkToTask(self.Ui.SbIdSendData.value(), bytearray.fromhex(dataHex))
+            return
+        Tx = COMMAND_SEND_DATA + format(self.Ui.SbIdSendData.value(), '02x') + dataHex
         print(Tx)
         self.sendHexData(Tx)
+
+    def sendBulkToTask(self, taskId, data):
+        def uploadDone(taskId, status):
+            self.serialThread.sendMsgMaster.emit(green if status == bulkTransfer.BULK_OK else red, \
+                "Bulk upload to Task ID: " + str(taskId) + " finished - " + bulkTransfer.statusName(status))
+        if not bulkTransfer.startUpload(taskId, data, uploadDone) :
+            PrintMaster(magenta, "Bulk upload is already running")
     
     def slot_SendMotorCommand(self):
         Tx = COMMAND_SEND_DATA + "04" + format(self.Ui.CbMotorMode.currentIndex() + 1, '02x') \
@@ -191,6 +268,12 @@ class Controller():
             messageHandler.printRecMessage = True
         else :
             messageHandler.printRecMessage = False
+
+    def slot_SubscribeStatus(self):
+        if self.Ui.CbSubscribeStatus.isChecked() :
+            self.sendHexData(COMMAND_SUBSCRIBE + "01")
+        else :
+            self.sendHexData(COMMAND_SUBSCRIBE + "00")
     
     # END OF CHECKBOXIES
     def connectSignalsSlots(self):
@@ -202,14 +285,21 @@ class Controller():
         self.Ui.PbClearDebug.clicked.connect(self.slot_ClearDebug)
         self.serialThread.sendMsgDebug.connect(self.slot_PrintDebug, Qt.QueuedConnection)
         self.serialThread.sendMsgMaster.connect(self.slot_PrintMaster, Qt.QueuedConnection)
+        self.serialThread.sendDiagnostics.connect(self.slot_UpdateDiagnostics, Qt.QueuedConnection)
+        self.diagTimer.timeout.connect(self.slot_RequestDiagnostics)
 
         # CHECKBOX RELEVANT
         self.Ui.CbPrintIncomingHex.clicked.connect(self.slot_PrintIncomingHex)
+        self.Ui.CbSubscribeStatus.clicked.connect(self.slot_SubscribeStatus)
 
         # COMMAND RELEVANT CONNECTIONS
         self.Ui.PbAddCommand.clicked.connect(self.slot_SendAddCommand)
         self.Ui.PbDeleteCommand.clicked.connect(self.slot_SendDeleteCommand)
+        self.Ui.PbPauseTask.clicked.connect(self.slot_SendPauseCommand)
+        self.Ui.PbResumeTask.clicked.connect(self.slot_SendResumeCommand)
         self.Ui.PbGetStatus.clicked.connect(self.slot_SendGetStatus)
+        self.Ui.PbGetLinkStats.clicked.connect(self.slot_SendGetLinkStats)
+        self.Ui.PbDiagnostics.clicked.connect(self.slot_ShowDiagnostics)
         self.Ui.PbSendTest.clicked.connect(self.slot_SendTestMessage)
         self.Ui.PbSendDataToTask.clicked.connect(self.slot_SendDataToTask)
         self.Ui.PbSendMotorCommand.clicked.connect(self.slot_SendMotorCommand)
@@ -238,6 +328,7 @@ def PrintDebug(color, inp):
 class SerialThread (QThread):
     sendMsgMaster = pyqtSignal(str, str)
     sendMsgDebug  = pyqtSignal(str, str)
+    sendDiagnostics = pyqtSignal()
     global msgRx
 
     firstArrived = False
@@ -265,6 +356,13 @@ class SerialThread (QThread):
                         print("<-- TEXT MSG ---")
                         self.sendMsgDebug.emit(green, tempTextBuff.decode('utf-8'))
 
+                    elif messageType == MESSAGE_BINARY_LOG :
+                        logLen  = int.from_bytes(serMaster.read(), byteorder="big")
+                        logText = dlogDecoder.feed(serMaster.read(size=logLen))
+                        if logText != "" :
+                            print(logText, end="")
+                            self.sendMsgDebug.emit(green, logText)
+
                     elif messageType == MESSAGE_URABROS :
                         tempTextBuff        = bytearray()
                         msgRx.datalength    = int.from_bytes(serMaster.read(), byteorder="big")
@@ -275,6 +373,30 @@ class SerialThread (QThread):
                         print(parseMessage(msgRx))
                         print("<-- URAB MSG ---")
                         if msgRx.datalength > 0 :
-                            self.sendMsgMaster.emit(green , processMessage(msgRx))
+                            retStr = processMessage(msgRx)
+                            if retStr != "" :
+                                self.sendMsgMaster.emit(green , retStr)
                         
-                        msgRx.clear()
\ No newline at end of file
+                        msgRx.clear()
+
+                    elif messageType == MESSAGE_URABROS_BATCH :
+                        msgCount    = int.from_bytes(serMaster.read(), byteorder="big")
+                        batchBody   = bytearray()
+                        for idx in range(msgCount) :
+                            subLen      = serMaster.read()
+                            batchBody  += subLen
+                            batchBody  += serMaster.read(size=int.from_bytes(subLen, byteorder="big"))
+                        tempCrc     = serMaster.read(size=2)
+                        batchCrc    = (tempCrc[0] << 8) + tempCrc[1]
+                        msgList     = unpackBatch(msgCount, batchBody, batchCrc)
+                        if msgList is None :
+                            self.sendMsgMaster.emit(red, "CRC ERROR")
+                            continue
+                        print("--- URAB BATCH " + str(msgCount) + " -->")
+                        for subMsg in msgList :
+                            print(parseMessage(subMsg))
+                            if subMsg.datalength > 0 :
+                                retStr = processMessage(subMsg)
+                                if retStr != "" :
+                                    self.sendMsgMaster.emit(green , retStr)
+                        print("<-- URAB BATCH ---")
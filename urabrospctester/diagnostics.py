@@ -0,0 +1,128 @@
+import threading
+
+# Runtime statistics of the MCU: CPU load and stack of the threads, heap and message queues.
+# Request: | 0x0C | section | first thread |   see UrabrosDiagnostics.h for the layouts, all numbers are big endian.
+# The threads come in more answers, the next one is asked from the first thread not received yet.
+COMMAND_HEX_GET_DIAGNOSTICS = 0x0C
+
+DIAG_SECTION_SYSTEM         = 0x00
+DIAG_SECTION_THREADS        = 0x01
+DIAG_CPU_UNKNOWN            = 0xFFFF
+
+ThreadStateNames = ["Running", "Ready", "Blocked", "Suspended", "Deleted", "Invalid"]
+LaneNames = ["Responses", "Task data"]
+
+# Functions set by the controller: sending the bytes of a message, and called when a new snapshot arrived
+sendFunction    = None
+updateFunction  = None
+system          = {}    # Last system section
+threads         = []    # Threads of the last complete snapshot
+collecting      = []    # Threads of the snapshot being received
+diagLock        = threading.Lock()
+
+def setSendFunction(func):
+    global sendFunction
+    sendFunction = func
+
+def setUpdateFunction(func):
+    global updateFunction
+    updateFunction = func
+
+def request():
+    # Asks a new snapshot, the answers update the system and threads
+    sendFunction(bytes([COMMAND_HEX_GET_DIAGNOSTICS, DIAG_SECTION_SYSTEM]))
+    sendFunction(bytes([COMMAND_HEX_GET_DIAGNOSTICS, DIAG_SECTION_THREADS, 0]))
+
+def u32(buffer, pos):
+    return int.from_bytes(buffer[pos : pos + 4], "big")
+
+def u16(buffer, pos):
+    return int.from_bytes(buffer[pos : pos + 2], "big")
+
+def parseSystem(buffer):
+    # | 0x0C | 0 | heap free 4 | heap min free 4 | in high-water | in size | in drops 4 | lane count | (high-water | size | drops 4) * lanes | window us 4 | thread count | in overruns 4 |
+    result = {
+        "heapFree"      : u32(buffer, 2),
+        "heapMinFree"   : u32(buffer, 6),
+        "inHighWater"   : buffer[10],
+        "inSize"        : buffer[11],
+        "inDrops"       : u32(buffer, 12),
+        "lanes"         : [],
+    }
+    pos = 17
+    for lane in range(buffer[16]) :
+        result["lanes"].append({"highWater": buffer[pos], "size": buffer[pos + 1], "drops": u32(buffer, pos + 2)})
+        pos += 6
+    result["windowUs"]      = u32(buffer, pos)
+    result["threadCount"]   = buffer[pos + 4]
+    result["inOverruns"]    = u32(buffer, pos + 5) if len(buffer) >= pos + 9 else 0
+    return result
+
+def parseThreads(buffer):
+    # | 0x0C | 1 | thread count | first | (number | state | priority | CPU 0.1% 2 | stack free 2 | name len | name...) * n |
+    parsed = []
+    pos = 4
+    while pos + 8 <= len(buffer) :
+        nameLen = buffer[pos + 7]
+        parsed.append({
+            "number"    : buffer[pos],
+            "state"     : buffer[pos + 1],
+            "priority"  : buffer[pos + 2],
+            "cpu"       : u16(buffer, pos + 3),
+            "stackFree" : u16(buffer, pos + 5),
+            "name"      : bytes(buffer[pos + 8 : pos + 8 + nameLen]).decode("ascii", "replace"),
+        })
+        pos += 8 + nameLen
+    return buffer[2], buffer[3], parsed
+
+def processDiagnostics(buffer):
+    global system
+    global threads
+    global collecting
+
+    if len(buffer) < 2 :
+        return "Diagnostics: empty answer"
+
+    with diagLock :
+        if buffer[1] == DIAG_SECTION_SYSTEM :
+            system = parseSystem(buffer)
+            complete = True
+        elif buffer[1] == DIAG_SECTION_THREADS :
+            count, first, parsed = parseThreads(buffer)
+            if first == 0 :
+                collecting = []
+            collecting += parsed
+            complete = len(collecting) >= count or not parsed
+            if complete :
+                threads = collecting
+                collecting = []
+            else :
+                sendFunction(bytes([COMMAND_HEX_GET_DIAGNOSTICS, DIAG_SECTION_THREADS, len(collecting)]))
+        else :
+            return "Diagnostics: unknown section " + str(buffer[1])
+
+    if complete and updateFunction is not None :
+        updateFunction()
+    return ""
+
+def cpuToStr(cpu):
+    if cpu == DIAG_CPU_UNKNOWN :
+        return "-"
+    return "%.1f" % (cpu / 10.0)
+
+def stateToStr(state):
+    return ThreadStateNames[state] if state < len(ThreadStateNames) else str(state)
+
+def systemToStr():
+    # One line summary of the system section
+    with diagLock :
+        if not system :
+            return ""
+        text = "Heap free: %d B (min %d B) | In: %d/%d drops %d" % (system["heapFree"], system["heapMinFree"], system["inHighWater"], system["inSize"], system["inDrops"])
+        if system["inOverruns"] :
+            text += " overruns %d" % system["inOverruns"]
+        for lane, stats in enumerate(system["lanes"]) :
+            name = LaneNames[lane] if lane < len(LaneNames) else str(lane)
+            text += " | %s: %d/%d drops %d" % (name, stats["highWater"], stats["size"], stats["drops"])
+        text += " | Window: %d ms" % (system["windowUs"] // 1000)
+        return text
@@ -0,0 +1,59 @@
+import sys
+import json
+import struct
+
+# Builds the dictionary of the binary debug log from the elf file of the firmware.
+# The format strings are in the .dlog_fmt section, the ID of a string is its address.
+# Usage: python dlogExtract.py firmware.elf dlog_dict.json
+
+DLOG_SECTION = ".dlog_fmt"
+
+def readSection(elfPath, sectionName):
+    # Returns (address, data) of the section, only 32 bit little endian elf files are supported
+    with open(elfPath, "rb") as elf :
+        data = elf.read()
+
+    if data[0:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1 :
+        raise ValueError("Not a 32 bit little endian elf file")
+
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    def sectionHeader(idx):
+        # name, type, flags, addr, offset, size
+        return struct.unpack_from("<IIIIII", data, shoff + idx * shentsize)
+
+    strTab = sectionHeader(shstrndx)
+    for idx in range(shnum) :
+        name, shType, flags, addr, offset, size = sectionHeader(idx)
+        nameStart = strTab[4] + name
+        nameEnd = data.index(b"\x00", nameStart)
+        if data[nameStart:nameEnd].decode() == sectionName :
+            return addr, data[offset : offset + size]
+    return None, None
+
+def extractFormats(elfPath):
+    addr, section = readSection(elfPath, DLOG_SECTION)
+    formats = {}
+    if section is None :
+        return formats
+    pos = 0
+    while pos < len(section) :
+        end = section.index(b"\x00", pos)
+        if end > pos :
+            formats[(addr + pos) & 0xFFFF] = section[pos:end].decode("utf-8", errors="replace")
+        pos = end + 1
+    return formats
+
+def main():
+    if len(sys.argv) != 3 :
+        print("Usage: python dlogExtract.py firmware.elf dlog_dict.json")
+        return 1
+    formats = extractFormats(sys.argv[1])
+    with open(sys.argv[2], "w") as dictFile :
+        json.dump({str(key): value for key, value in formats.items()}, dictFile, indent=1)
+    print("Extracted " + str(len(formats)) + " format strings")
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
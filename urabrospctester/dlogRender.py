@@ -0,0 +1,74 @@
+import re
+import json
+import struct
+
+# Renders the records of the binary debug log, see uDebugPrint.h for the layout.
+# | 0xA5 | nargs | format ID 2 byte | timestamp in us 4 byte | arg 1 4 byte | ... | arg n 4 byte |   (little endian)
+
+DLOG_SYNC       = 0xA5
+DLOG_MAX_ARGS   = 8
+
+# printf conversion: flags, width, precision, length modifier, type
+conversionRe = re.compile(r"%([-+ #0]*)(\d*)(\.\d+)?(hh|h|ll|l|L|z|t|j)?([diouxXcspfFeEgG%])")
+
+class DlogDecoder():
+    def __init__(self):
+        self.formats    = {}
+        self.stream     = bytearray()
+        self.lost       = 0
+
+    def loadDictionary(self, path):
+        with open(path, "r") as dictFile :
+            self.formats = {int(key): value for key, value in json.load(dictFile).items()}
+
+    def renderFormat(self, fmt, args):
+        argIter = iter(args)
+
+        def convert(match):
+            flags, width, precision, length, conv = match.groups()
+            if conv == "%" :
+                return "%"
+            value = next(argIter, 0)
+            if conv in "di" :
+                value = struct.unpack("<i", struct.pack("<I", value))[0]
+                conv = "d"
+            elif conv == "u" :
+                conv = "d"
+            elif conv == "c" :
+                value = chr(value & 0xFF)
+            elif conv in "fFeEgG" :
+                # The MCU sends the bits of a 32 bit float
+                value = struct.unpack("<f", struct.pack("<I", value))[0]
+            elif conv == "s" :
+                return "<str@" + hex(value) + ">"
+            elif conv == "p" :
+                return hex(value)
+            return ("%" + flags + width + (precision or "") + conv) % value
+
+        return conversionRe.sub(convert, fmt)
+
+    def renderRecord(self, fmtId, timestampUs, args):
+        fmt = self.formats.get(fmtId)
+        if fmt is None :
+            return "[" + str(timestampUs) + " us] <unknown format " + hex(fmtId) + "> " + " ".join(hex(arg) for arg in args) + "\n"
+        return "[" + str(timestampUs) + " us] " + self.renderFormat(fmt, args)
+
+    def feed(self, data):
+        # Returns the rendered text of all the complete records, a record can be split between frames.
+        self.stream += data
+        text = ""
+        while len(self.stream) >= 8 :
+            if self.stream[0] != DLOG_SYNC or self.stream[1] > DLOG_MAX_ARGS :
+                # Resync on the next record start
+                del self.stream[0]
+                self.lost += 1
+                continue
+            nargs = self.stream[1]
+            recordLen = 8 + nargs * 4
+            if len(self.stream) < recordLen :
+                break
+            fmtId, timestampUs = struct.unpack_from("<HI", self.stream, 2)
+            args = struct.unpack_from("<" + "I" * nargs, self.stream, 8)
+            del self.stream[0:recordLen]
+            text += self.renderRecord(fmtId, timestampUs, args)
+        return text
@@ -1,5 +1,8 @@
 from msg_t import msgType
 import libscrc
+import bulkTransfer
+import diagnostics
+import probes
 
 COMMAND_HEX_GET_STATUS      = 0x01
 COMMAND_HEX_START           = 0x02
@@ -8,6 +11,12 @@ COMMAND_HEX_SEND_DATA       = 0x04
 COMMAND_HEX_PAUSE           = 0x05
 COMMAND_HEX_RESUME          = 0x06
 COMMAND_HEX_DATA_FROM_TASK  = 0x07
+COMMAND_HEX_BULK            = 0x08
+COMMAND_HEX_GET_LINK_STATS  = 0x09
+COMMAND_HEX_SUBSCRIBE       = 0x0A
+COMMAND_HEX_STATUS_NOTIFY   = 0x0B
+COMMAND_HEX_GET_DIAGNOSTICS = 0x0C
+COMMAND_HEX_GET_PROFILE     = 0x0D
 COMMAND_HEX_RECEIVE_ERROR   = 0xFE
 COMMAND_HEX_EMERGENCY_STOP  = 0xFF
 
@@ -36,6 +45,30 @@ TaskStatus_Hex_WaitingForInnerSignal    = 0x04
 TaskStatus_Hex_Stopped                  = 0x05
 TaskStatus_Hex_Error                    = 0x06
 
+LinkStreamNames = ["Responses", "Task data", "Debug"]
+
+
+def statusToStr(statusByte):
+    # Main status in the upper 3 bits, minor status in the lower 5 bits
+    mainStatus = statusByte >> 5
+    minorStatus = statusByte & 0b00011111
+    retStr = ""
+    if mainStatus == TaskStatus_Hex_Setup:
+        retStr += " | Setup |"    
+    elif mainStatus == TaskStatus_Hex_Running:
+        retStr += " | Running |"
+    elif mainStatus == TaskStatus_Hex_WaitingForStartSignal:
+        retStr += " | Waiting for Start |"
+    elif mainStatus == TaskStatus_Hex_WaitingForACKSignal:
+        retStr += " | Waiting for ACK |"
+    elif mainStatus == TaskStatus_Hex_WaitingForInnerSignal:
+        retStr += " | Waiting for Inner |"
+    elif mainStatus == TaskStatus_Hex_Stopped:
+        retStr += " | Paused | "
+    elif mainStatus == TaskStatus_Hex_Error:
+        retStr += " | Error | "
+    retStr +=  str(minorStatus) + " |\n"
+    return retStr
 
 def msgInitGlobals():
     global printRecMessage
@@ -61,24 +94,7 @@ def processMessage(msgRx):
             print(int((msgRx.datalength - 1) / 2))
             retStr += "| ID | MainStatus | Minor Status |\n"
             for id in range(int((msgRx.datalength - 1) / 2)) :
-                mainStatus = msgRx.buffer[targetIdx + 1] >> 5
-                minorStatus = msgRx.buffer[targetIdx + 1] & 0b00011111
-                retStr += "| ID: " + str(msgRx.buffer[targetIdx])
-                if mainStatus == TaskStatus_Hex_Setup:
-                    retStr += " | Setup |"    
-                elif mainStatus == TaskStatus_Hex_Running:
-                    retStr += " | Running |"
-                elif mainStatus == TaskStatus_Hex_WaitingForStartSignal:
-                    retStr += " | Waiting for Start |"
-                elif mainStatus == TaskStatus_Hex_WaitingForACKSignal:
-                    retStr += " | Waiting for ACK |"
-                elif mainStatus == TaskStatus_Hex_WaitingForInnerSignal:
-                    retStr += " | Waiting for Inner |"
-                elif mainStatus == TaskStatus_Hex_Stopped:
-                    retStr += " | Paused | "
-                elif mainStatus == TaskStatus_Hex_Error:
-                    retStr += " | Error | "
-                retStr +=  str(minorStatus) + " |\n"
+                retStr += "| ID: " + str(msgRx.buffer[targetIdx]) + statusToStr(msgRx.buffer[targetIdx + 1])
 
                 targetIdx += 2
 
@@ -123,9 +139,24 @@ def processMessage(msgRx):
         elif msgRx.buffer[2] == Command_Hex_Ok:
             retStr += "Ok"
 
-    #elif msgRx.buffer[0] == COMMAND_HEX_PAUSE :
-    #elif msgRx.buffer[0] == COMMAND_HEX_RESUME :
-    #elif msgRx.buffer[0] == COMMAND_HEX_EMERGENCY_STOP :
+    elif msgRx.buffer[0] == COMMAND_HEX_PAUSE or msgRx.buffer[0] == COMMAND_HEX_RESUME :
+        if msgRx.buffer[0] == COMMAND_HEX_PAUSE :
+            retStr += "Pausing Task - Id: " + str(msgRx.buffer[1]) + " - "
+        else :
+            retStr += "Resuming Task - Id: " + str(msgRx.buffer[1]) + " - "
+        if msgRx.buffer[2] == Command_Hex_Ok:
+            retStr += "Ok"
+        elif msgRx.buffer[2] == Command_Hex_IdOutOfRange:
+            retStr += "Task Id out of Range"
+        elif msgRx.buffer[2] == Command_Hex_Error:
+            retStr += "Error"
+
+    elif msgRx.buffer[0] == COMMAND_HEX_EMERGENCY_STOP :
+        # | 0xFF | count 4 byte | last us 4 byte | max us 4 byte | big endian
+        if msgRx.datalength >= 13 :
+            retStr += "EMERGENCY STOP - Count: " + str(int.from_bytes(msgRx.buffer[1:5], "big"))
+            retStr += " | Last: " + str(int.from_bytes(msgRx.buffer[5:9], "big")) + " us"
+            retStr += " | Max: " + str(int.from_bytes(msgRx.buffer[9:13], "big")) + " us"
 
     elif msgRx.buffer[0] == COMMAND_HEX_RECEIVE_ERROR :
         if msgRx.buffer[1] == Msg_Hex_CrcError:
@@ -140,8 +171,70 @@ def processMessage(msgRx):
         for data in range(2, int(msgRx.datalength)) :
             retStr += hex(msgRx.buffer[data]).upper() + "|"
 
+    elif msgRx.buffer[0] == COMMAND_HEX_BULK :
+        retStr += bulkTransfer.processBulk(msgRx.buffer)
+
+    elif msgRx.buffer[0] == COMMAND_HEX_GET_DIAGNOSTICS :
+        # Shown in the diagnostics window
+        retStr += diagnostics.processDiagnostics(msgRx.buffer)
+
+    elif msgRx.buffer[0] == COMMAND_HEX_GET_PROFILE :
+        # Summary of one probe, probes.py downloads all of them with the histograms
+        result = probes.parseAnswer(msgRx.buffer[:msgRx.datalength])
+        if result is None :
+            retStr += "Profiling is not enabled"
+        else :
+            retStr += probes.summaryToStr(result)
+
+    elif msgRx.buffer[0] == COMMAND_HEX_GET_LINK_STATS :
+        # | 0x09 | stream count | bytes 4 byte | frames 4 byte | drops 4 byte | ... big endian
+        retStr += "| Stream | Bytes | Frames | Drops |\n"
+        for stream in range(msgRx.buffer[1]) :
+            pos = 2 + stream * 12
+            if pos + 12 > msgRx.datalength :
+                break
+            name = LinkStreamNames[stream] if stream < len(LinkStreamNames) else str(stream)
+            retStr += "| " + name
+            for field in range(3) :
+                retStr += " | " + str(int.from_bytes(msgRx.buffer[pos + field * 4 : pos + field * 4 + 4], "big"))
+            retStr += " |\n"
+
+    elif msgRx.buffer[0] == COMMAND_HEX_SUBSCRIBE :
+        if msgRx.buffer[1] :
+            retStr += "Status notification ON"
+        else :
+            retStr += "Status notification OFF"
+
+    elif msgRx.buffer[0] == COMMAND_HEX_STATUS_NOTIFY :
+        # | 0x0B | id | status | id | status | ... sent by the master without request
+        targetIdx = 1
+        while targetIdx + 1 < msgRx.datalength :
+            retStr += "Status change | ID: " + str(msgRx.buffer[targetIdx]) + statusToStr(msgRx.buffer[targetIdx + 1])
+            targetIdx += 2
+
     return retStr
 
+def unpackBatch(count, body, crc16):
+    # Super-frame: | 0xFE | count | len 1 | data 1... | len n | data n... | CRC 1 | CRC 2 |
+    # The CRC covers the count byte and all the sub-messages.
+    if libscrc.modbus(bytes([count]) + bytes(body)) != crc16:
+        return None
+
+    msgList = []
+    pos = 0
+    for idx in range(count) :
+        if pos >= len(body) :
+            return None
+        subMsg = msgType()
+        subMsg.datalength = body[pos]
+        subMsg.buffer     = bytes(body[pos + 1 : pos + 1 + subMsg.datalength])
+        subMsg.crc16      = libscrc.modbus(subMsg.buffer)
+        if not subMsg.checkDatalen() :
+            return None
+        msgList.append(subMsg)
+        pos += subMsg.datalength + 1
+    return msgList
+
 def parseMessage(msgRx):
     testStr = "ID: " + str(msgRx.buffer[0]) + "\nLen: " + str(msgRx.datalength) + "\nData: "  + msgRx.buffer.hex() + "\nCRC: " + hex(msgRx.crc16)
     return testStr 
\ No newline at end of file
@@ -0,0 +1,142 @@
+import sys
+import json
+import argparse
+
+from urabrosLink import UrabrosLink, FRAME_URABROS
+
+# Execution time probes of the MCU, see UrabrosProfile.h.
+# Usage:
+#   python probes.py /dev/ttyACM0                   # all probes with their histogram
+#   python probes.py /dev/ttyACM0 --probe 2 --reset # one probe, cleared after the download
+#   python probes.py /tmp/urabros --json probes.json
+# Request: | 0x0D | probe | first bin |   PROFILE_RESET as first bin clears the probe.
+# Answer:  | 0x0D | probe | probe count | bin count | clock Hz 4 | count 4 | min 4 | max 4 | mean 4 | first bin | bin 4 | ... |
+# All numbers are big endian and in counter cycles, the bins which don't fit into one answer are asked from the next first bin.
+
+COMMAND_GET_PROFILE     = 0x0D
+PROFILE_RESET           = 0xFF
+PROFILE_HEADER_LEN      = 24    # Bytes of the answer before the bins
+ANSWER_TIMEOUT          = 1.0   # Seconds to wait for an answer
+
+ProbeNames = ["uMsgPutFromDMA", "Send frame", "crc16_update", "MotorPulseCallback", "MotorAccelerateSpeed"]
+
+def probeToStr(probe):
+    return ProbeNames[probe] if probe < len(ProbeNames) else "User " + str(probe)
+
+def u32(buffer, pos):
+    return int.from_bytes(buffer[pos : pos + 4], "big")
+
+def parseAnswer(buffer):
+    # Gives back the probe as a dict, or None if the probe is not compiled in (PROFILE_ENABLE 0)
+    if len(buffer) < PROFILE_HEADER_LEN :
+        return None
+    result = {
+        "probe"     : buffer[1],
+        "probeNum"  : buffer[2],
+        "binNum"    : buffer[3],
+        "clockHz"   : u32(buffer, 4),
+        "count"     : u32(buffer, 8),
+        "min"       : u32(buffer, 12),
+        "max"       : u32(buffer, 16),
+        "mean"      : u32(buffer, 20),
+        "first"     : buffer[24] if len(buffer) > 24 else 0,
+        "bins"      : [],
+    }
+    for pos in range(PROFILE_HEADER_LEN + 1, len(buffer) - 3, 4) :
+        result["bins"].append(u32(buffer, pos))
+    return result
+
+def cyclesToUs(cycles, clockHz):
+    return cycles * 1e6 / clockHz if clockHz else 0.0
+
+def binRange(binIdx, binNum):
+    # Cycles counted by a bin, the last one is open
+    low = 0 if binIdx == 0 else 1 << binIdx
+    high = None if binIdx == binNum - 1 else (1 << (binIdx + 1)) - 1
+    return low, high
+
+def summaryToStr(result):
+    clockHz = result["clockHz"]
+    if not result["count"] :
+        return "%-22s no measurement" % probeToStr(result["probe"])
+    return "%-22s n %-9d min %9.2f us  mean %9.2f us  max %9.2f us" % (probeToStr(result["probe"]), result["count"],
+        cyclesToUs(result["min"], clockHz), cyclesToUs(result["mean"], clockHz), cyclesToUs(result["max"], clockHz))
+
+def histogramToStr(result, width=40):
+    lines = []
+    bins = result["bins"]
+    peak = max(bins) if bins else 0
+    for binIdx, count in enumerate(bins) :
+        if not count :
+            continue
+        low, high = binRange(binIdx, len(bins))
+        lowUs = cyclesToUs(low, result["clockHz"])
+        label = ("%9.2f us -" % lowUs) + ("     ...    " if high is None else " %9.2f us" % cyclesToUs(high, result["clockHz"]))
+        bar = "#" * max(1, count * width // peak)
+        lines.append("    %s %10d %s" % (label, count, bar))
+    return "\n".join(lines)
+
+def request(link, probe, first):
+    link.send([COMMAND_GET_PROFILE, probe, first])
+    while True :
+        frame = link.receive(ANSWER_TIMEOUT)
+        if frame is None :
+            return None
+        rxTime, kind, payload = frame
+        if kind == FRAME_URABROS and len(payload) > 1 and payload[0] == COMMAND_GET_PROFILE and payload[1] == probe :
+            return payload
+
+def download(link, probe, reset=False):
+    # The first answer takes the snapshot, the rest of the bins are read from the same one.
+    # The reset request clears the probe, so the snapshot is taken before it.
+    payload = request(link, probe, 0)
+    if payload is None :
+        raise TimeoutError("No answer for probe " + str(probe))
+    result = parseAnswer(payload)
+    if result is None :
+        return None
+    while len(result["bins"]) < result["binNum"] :
+        payload = request(link, probe, len(result["bins"]))
+        following = parseAnswer(payload) if payload is not None else None
+        if following is None or not following["bins"] :
+            break
+        result["bins"] += following["bins"]
+    if reset :
+        request(link, probe, PROFILE_RESET)
+    return result
+
+def main():
+    parser = argparse.ArgumentParser(description="Urabros execution time probes")
+    parser.add_argument("port", help="Serial port, the link of the host build or a pyserial URL")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--probe", type=int, help="Only this probe, all of them by default")
+    parser.add_argument("--reset", action="store_true", help="Clear the probes after the download")
+    parser.add_argument("--no-hist", action="store_true", help="Only the summary lines")
+    parser.add_argument("--json", help="Write the probes to this file")
+    args = parser.parse_args()
+
+    link = UrabrosLink(args.port, args.baud)
+    results = []
+    try :
+        first = download(link, args.probe if args.probe is not None else 0, args.reset)
+        if first is None :
+            print("The probes are not enabled, see PROFILE_ENABLE")
+            sys.exit(1)
+        results.append(first)
+        if args.probe is None :
+            for probe in range(1, first["probeNum"]) :
+                results.append(download(link, probe, args.reset))
+    finally :
+        link.close()
+
+    for result in results :
+        print(summaryToStr(result))
+        if not args.no_hist and result["count"] :
+            print(histogramToStr(result))
+
+    if args.json :
+        with open(args.json, "w") as out :
+            json.dump(results, out, indent=2)
+
+if __name__ == "__main__":
+    main()
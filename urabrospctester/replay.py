@@ -0,0 +1,115 @@
+import time
+import argparse
+
+from urabrosCapture import readCapture, CaptureWriter, StreamNames, DirectionNames, DIRECTION_TX, DIRECTION_RX
+from urabrosLink import UrabrosLink, FrameParser
+
+# Replays a capture made by urabrosCapture.py at the original speed or N times faster.
+# Usage:
+#   python replay.py dump session.ucap                                  prints the records
+#   python replay.py port session.ucap /dev/ttyACM0 --speed 4           sends the PC bytes to the receive path of the MCU
+#   python replay.py parser session.ucap --speed 0                      feeds the MCU bytes to the frame parser of the PC
+# Every record is written at its own time, so the byte groups, the gaps and the IDLE splits of the session are kept.
+# Speed 0 sends the records without waiting.
+
+SLEEP_MARGIN    = 0.002     # The last part of the wait is spinning, sleep() is not precise enough
+
+class Pacer():
+    def __init__(self, speed):
+        self.speed      = speed
+        self.startTime  = time.perf_counter()
+        self.late       = []    # Seconds the records were sent after their time
+
+    def wait(self, timeUs):
+        if not self.speed :
+            return
+        target = self.startTime + timeUs / 1000000.0 / self.speed
+        left = target - time.perf_counter()
+        if left > SLEEP_MARGIN :
+            time.sleep(left - SLEEP_MARGIN)
+        while time.perf_counter() < target :
+            pass
+        self.late.append(time.perf_counter() - target)
+
+    def report(self, records, dataBytes):
+        elapsed = time.perf_counter() - self.startTime
+        print("Replayed %d records, %d bytes in %.3f s, %.1f bytes/s" % (records, dataBytes, elapsed, dataBytes / elapsed if elapsed else 0))
+        if self.late :
+            late = sorted(self.late)
+            print("Timing error: p50 %.1f us, max %.1f us" % (late[len(late) // 2] * 1000000, late[-1] * 1000000))
+
+def dump(records, args):
+    for timeUs, direction, stream, data in records :
+        print("%12d us  %s  %-10s %4d  %s" % (timeUs, DirectionNames[direction], StreamNames[stream], len(data), data.hex(" ")))
+
+def replayPort(records, args):
+    # The answers of the MCU go to a new capture if --capture is given, so the two sessions can be compared
+    capture = CaptureWriter(args.capture) if args.capture else None
+    link = UrabrosLink(args.port, args.baud, capture)
+    sent = [record for record in records if record[1] == DIRECTION_TX]
+    pacer = Pacer(args.speed)
+    dataBytes = 0
+
+    for timeUs, direction, stream, data in sent :
+        pacer.wait(timeUs)
+        if capture is not None :
+            capture("tx", time.perf_counter(), data)
+        link.serial.write(data)
+        dataBytes += len(data)
+    pacer.report(len(sent), dataBytes)
+
+    # Waits for the last answers
+    time.sleep(args.tail)
+    link.close()
+    if capture is not None :
+        capture.close()
+    for kind, (frames, wireBytes) in sorted(link.counters.items()) :
+        print("Received %-10s %6d frames %8d bytes" % (kind, frames, wireBytes))
+
+def replayParser(records, args):
+    # The parser gets the same pieces as the reader of the link got at the session
+    received = [record for record in records if record[1] == DIRECTION_RX]
+    parser = FrameParser()
+    pacer = Pacer(args.speed)
+    counters = {}
+    dataBytes = 0
+    parseTime = 0.0
+
+    for timeUs, direction, stream, data in received :
+        pacer.wait(timeUs)
+        start = time.perf_counter()
+        frames = parser.feed(data)
+        parseTime += time.perf_counter() - start
+        dataBytes += len(data)
+        for kind, payload, wireLen in frames :
+            counters[kind] = counters.get(kind, 0) + 1
+    pacer.report(len(received), dataBytes)
+    print("Parser busy %.3f s, %.1f bytes/s while busy" % (parseTime, dataBytes / parseTime if parseTime else 0))
+    for kind, frames in sorted(counters.items()) :
+        print("Parsed %-10s %6d frames" % (kind, frames))
+
+def main():
+    parser = argparse.ArgumentParser(description="Urabros capture replay")
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    dumpParser = commands.add_parser("dump", help="Print the records of a capture")
+    dumpParser.add_argument("session")
+
+    portParser = commands.add_parser("port", help="Send the PC side of a capture to the MCU")
+    portParser.add_argument("session")
+    portParser.add_argument("port", help="Serial port, the link of the host build or a pyserial URL")
+    portParser.add_argument("--baud", type=int, default=115200)
+    portParser.add_argument("--speed", type=float, default=1.0, help="Times faster than the session, 0 means no waiting")
+    portParser.add_argument("--tail", type=float, default=1.0, help="Seconds to wait for the answers after the last record")
+    portParser.add_argument("--capture", help="Capture of the replayed session")
+
+    parserParser = commands.add_parser("parser", help="Feed the MCU side of a capture to the frame parser of the PC")
+    parserParser.add_argument("session")
+    parserParser.add_argument("--speed", type=float, default=1.0, help="Times faster than the session, 0 means no waiting")
+
+    args = parser.parse_args()
+    records = readCapture(args.session)
+    {"dump": dump, "port": replayPort, "parser": replayParser}[args.command](records, args)
+
+if __name__ == "__main__":
+    main()
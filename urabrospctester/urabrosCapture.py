@@ -0,0 +1,131 @@
+import threading
+import time
+import serial
+
+from urabrosLink import FrameParser, FRAME_URABROS, FRAME_TEXT, FRAME_BINARY_LOG, FRAME_CRC_ERROR, FRAME_JUNK
+
+# Raw capture of a UART session, every byte of both directions with the time it was written or read.
+# File:   | "UCAP" | version 1 byte |  then records until the end of the file
+# Record: | time us 8 byte | direction 1 byte | stream 1 byte | len 2 byte | data... |  big endian
+# The time is counted from the start of the capture. The stream tells which frame the bytes belong to,
+# the received bytes are split at the frame borders, so one read can give more records with the same time.
+# A record is written when its frame is finished, the records are ordered by time when read back.
+
+CAPTURE_MAGIC           = b"UCAP"
+CAPTURE_VERSION         = 1
+CAPTURE_RECORD_HEADER   = 12
+
+DIRECTION_TX            = 0     # PC -> MCU
+DIRECTION_RX            = 1     # MCU -> PC
+
+STREAM_COMMAND          = 0     # | len | data... | CRC | frames of the PC
+STREAM_URABROS          = 1
+STREAM_TEXT             = 2
+STREAM_BINARY_LOG       = 3
+STREAM_CRC_ERROR        = 4
+STREAM_JUNK             = 5
+STREAM_UNFINISHED       = 6     # Received bytes of a frame which was not finished when the capture was closed
+
+StreamOfFrame = {
+    FRAME_URABROS       : STREAM_URABROS,
+    FRAME_TEXT          : STREAM_TEXT,
+    FRAME_BINARY_LOG    : STREAM_BINARY_LOG,
+    FRAME_CRC_ERROR     : STREAM_CRC_ERROR,
+    FRAME_JUNK          : STREAM_JUNK,
+}
+
+StreamNames = ["command", "urabros", "text", "binlog", "crcError", "junk", "unfinished"]
+DirectionNames = ["tx", "rx"]
+
+class CaptureWriter():
+    # Can be given as the rawHook of UrabrosLink, or called by CapturedSerial.
+    def __init__(self, path):
+        self.file       = open(path, "wb")
+        self.lock       = threading.Lock()
+        self.parser     = FrameParser()
+        self.pending    = []            # [time, bytearray] of the received bytes without finished frame
+        self.startTime  = None
+        self.file.write(CAPTURE_MAGIC + bytes([CAPTURE_VERSION]))
+
+    def __call__(self, direction, now, data):
+        with self.lock :
+            if self.file is None :
+                return
+            if self.startTime is None :
+                self.startTime = now
+            if direction == "tx" :
+                self.writeRecord(now, DIRECTION_TX, STREAM_COMMAND, data)
+                return
+            self.pending.append([now, bytearray(data)])
+            for kind, payload, wireLen in self.parser.feed(data) :
+                self.writeReceived(StreamOfFrame[kind], wireLen)
+
+    def writeRecord(self, now, direction, stream, data):
+        timeUs = int(round((now - self.startTime) * 1000000))
+        self.file.write(timeUs.to_bytes(8, "big") + bytes([direction, stream]) + len(data).to_bytes(2, "big") + bytes(data))
+
+    def writeReceived(self, stream, wireLen):
+        # The first wireLen pending bytes belong to the finished frame
+        while wireLen :
+            now, data = self.pending[0]
+            part = min(wireLen, len(data))
+            self.writeRecord(now, DIRECTION_RX, stream, data[:part])
+            del data[:part]
+            if not data :
+                self.pending.pop(0)
+            wireLen -= part
+
+    def close(self):
+        with self.lock :
+            if self.file is None :
+                return
+            for now, data in self.pending :
+                self.writeRecord(now, DIRECTION_RX, STREAM_UNFINISHED, data)
+            self.pending = []
+            self.file.close()
+            self.file = None
+
+def readCapture(path):
+    # Gives back the list of (time us, direction, stream, data) ordered by time
+    records = []
+    with open(path, "rb") as capture :
+        content = capture.read()
+    if content[:4] != CAPTURE_MAGIC or content[4] != CAPTURE_VERSION :
+        raise ValueError(path + " is not an Urabros capture")
+    pos = 5
+    while pos + CAPTURE_RECORD_HEADER <= len(content) :
+        timeUs      = int.from_bytes(content[pos : pos + 8], "big")
+        direction   = content[pos + 8]
+        stream      = content[pos + 9]
+        length      = int.from_bytes(content[pos + 10 : pos + 12], "big")
+        pos        += CAPTURE_RECORD_HEADER
+        records.append((timeUs, direction, stream, bytes(content[pos : pos + length])))
+        pos        += length
+    # Stable sort, the records of one read stay in order
+    records.sort(key=lambda record: record[0])
+    return records
+
+class CapturedSerial(serial.Serial):
+    # serial.Serial which gives every written and read byte to the capture, if it is started
+    def __init__(self, *args, **kwargs):
+        self.capture = None
+        super().__init__(*args, **kwargs)
+
+    def startCapture(self, path):
+        self.capture = CaptureWriter(path)
+
+    def stopCapture(self):
+        if self.capture is not None :
+            self.capture.close()
+            self.capture = None
+
+    def read(self, size=1):
+        data = super().read(size)
+        if data and self.capture is not None :
+            self.capture("rx", time.perf_counter(), data)
+        return data
+
+    def write(self, data):
+        if self.capture is not None :
+            self.capture("tx", time.perf_counter(), data)
+        return super().write(data)
@@ -0,0 +1,156 @@
+import threading
+import time
+import queue
+import serial
+import libscrc
+
+# Serial link to the Urabros master without the GUI, used by the scripts.
+# PC -> MCU: | len | data... | CRC hi | CRC lo |
+# MCU -> PC: | 0xFF | len | data... | CRC hi | CRC lo |                   Urabros message
+#            | 0xFE | count | len 1 | data 1... | len n | data n... | CRC | super-frame
+#            | 0x02 | text... | 0x03 |                                     debug text
+#            | 0x01 | len | data... |                                     binary debug log
+
+MESSAGE_URABROS         = 0xFF
+MESSAGE_URABROS_BATCH   = 0xFE
+MESSAGE_BINARY_LOG      = 0x01
+MESSAGE_START_OF_TEXT   = 0x02
+MESSAGE_END_OF_TEXT     = 0x03
+MESSAGE_TEXT_MAX_LEN    = 1024
+
+FRAME_URABROS           = "urabros"     # One Urabros message, from a single frame or from a super-frame
+FRAME_TEXT              = "text"
+FRAME_BINARY_LOG        = "binlog"
+FRAME_CRC_ERROR         = "crcError"
+FRAME_JUNK              = "junk"        # Bytes outside of any frame
+
+def frameToMcu(data):
+    data = bytes(data)
+    return bytes([len(data)]) + data + libscrc.modbus(data).to_bytes(2, byteorder="big")
+
+class FrameParser():
+    # Splits the bytes of the MCU into frames. feed() can be called with any piece of the stream,
+    # it gives back (kind, payload, wire length) for every finished frame.
+    def __init__(self):
+        self.buffer = bytearray()
+
+    def feed(self, data):
+        self.buffer += data
+        frames = []
+        while self.buffer :
+            frame = self.parseOne()
+            if frame is None :
+                break
+            frames.extend(frame)
+        return frames
+
+    def parseOne(self):
+        buf = self.buffer
+        kind = buf[0]
+
+        if kind == MESSAGE_URABROS :
+            if len(buf) < 2 or len(buf) < buf[1] + 4 :
+                return None
+            wireLen = buf[1] + 4
+            data = bytes(buf[2 : 2 + buf[1]])
+            crc = (buf[wireLen - 2] << 8) + buf[wireLen - 1]
+            del buf[:wireLen]
+            if libscrc.modbus(data) != crc :
+                return [(FRAME_CRC_ERROR, data, wireLen)]
+            return [(FRAME_URABROS, data, wireLen)]
+
+        if kind == MESSAGE_URABROS_BATCH :
+            if len(buf) < 2 :
+                return None
+            pos = 2
+            messages = []
+            for idx in range(buf[1]) :
+                if len(buf) < pos + 1 or len(buf) < pos + 1 + buf[pos] :
+                    return None
+                messages.append(bytes(buf[pos + 1 : pos + 1 + buf[pos]]))
+                pos += 1 + buf[pos]
+            if len(buf) < pos + 2 :
+                return None
+            crc = (buf[pos] << 8) + buf[pos + 1]
+            body = bytes(buf[1 : pos])
+            wireLen = pos + 2
+            del buf[:wireLen]
+            if libscrc.modbus(body) != crc :
+                return [(FRAME_CRC_ERROR, body, wireLen)]
+            # The wire length is shared by the messages of the super-frame
+            return [(FRAME_URABROS, msg, wireLen if idx == 0 else 0) for idx, msg in enumerate(messages)]
+
+        if kind == MESSAGE_START_OF_TEXT :
+            end = buf.find(bytes([MESSAGE_END_OF_TEXT]), 1)
+            if end < 0 :
+                if len(buf) > MESSAGE_TEXT_MAX_LEN :
+                    end = MESSAGE_TEXT_MAX_LEN
+                else :
+                    return None
+            text = bytes(buf[1 : end])
+            del buf[:end + 1]
+            return [(FRAME_TEXT, text, end + 1)]
+
+        if kind == MESSAGE_BINARY_LOG :
+            if len(buf) < 2 or len(buf) < buf[1] + 2 :
+                return None
+            wireLen = buf[1] + 2
+            data = bytes(buf[2 : wireLen])
+            del buf[:wireLen]
+            return [(FRAME_BINARY_LOG, data, wireLen)]
+
+        del buf[:1]
+        return [(FRAME_JUNK, bytes([kind]), 1)]
+
+class UrabrosLink():
+    # Opens the port, a reader thread parses the frames and puts them to a queue with the time of arrival.
+    # The port can be a serial device, the link of the host build or any pyserial URL.
+    # rawHook(direction, time, data) gets every byte written and read, direction is "tx" or "rx".
+    def __init__(self, port, baudrate=115200, rawHook=None):
+        self.serial     = serial.serial_for_url(port, baudrate=baudrate, timeout=0.01)
+        self.parser     = FrameParser()
+        self.frames     = queue.Queue()
+        self.rawHook    = rawHook
+        self.running    = True
+        self.txLock     = threading.Lock()
+        self.counters   = {}
+        self.reader     = threading.Thread(target=self.readLoop, daemon=True)
+        self.reader.start()
+
+    def close(self):
+        self.running = False
+        self.reader.join()
+        self.serial.close()
+
+    def count(self, kind, wireLen):
+        frames, wireBytes = self.counters.get(kind, (0, 0))
+        self.counters[kind] = (frames + 1, wireBytes + wireLen)
+
+    def readLoop(self):
+        while self.running :
+            data = self.serial.read(max(1, self.serial.in_waiting))
+            if not data :
+                continue
+            now = time.perf_counter()
+            if self.rawHook is not None :
+                self.rawHook("rx", now, data)
+            for kind, payload, wireLen in self.parser.feed(data) :
+                self.count(kind, wireLen)
+                self.frames.put((now, kind, payload))
+
+    def send(self, data):
+        # Sends one message, gives back the time it was written
+        frame = frameToMcu(data)
+        with self.txLock :
+            now = time.perf_counter()
+            self.serial.write(frame)
+            if self.rawHook is not None :
+                self.rawHook("tx", now, frame)
+        return now
+
+    def receive(self, timeout):
+        # Gives back the next (time, kind, payload) or None
+        try :
+            return self.frames.get(timeout=timeout)
+        except queue.Empty :
+            return None
@@ -8,4 +8,35 @@ class View(QtWidgets.QWidget):
   def __init__(self):
     super(View, self).__init__()
     self.ui = Ui_Form()
-    self.ui.setupUi(self)
\ No newline at end of file
+    self.ui.setupUi(self)
+
+class DiagnosticsView(QtWidgets.QWidget):
+  # Live table of the GET_DIAGNOSTICS answers, the controller refreshes it while it is visible
+  columns = ["Thread", "No", "State", "Prio", "CPU %", "Stack free (B)"]
+
+  def __init__(self):
+    super(DiagnosticsView, self).__init__()
+    self.setWindowTitle("Urabros diagnostics")
+    self.resize(640, 420)
+    self.system = QtWidgets.QLabel()
+    self.system.setWordWrap(True)
+    self.table = QtWidgets.QTableWidget(0, len(self.columns))
+    self.table.setHorizontalHeaderLabels(self.columns)
+    self.table.horizontalHeader().setStretchLastSection(True)
+    self.table.setEditTriggers(QtWidgets.QAbstractItemView.NoEditTriggers)
+    self.table.setSortingEnabled(True)
+    layout = QtWidgets.QVBoxLayout(self)
+    layout.addWidget(self.system)
+    layout.addWidget(self.table)
+
+  def showSnapshot(self, systemText, rows):
+    self.system.setText(systemText)
+    self.table.setSortingEnabled(False)
+    self.table.setRowCount(len(rows))
+    for rowIdx, row in enumerate(rows) :
+      for colIdx, value in enumerate(row) :
+        item = QtWidgets.QTableWidgetItem()
+        # Numbers are stored as numbers, so the columns sort well
+        item.setData(QtCore.Qt.DisplayRole, value)
+        self.table.setItem(rowIdx, colIdx, item)
+    self.table.setSortingEnabled(True)